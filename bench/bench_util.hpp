@@ -0,0 +1,54 @@
+/*
+ * Copyright 2017-2020 Agouti Games Team (see the AUTHORS file)
+ *
+ * This file is part of the RawSalmonEngine.
+ *
+ * The RawSalmonEngine is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * The RawSalmonEngine is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with the RawSalmonEngine.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#ifndef BENCH_UTIL_HPP_INCLUDED
+#define BENCH_UTIL_HPP_INCLUDED
+
+#include <chrono>
+#include <random>
+#include <vector>
+
+#include "util/game_types.hpp"
+
+namespace salmon { namespace bench {
+
+/// Returns the mean milliseconds per run of f over the given number of runs, after one warm up run
+template<typename Function>
+double measure_ms(unsigned runs, Function f) {
+    f();
+    auto start = std::chrono::steady_clock::now();
+    for(unsigned i = 0; i < runs; i++) {f();}
+    std::chrono::duration<double, std::milli> elapsed = std::chrono::steady_clock::now() - start;
+    return elapsed.count() / runs;
+}
+
+/// Random hitboxes of actor size scattered over a square world, the same for each seed
+inline std::vector<Rect> random_hitboxes(unsigned count, float world_size, unsigned seed) {
+    std::mt19937 rng(seed);
+    std::uniform_real_distribution<float> position(0.0f, world_size);
+    std::uniform_real_distribution<float> size(8.0f, 48.0f);
+    std::vector<Rect> hitboxes;
+    hitboxes.reserve(count);
+    for(unsigned i = 0; i < count; i++) {
+        hitboxes.emplace_back(position(rng), position(rng), size(rng), size(rng));
+    }
+    return hitboxes;
+}
+}} // namespace salmon::bench
+
+#endif // BENCH_UTIL_HPP_INCLUDED
@@ -0,0 +1,72 @@
+/*
+ * Copyright 2017-2020 Agouti Games Team (see the AUTHORS file)
+ *
+ * This file is part of the RawSalmonEngine.
+ *
+ * The RawSalmonEngine is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * The RawSalmonEngine is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with the RawSalmonEngine.  If not, see <http://www.gnu.org/licenses/>.
+ */
+/*
+ * Compares HitboxBatch::query() against a scalar loop over Rect::has_intersection(),
+ * which is how hitboxes were tested before the batches. HitboxBatch picks its kernel
+ * at runtime, see HitboxBatch::get_kernel_name().
+ */
+#include <cmath>
+#include <iostream>
+#include <vector>
+
+#include "bench_util.hpp"
+#include "util/hitbox_batch.hpp"
+
+using namespace salmon;
+using namespace salmon::internal;
+
+int main() {
+    const char* kernel = HitboxBatch::get_kernel_name();
+    const unsigned hitbox_counts[] = {256, 1024, 4096};
+    const unsigned runs = 20;
+
+    std::cout << "HitboxBatch kernel: " << kernel << "\n";
+    std::cout << "hitboxes scalar_ms batch_ms speedup matches\n";
+    for(unsigned count : hitbox_counts) {
+        std::vector<Rect> hitboxes = bench::random_hitboxes(count, 64.0f * std::sqrt(static_cast<float>(count)), count);
+        HitboxBatch batch;
+        for(unsigned i = 0; i < hitboxes.size(); i++) {batch.push(hitboxes[i], i, 0);}
+
+        // Each hitbox against all following ones, like the narrowphase
+        unsigned scalar_matches = 0;
+        double scalar_ms = bench::measure_ms(runs, [&]() {
+            scalar_matches = 0;
+            for(unsigned i = 0; i < hitboxes.size(); i++) {
+                for(unsigned j = i + 1; j < hitboxes.size(); j++) {
+                    if(hitboxes[i].has_intersection(hitboxes[j])) {scalar_matches++;}
+                }
+            }
+        });
+
+        std::vector<unsigned> matches;
+        double batch_ms = bench::measure_ms(runs, [&]() {
+            matches.clear();
+            for(unsigned i = 0; i < batch.size(); i++) {
+                batch.query(batch.get_rect(i), i + 1, matches);
+            }
+        });
+
+        if(matches.size() != scalar_matches) {
+            std::cerr << "Mismatch with " << count << " hitboxes: scalar " << scalar_matches << " batch " << matches.size() << "\n";
+            return 1;
+        }
+        std::cout << count << " " << scalar_ms << " " << batch_ms << " " << scalar_ms / batch_ms << " " << scalar_matches << "\n";
+    }
+    return 0;
+}
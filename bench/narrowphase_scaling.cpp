@@ -0,0 +1,99 @@
+/*
+ * Copyright 2017-2020 Agouti Games Team (see the AUTHORS file)
+ *
+ * This file is part of the RawSalmonEngine.
+ *
+ * The RawSalmonEngine is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * The RawSalmonEngine is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with the RawSalmonEngine.  If not, see <http://www.gnu.org/licenses/>.
+ */
+/*
+ * Runs the actor vs actor narrowphase the way LayerCollection::find_all_contacts() does,
+ * with the same chunking, on thread pools of 1, 2, 4 and 8 threads.
+ * Fails if any thread count finds other contacts or finds them in another order than one thread.
+ */
+#include <algorithm>
+#include <cmath>
+#include <iostream>
+#include <vector>
+
+#include "bench_util.hpp"
+#include "util/hitbox_batch.hpp"
+#include "util/thread_pool.hpp"
+
+using namespace salmon;
+using namespace salmon::internal;
+
+namespace {
+/// Concatenates the contacts of all chunks in chunk order, like the merge of find_all_contacts()
+std::vector<unsigned> merge(const std::vector<std::vector<unsigned>>& found) {
+    std::vector<unsigned> contacts;
+    for(const std::vector<unsigned>& matches : found) {contacts.insert(contacts.end(), matches.begin(), matches.end());}
+    return contacts;
+}
+
+/// Counts the intersecting pairs of all hitboxes, each pair once
+unsigned find_contacts(const HitboxBatch& batch, ThreadPool& pool, std::vector<std::vector<unsigned>>& found) {
+    const unsigned min_chunk_size = 8;
+    unsigned count = batch.size();
+    unsigned chunk_size = std::max(min_chunk_size, count / (pool.get_thread_count() * 4));
+    unsigned chunks = (count + chunk_size - 1) / chunk_size;
+
+    found.resize(chunks);
+    pool.run(chunks, [&](unsigned chunk) {
+        std::vector<unsigned>& matches = found[chunk];
+        matches.clear();
+        unsigned to = std::min((chunk + 1) * chunk_size, count);
+        for(unsigned i = chunk * chunk_size; i < to; i++) {
+            batch.query(batch.get_rect(i), i + 1, matches);
+        }
+    });
+
+    unsigned contacts = 0;
+    for(const std::vector<unsigned>& matches : found) {contacts += matches.size();}
+    return contacts;
+}
+} // namespace
+
+int main() {
+    const unsigned actor_counts[] = {1000, 4000, 16000};
+    const unsigned thread_counts[] = {1, 2, 4, 8};
+    const unsigned runs = 20;
+
+    std::cout << "actors threads ms/frame speedup contacts\n";
+    for(unsigned actors : actor_counts) {
+        // Keeps the density and therefore the contacts per actor constant
+        float world_size = 64.0f * std::sqrt(static_cast<float>(actors));
+        std::vector<Rect> hitboxes = bench::random_hitboxes(actors, world_size, actors);
+        HitboxBatch batch;
+        for(unsigned i = 0; i < hitboxes.size(); i++) {batch.push(hitboxes[i], i, 0);}
+
+        double single_ms = 0.0;
+        std::vector<unsigned> single_contacts;
+        for(unsigned threads : thread_counts) {
+            ThreadPool pool(threads);
+            std::vector<std::vector<unsigned>> found;
+            unsigned contacts = 0;
+            double ms = bench::measure_ms(runs, [&]() {contacts = find_contacts(batch, pool, found);});
+            if(threads == 1) {
+                single_ms = ms;
+                single_contacts = merge(found);
+            }
+            else if(merge(found) != single_contacts) {
+                std::cerr << "Contacts with " << threads << " threads differ from one thread\n";
+                return 1;
+            }
+            std::cout << actors << " " << pool.get_thread_count() << " " << ms << " " << single_ms / ms << " " << contacts << "\n";
+        }
+    }
+    return 0;
+}
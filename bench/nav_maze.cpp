@@ -0,0 +1,226 @@
+/*
+ * Copyright 2017-2020 Agouti Games Team (see the AUTHORS file)
+ *
+ * This file is part of the RawSalmonEngine.
+ *
+ * The RawSalmonEngine is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * The RawSalmonEngine is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with the RawSalmonEngine.  If not, see <http://www.gnu.org/licenses/>.
+ */
+/*
+ * Random path queries through a generated maze with some extra openings, once searched
+ * right away with find_path() and once queued with a node budget per update.
+ * The path cache is off, so every query runs a full search.
+ *
+ * Before timing, each jump point search path gets checked against a plain A* over
+ * NavGrid::for_each_neighbour(). Both must agree on whether there is a path and on
+ * its cost, and each step of the path must be a valid move. Fails on any difference.
+ */
+#include <cmath>
+#include <cstdlib>
+#include <functional>
+#include <iostream>
+#include <queue>
+#include <random>
+#include <vector>
+
+#include "bench_util.hpp"
+#include "map/nav_grid.hpp"
+
+using namespace salmon;
+using namespace salmon::internal;
+
+namespace {
+/**
+ * @brief Carve a maze into a fully blocked grid with a depth first search
+ *
+ * Cells with odd coordinates are rooms, the cells between them walls. Afterwards a share
+ * of the remaining walls gets opened, so there are several routes between most cells.
+ */
+void build_maze(NavGrid& grid, unsigned size, float open_share, std::mt19937& rng) {
+    grid.init(size, size, 32, 32);
+    for(unsigned y = 0; y < size; y++) {
+        for(unsigned x = 0; x < size; x++) {grid.set_blocked(x, y, true);}
+    }
+
+    std::vector<std::pair<int, int>> stack{{1, 1}};
+    grid.set_blocked(1, 1, false);
+    const int steps[4][2] = {{2, 0}, {-2, 0}, {0, 2}, {0, -2}};
+    while(!stack.empty()) {
+        int x = stack.back().first;
+        int y = stack.back().second;
+        std::vector<int> options;
+        for(int i = 0; i < 4; i++) {
+            int n_x = x + steps[i][0];
+            int n_y = y + steps[i][1];
+            if(n_x > 0 && n_y > 0 && n_x < static_cast<int>(size) - 1 && n_y < static_cast<int>(size) - 1 && grid.is_blocked(n_x, n_y)) {
+                options.push_back(i);
+            }
+        }
+        if(options.empty()) {
+            stack.pop_back();
+            continue;
+        }
+        const int* step = steps[options[rng() % options.size()]];
+        grid.set_blocked(x + step[0] / 2, y + step[1] / 2, false);
+        grid.set_blocked(x + step[0], y + step[1], false);
+        stack.emplace_back(x + step[0], y + step[1]);
+    }
+
+    std::uniform_real_distribution<float> chance(0.0f, 1.0f);
+    for(unsigned y = 1; y < size - 1; y++) {
+        for(unsigned x = 1; x < size - 1; x++) {
+            if(grid.is_blocked(x, y) && (x + y) % 2 == 1 && chance(rng) < open_share) {grid.set_blocked(x, y, false);}
+        }
+    }
+}
+
+/// Cost of the cheapest path with plain A* over the neighbours of the grid, negative if there is none
+float reference_cost(const NavGrid& grid, Uint32 start, Uint32 goal) {
+    const unsigned width = grid.get_width();
+    auto heuristic = [width, goal](Uint32 cell) {
+        float dx = std::abs(static_cast<int>(cell % width) - static_cast<int>(goal % width));
+        float dy = std::abs(static_cast<int>(cell / width) - static_cast<int>(goal / width));
+        return std::max(dx, dy) + (1.41421356f - 1.0f) * std::min(dx, dy);
+    };
+    typedef std::pair<float, Uint32> Entry;
+    std::vector<float> cost(width * grid.get_height(), -1.0f);
+    std::vector<bool> closed(cost.size(), false);
+    std::priority_queue<Entry, std::vector<Entry>, std::greater<Entry>> open;
+    cost[start] = 0.0f;
+    open.emplace(heuristic(start), start);
+    while(!open.empty()) {
+        Uint32 cell = open.top().second;
+        open.pop();
+        if(closed[cell]) {continue;}
+        if(cell == goal) {return cost[cell];}
+        closed[cell] = true;
+        grid.for_each_neighbour(cell, [&](Uint32 neighbour, float step) {
+            float new_cost = cost[cell] + step;
+            if(cost[neighbour] < 0.0f || new_cost < cost[neighbour]) {
+                cost[neighbour] = new_cost;
+                open.emplace(new_cost + heuristic(neighbour), neighbour);
+            }
+        });
+    }
+    return -1.0f;
+}
+
+/**
+ * @brief Cost of a path of turning points, negative if a step between them isn't a move of the grid
+ *
+ * The lines between turning points must be straight or diagonal and each of their
+ * steps must be a neighbour given by NavGrid::for_each_neighbour().
+ */
+float path_cost(const NavGrid& grid, const std::vector<Point>& path) {
+    const unsigned width = grid.get_width();
+    float cost = 0.0f;
+    for(unsigned i = 1; i < path.size(); i++) {
+        unsigned x, y, to_x, to_y;
+        if(!grid.to_cell(path[i - 1], x, y) || !grid.to_cell(path[i], to_x, to_y)) {return -1.0f;}
+        int dx = static_cast<int>(to_x) - static_cast<int>(x);
+        int dy = static_cast<int>(to_y) - static_cast<int>(y);
+        if(dx != 0 && dy != 0 && std::abs(dx) != std::abs(dy)) {return -1.0f;}
+        int step_x = (dx > 0) - (dx < 0);
+        int step_y = (dy > 0) - (dy < 0);
+        for(int s = 0; s < std::max(std::abs(dx), std::abs(dy)); s++) {
+            Uint32 next = (y + step_y) * width + x + step_x;
+            float step_cost = -1.0f;
+            grid.for_each_neighbour(y * width + x, [&](Uint32 neighbour, float step) {
+                if(neighbour == next) {step_cost = step;}
+            });
+            if(step_cost < 0.0f) {return -1.0f;}
+            cost += step_cost;
+            x += step_x;
+            y += step_y;
+        }
+    }
+    return cost;
+}
+
+/// Checks the path of find_path() for one query against plain A*
+bool check_query(NavGrid& grid, Point from, Point to) {
+    unsigned x, y, goal_x, goal_y;
+    grid.to_cell(from, x, y);
+    grid.to_cell(to, goal_x, goal_y);
+    float expected = reference_cost(grid, y * grid.get_width() + x, goal_y * grid.get_width() + goal_x);
+
+    std::vector<Point> path;
+    PathStatus status = grid.find_path(from, to, path);
+    if((status == PathStatus::found) != (expected >= 0.0f)) {
+        std::cerr << "Path from " << x << "," << y << " to " << goal_x << "," << goal_y << " found by only one search\n";
+        return false;
+    }
+    if(status != PathStatus::found) {return true;}
+
+    unsigned first_x, first_y, last_x, last_y;
+    grid.to_cell(path.front(), first_x, first_y);
+    grid.to_cell(path.back(), last_x, last_y);
+    float cost = path_cost(grid, path);
+    if(first_x != x || first_y != y || last_x != goal_x || last_y != goal_y || cost < 0.0f ||
+       std::abs(cost - expected) > 1e-3f * std::max(1.0f, expected)) {
+        std::cerr << "Path from " << x << "," << y << " to " << goal_x << "," << goal_y << " costs " << cost
+                  << " instead of " << expected << " or isn't walkable\n";
+        return false;
+    }
+    return true;
+}
+} // namespace
+
+int main() {
+    const unsigned sizes[] = {63, 127, 255};
+    const unsigned query_count = 200;
+    const unsigned node_budget = 2000;
+
+    std::cout << "maze queries found find_path_ms budgeted_ms updates\n";
+    for(unsigned size : sizes) {
+        std::mt19937 rng(size);
+        NavGrid grid;
+        build_maze(grid, size, 0.05f, rng);
+        grid.set_cache_size(0);
+
+        std::vector<std::pair<Point, Point>> queries;
+        std::uniform_int_distribution<unsigned> room(0, size / 2 - 1);
+        for(unsigned i = 0; i < query_count; i++) {
+            queries.emplace_back(grid.to_world(room(rng) * 2 + 1, room(rng) * 2 + 1),
+                                 grid.to_world(room(rng) * 2 + 1, room(rng) * 2 + 1));
+        }
+        for(const auto& query : queries) {
+            if(!check_query(grid, query.first, query.second)) {return 1;}
+        }
+
+        unsigned found = 0;
+        std::vector<Point> path;
+        double find_ms = bench::measure_ms(1, [&]() {
+            found = 0;
+            for(const auto& query : queries) {
+                if(grid.find_path(query.first, query.second, path) == PathStatus::found) {found++;}
+            }
+        });
+
+        unsigned updates = 0;
+        double budgeted_ms = bench::measure_ms(1, [&]() {
+            std::vector<unsigned> requests;
+            for(const auto& query : queries) {requests.push_back(grid.request_path(query.first, query.second, node_budget));}
+            updates = 0;
+            while(grid.get_path(requests.back(), path) == PathStatus::searching) {
+                grid.update();
+                updates++;
+            }
+            for(unsigned request : requests) {grid.get_path(request, path);}
+        });
+
+        std::cout << size << "x" << size << " " << query_count << " " << found << " "
+                  << find_ms / query_count << " " << budgeted_ms / query_count << " " << updates << "\n";
+    }
+    return 0;
+}
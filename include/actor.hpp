@@ -29,7 +29,7 @@
 
 namespace salmon {
 
-namespace internal{class Actor;}
+namespace internal{class Actor; class LayerCollection;}
 
 class Actor {
     friend class Camera;
@@ -39,7 +39,7 @@ class Actor {
         Actor(internal::Actor* impl);
         virtual ~Actor() = default;
 
-        /// Returns true if the actor exists / could be found
+        /// Returns true if the actor exists / could be found and wasn't removed from the map since
         bool good() const;
 
         /**
@@ -52,7 +52,7 @@ class Actor {
          * @note If animation type and direction combination doesn't exist, the error isn't indicated,
          *       and the animation stays at its prior state
          */
-        bool animate(std::string anim = AnimationType::current, Direction dir = Direction::current, float speed = 1.0);
+        bool animate(const std::string& anim = AnimationType::current, Direction dir = Direction::current, float speed = 1.0);
 
         /**
          * @brief Sets animation to specific frame
@@ -64,7 +64,7 @@ class Actor {
          * @note If animation type and direction combination doesn't exist,
          *       the animation stays at its prior state
          */
-        bool set_animation(std::string anim = AnimationType::current, Direction dir = Direction::current, int frame = 0);
+        bool set_animation(const std::string& anim = AnimationType::current, Direction dir = Direction::current, int frame = 0);
 
         /**
          * @brief Lets the actor play an animation sequence
@@ -76,14 +76,31 @@ class Actor {
          * @note If animation type and direction combination doesn't exist,
          *       and the animation stays at its prior state
          */
-        AnimSignal animate_trigger(std::string anim = AnimationType::current, Direction dir = Direction::current, float speed = 1.0);
+        AnimSignal animate_trigger(const std::string& anim = AnimationType::current, Direction dir = Direction::current, float speed = 1.0);
+
+        /**
+         * @brief Resolves an animation type and direction for use in the animation methods
+         * @param anim The name of the type of animation, may be AnimationType::current
+         * @param dir The direction of the animation, may be Direction::current
+         * @return A handle valid for all actors of this map, check AnimationHandle::valid()
+         *
+         * Resolve handles once and reuse them instead of passing strings every frame
+         */
+        AnimationHandle get_animation_handle(const std::string& anim, Direction dir = Direction::current) const;
+
+        /// Lets the actor play the animation sequence of a pre-resolved handle, see string based overload
+        bool animate(AnimationHandle anim, float speed = 1.0);
+        /// Sets the animation of a pre-resolved handle to a specific frame, see string based overload
+        bool set_animation(AnimationHandle anim, int frame = 0);
+        /// Lets the actor play the animation sequence of a pre-resolved handle, see string based overload
+        AnimSignal animate_trigger(AnimationHandle anim, float speed = 1.0);
 
         /// Returns the type string of the currently active animation
         std::string get_animation() const;
         /// Returns the direction value of the currently active animation
         Direction get_direction() const;
         /// Returns true if there is a valid animation tile representing animation type and direction
-        bool valid_anim_state(std::string anim, Direction dir) const;
+        bool valid_anim_state(const std::string& anim, Direction dir) const;
 
         /// Return reference to current transform of actor
         Transform& get_transform();
@@ -121,6 +138,19 @@ class Actor {
          */
         bool move_absolute(float x, float y, Collidees target, const std::vector<std::string>& my_hitboxes, const std::vector<std::string>& other_hitboxes, bool notify);
 
+        /**
+         * @brief Moves relative to current position and stops at the first collision on the way
+         * @param x, y The amount of movement in pixels
+         * @param target Determine if actors, or tiles, or both are checked for collision
+         * @param my_hitboxes A list of hitbox names for this actor to check with
+         * @param other_hitboxes A list of hitbox names for collidees to check against
+         * @param notify If true a collision gets added to collider and collidee of the first impact
+         * @return The travelled fraction of the movement and the surface normal of the obstacle
+         *
+         * @note Unlike move_relative the hitboxes get swept along the whole path, so fast actors can't pass through thin obstacles
+         */
+        SweepResult move_swept(float x, float y, Collidees target, const std::vector<std::string>& my_hitboxes, const std::vector<std::string>& other_hitboxes, bool notify);
+
         /**
          * @brief Moves relative to current position with no collision check
          * @param x, y The amount of movement in pixels
@@ -201,7 +231,7 @@ class Actor {
         /// Returns the number of frames the currently active animation type direction combination has
         int get_anim_frame_count() const;
 
-        /// Returns vector containing all collisions since last clear_collisions() call
+        /// Returns vector containing all collisions since the last map update or clear_collisions() call
         std::vector<Collision> get_collisions();
         /// Clears actor of its detected collisions
         void clear_collisions();
@@ -209,6 +239,23 @@ class Actor {
         /// When set to false, collisions won't be stored and directly discarded, when true they will be stored again
         void register_collisions(bool r);
 
+        /**
+         * @brief Set the collision filter of the actor
+         * @param category The category bits of this actor, COLLISION_CATEGORY in Tiled, 1 by default
+         * @param mask The categories this actor collides with, COLLISION_MASK in Tiled, all by default
+         * @note Two actors only collide if each mask contains the category of the other, the same goes for map layers
+         */
+        void set_collision_filter(unsigned category, unsigned mask);
+        /// Returns the category bits of this actor
+        unsigned get_collision_category() const;
+        /// Returns the categories this actor collides with
+        unsigned get_collision_mask() const;
+
+        /// Returns true if the actor is outside of the activity regions of the map, see MapData::set_activity_region()
+        bool is_sleeping() const;
+        /// Keeps the actor awake for the given time, at least until the next map update
+        void wake(float seconds = 0.0f);
+
         /// Returns true if actor is currently hidden, false otherwise
         bool get_hidden() const;
         /// When mode is true, rendering will be suspended, when false actor will be rendered again
@@ -225,6 +272,10 @@ class Actor {
 
     private:
         internal::Actor* m_impl;
+        // Generational handle of actors stored on a map, detects removed actors
+        internal::LayerCollection* m_layers = nullptr;
+        unsigned m_slot = 0;
+        unsigned m_generation = 0;
 };
 }
 
@@ -40,6 +40,8 @@ class Collision {
         bool actor() const;
         /// Return true if collidee is the mouse
         bool mouse() const;
+        /// Return true if collidee is a trigger region of an object layer
+        bool trigger() const;
         /// Return true if collidee is not defined
         bool none() const;
 
@@ -53,9 +55,16 @@ class Collision {
 
         /// Returns the instance of the tile collided with
         TileInstance get_tile() const;
+        /// Return the name of the trigger region if collidee is a trigger
+        std::string get_trigger_name() const;
+        /// Return whether the actor entered, stayed in or left the trigger region
+        TriggerEvent get_trigger_event() const;
 
         const Transform& get_transform() const;
 
+        /// Returns the intersection of both hitboxes in world coordinates at the time of collision
+        Rect get_contact() const;
+
     private:
         internal::Collision* m_impl;
 };
@@ -21,6 +21,8 @@
 
 #include <string>
 
+#include "./types.hpp"
+
 namespace salmon {
 
 namespace internal{class DataBlock;}
@@ -30,31 +32,61 @@ class DataBlock {
         DataBlock(internal::DataBlock& impl);
 
         /// Set named bool property to supplied value
-        void set_val(std::string name, bool val);
+        void set_val(const std::string& name, bool val);
         /// Set named integer property to supplied value
-        void set_val(std::string name, int val);
+        void set_val(const std::string& name, int val);
         /// Set named float property to supplied value
-        void set_val(std::string name, float val);
+        void set_val(const std::string& name, float val);
         /// Set named string property to supplied value
-        void set_val(std::string name, std::string val);
+        void set_val(const std::string& name, std::string val);
 
         /// Returns true if bool property with supplied name exists
-        bool check_val_bool(std::string name) const;
+        bool check_val_bool(const std::string& name) const;
         /// Returns true if integer property with supplied name exists
-        bool check_val_int(std::string name) const;
+        bool check_val_int(const std::string& name) const;
         /// Returns true if float property with supplied name exists
-        bool check_val_float(std::string name) const;
+        bool check_val_float(const std::string& name) const;
         /// Returns true if string property with supplied name exists
-        bool check_val_string(std::string name) const;
+        bool check_val_string(const std::string& name) const;
 
         /// Return bool value by name
-        bool get_val_bool(std::string name) const;
+        bool get_val_bool(const std::string& name) const;
         /// Return integer value by name
-        int get_val_int(std::string name) const;
+        int get_val_int(const std::string& name) const;
         /// Return float value by name
-        float get_val_float(std::string name) const;
+        float get_val_float(const std::string& name) const;
         /// Return string value by name
-        std::string get_val_string(std::string name) const;
+        std::string get_val_string(const std::string& name) const;
+
+        /// Resolve a property name once for the faster accessors below
+        static DataKey get_key(const std::string& name);
+
+        /// Set property of pre-resolved name to supplied value
+        void set_val(const DataKey& key, bool val);
+        /// Set property of pre-resolved name to supplied value
+        void set_val(const DataKey& key, int val);
+        /// Set property of pre-resolved name to supplied value
+        void set_val(const DataKey& key, float val);
+        /// Set property of pre-resolved name to supplied value
+        void set_val(const DataKey& key, std::string val);
+
+        /// Returns true if bool property with pre-resolved name exists
+        bool check_val_bool(const DataKey& key) const;
+        /// Returns true if integer property with pre-resolved name exists
+        bool check_val_int(const DataKey& key) const;
+        /// Returns true if float property with pre-resolved name exists
+        bool check_val_float(const DataKey& key) const;
+        /// Returns true if string property with pre-resolved name exists
+        bool check_val_string(const DataKey& key) const;
+
+        /// Return bool value by pre-resolved name
+        bool get_val_bool(const DataKey& key) const;
+        /// Return integer value by pre-resolved name
+        int get_val_int(const DataKey& key) const;
+        /// Return float value by pre-resolved name
+        float get_val_float(const DataKey& key) const;
+        /// Return string value by pre-resolved name
+        std::string get_val_string(const DataKey& key) const;
 
         /// Clear DataBlock of all of its entries
         void clear();
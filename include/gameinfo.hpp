@@ -64,6 +64,12 @@ class GameInfo{
 
         /// Set on linear filtering for smooth upscaled textures or off for proper sharp pixel art
         bool set_linear_filtering(bool mode);
+        /**
+         * @brief Set the number of threads which all maps share for collision checks and flow fields
+         * @param threads The thread count including the calling thread, 0 for one per hardware thread
+         * @note The default is one thread per hardware thread, results don't depend on the thread count
+         */
+        void set_thread_count(unsigned threads);
 
         /// Adds directory for preloading. Path is relative to the data folder
         void add_preload_directory(std::string dir);
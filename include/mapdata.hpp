@@ -31,6 +31,17 @@ namespace salmon {
 
 namespace internal{class MapData;}
 
+/// The outcome of a raycast, see MapData::raycast()
+struct RaycastHit {
+    bool hit = false; ///< True if the ray hit anything
+    float fraction = 1.0f; ///< The part of the ray before the hit, from 0 to 1
+    Point point; ///< World position of the hit
+    Point normal; ///< Surface normal of the hit hitbox, zero if the ray started within it
+    Actor actor = Actor(nullptr); ///< The actor which got hit, invalid if it is a tile
+    std::string hitbox; ///< The name of the hit hitbox
+    std::string tile_type; ///< The type of the hit tile, empty if an actor got hit
+};
+
 class MapData {
     public:
         MapData(internal::MapData& impl);
@@ -44,9 +55,109 @@ class MapData {
 
         /// Returns a vector of references to all actors on all map layers
         std::vector<Actor> get_actors();
+        /// Returns the actor with the given name, which is invalid if there is none
+        Actor get_actor(const std::string& actor_name);
+        /// Returns all actors which got constructed from the given actor template
+        std::vector<Actor> get_actors_of_template(const std::string& actor_template_name);
         /// Returns reference to the camera controlling rendering frame
         Camera& get_camera();
 
+        /**
+         * @brief Finds the first tile or actor hitbox on the line between two points
+         * @param from The start of the ray
+         * @param to The end of the ray
+         * @param target Enum value which tells if to check against tiles, actors or both
+         * @param hitboxes The hitbox names to check against, all hitboxes if empty
+         * @param tile_type Only tiles of this type get hit, any tile if empty
+         * @param ignore An actor which never gets hit, usually the one casting the ray
+         * @note A ray starting within a hitbox hits it right away
+         */
+        RaycastHit raycast(Point from, Point to, Collidees target, const std::vector<std::string>& hitboxes = {},
+                           const std::string& tile_type = "", Actor ignore = Actor(nullptr));
+        /// Returns all actors with a hitbox containing the point, all hitboxes are checked if hitboxes is empty
+        std::vector<Actor> get_actors_at(Point point, const std::vector<std::string>& hitboxes = {});
+        /// Returns all actors with a hitbox intersecting the area, all hitboxes are checked if hitboxes is empty
+        std::vector<Actor> get_actors_in(Rect area, const std::vector<std::string>& hitboxes = {});
+        /// Returns true if any tile or actor hitbox contains the point, tile_type restricts the checked tiles
+        bool check_point(Point point, Collidees target, const std::vector<std::string>& hitboxes = {}, const std::string& tile_type = "");
+
+        /**
+         * @brief Returns the id of a tile TYPE for the tile type queries
+         * @return -1 if no tile has this type, zero for the empty type
+         * @note Resolve the id once and keep it, so the queries need no string compares
+         */
+        int get_tile_type_id(const std::string& type);
+        /// Returns the bit of a boolean tile property for the tile flag queries, zero if no tile has this property
+        unsigned get_tile_flag(const std::string& property);
+        /// Returns the type id of the topmost typed tile at the point, zero if there is none
+        int get_tile_type_at(Point point);
+        /// Returns the bits of the boolean properties which are true for any tile at the point, see get_tile_flag()
+        unsigned get_tile_flags_at(Point point);
+        /// Returns the bits of the boolean properties which are true for any tile overlapping the area, see get_tile_flag()
+        unsigned get_tile_flags_in(Rect area);
+        /// Returns true if a tile of the type overlaps the area, see get_tile_type_id()
+        bool check_tile_type_in(Rect area, int type);
+
+        /**
+         * @brief Build the navigation grid used by the path searches from all map layers
+         * @param blocking_hitbox Tiles with a hitbox of this name are blocking, none if empty
+         * @param blocking_tile_type Tiles of this type are blocking, none if empty
+         * @note Maps with the NAV_HITBOX or NAV_TILE_TYPE property get their grid at load
+         */
+        void build_nav_grid(const std::string& blocking_hitbox, const std::string& blocking_tile_type = "");
+        /// Marks the navigation cell at the world position as blocked or walkable, until the grid gets rebuilt
+        void set_nav_blocked(Point point, bool blocked);
+        /**
+         * @brief Search a path between two world positions right away
+         * @param path Gets the centers of the cells along the path, including start and goal
+         *
+         * On orthogonal maps only the turning points of the path are returned, the moves
+         * between them are straight lines. Diagonal moves never cut the corner of a blocked cell.
+         */
+        PathStatus find_path(Point from, Point to, std::vector<Point>& path);
+        /**
+         * @brief Queue a path search which runs during the following updates
+         * @param node_budget Maximum count of nodes the search expands per update, zero means unlimited
+         * @return The request id to fetch the result with get_path()
+         */
+        unsigned request_path(Point from, Point to, unsigned node_budget = 0);
+        /// Fetch the result of request_path(), finished results can be fetched only once
+        PathStatus get_path(unsigned request, std::vector<Point>& path);
+
+        /**
+         * @brief Create a flow field which leads from every cell of the navigation grid to the closest goal
+         * @param goals World positions of the goals
+         * @return The id of the field, zero if there is no navigation grid
+         * @note Changes of the navigation grid get applied to all fields during update()
+         */
+        unsigned add_flow_field(const std::vector<Point>& goals);
+        /// Replaces the goals of a flow field and recomputes it. Returns false if there is no such field
+        bool set_flow_field_goals(unsigned field, const std::vector<Point>& goals);
+        /// Removes a flow field. Returns false if there is no such field
+        bool remove_flow_field(unsigned field);
+        /// Returns the unit vector toward the closest goal at the position, zero at a goal and where none is reachable
+        Point get_flow_direction(unsigned field, Point position);
+        /// Returns the path cost to the closest goal, negative if none is reachable
+        float get_flow_distance(unsigned field, Point position);
+
+        /**
+         * @brief Let actors far away from the camera and all anchors sleep
+         * @param margin Distance in pixels around the camera within which actors stay awake, negative disables sleeping
+         * @param tick_interval Sleeping actors still get a regular frame every nth update, never if zero
+         * @note Sleeping actors get no collisions and don't animate. Maps may set ACTIVITY_MARGIN and SLEEP_TICK_INTERVAL
+         */
+        void set_activity_region(float margin, unsigned tick_interval = 0);
+        /// Keeps the actors within radius of the point awake, returns the id of the anchor
+        unsigned add_activity_anchor(Point point, float radius);
+        /// Keeps the actors within radius of the actor awake until it gets removed, returns the id of the anchor
+        unsigned add_activity_anchor(Actor actor, float radius);
+        /// Removes an anchor, returns false if there is no such anchor
+        bool remove_activity_anchor(unsigned anchor);
+        /// Returns the count of actors which were awake during the last update
+        unsigned get_awake_actor_count();
+        /// Returns the count of actors which were sleeping during the last update
+        unsigned get_sleeping_actor_count();
+
         /**
          * @brief Generate a new actor from a template
          * @param actor_template_name The name of the actor template
@@ -70,6 +181,29 @@ class MapData {
         /// Removes actor from this map. Returns true if removal worked
         bool remove_actor(Actor actor);
 
+        /**
+         * @brief Queue generating a new actor from a template
+         * @param actor_template_name The name of the actor template
+         * @param layer_name The name of the layer for the actor to reside in
+         * @param actor_name The name of the newly generated actor used to identify him
+         * @return False if actor_template or layer doesn't exist
+         * @note The actor gets added at the start of the next update(), retrieve it via get_spawned_actors()
+         */
+        bool queue_add_actor(std::string actor_template_name, std::string layer_name, std::string actor_name = "GENERATED");
+        /// Queue removal of the actor at the start of the next update(). Safe while iterating over actors
+        void queue_remove_actor(Actor actor);
+        /// Returns the actors added by queue_add_actor() during the last update()
+        std::vector<Actor> get_spawned_actors();
+
+        /**
+         * @brief Returns the usage counters of the actor pool of a template
+         *
+         * Templates with the POOL_SIZE property keep that many preconstructed actors.
+         * add_actor() and queue_add_actor() take actors from the pool, removed actors return to it.
+         * @return All zero if the template has no pool
+         */
+        ActorPoolStats get_actor_pool_stats(std::string actor_template_name) const;
+
         /**
          * @brief Retrieve text object by name
          * @param name The name of the text object
@@ -98,19 +232,29 @@ class MapData {
          * @param layer_name The name of the to be hidden layer
          * @return True if layer exists
          */
-        bool hide_layer(std::string layer_name);
+        bool hide_layer(const std::string& layer_name);
         /**
          * @brief Reenable rendering of a layer
          * @param layer_name The name of the to be hidden layer
          * @return True if layer exists
          */
-        bool unhide_layer(std::string layer_name);
+        bool unhide_layer(const std::string& layer_name);
+
+        /**
+         * @brief Set the collision filter of the tiles on a map layer
+         * @param layer_name The name of the map layer
+         * @param category The category bits of the tiles, COLLISION_CATEGORY in Tiled, 1 by default
+         * @param mask The actor categories the tiles collide with, COLLISION_MASK in Tiled, all by default
+         * @return True if map layer exists
+         * @note See Actor::set_collision_filter()
+         */
+        bool set_layer_collision_filter(const std::string& layer_name, unsigned category, unsigned mask);
 
         /**
          * @brief Returns pointer to transform of layer
          * If layer couldn't be found, returns nullptr
          */
-        salmon::Transform* get_layer_transform(std::string layer_name);
+        salmon::Transform* get_layer_transform(const std::string& layer_name);
 
         /// Returns map width and heigth in pixels (not taking layer offset into account)
         PixelDimensions get_dimensions() const;
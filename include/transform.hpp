@@ -28,6 +28,10 @@ class Transform{
     public:
         /// Generate transform with origin located at the lower left corner
         Transform(float x_pos = 0.0f, float y_pos = 0.0f, float width = 0.0f, float height = 0.0f, float x_origin = 0.0f, float y_origin = 1.0);
+        Transform(const Transform& other) = default;
+        /// Copies the whole state of another transform
+        /// @note The revision ends up above both old revisions, so observers of this transform notice the change
+        Transform& operator=(const Transform& other);
 
         /// Set the position of the transform which means the location of its origin in world coordinates
         void set_pos(float x, float y);
@@ -50,9 +54,9 @@ class Transform{
 
         /// Set the curent rotation in degrees
         /// @note Negative values and values beyond (-)360 are valid
-        void set_rotation(double angle) {m_angle = angle;}
+        void set_rotation(double angle) {m_angle = angle; m_revision++;}
         /// Add degrees to current rotation
-        void rotate(double angle) {m_angle += angle;}
+        void rotate(double angle) {m_angle += angle; m_revision++;}
         /// Read out current rotation in degrees
         double get_rotation() const {return m_angle;}
         /// Set the center of rotation in normalized relative coordinates
@@ -73,6 +77,9 @@ class Transform{
         bool was_moved();
         /// Returns true if the dimensions of the transform (could have) changed since "was_scaled" was called the last time
         bool was_scaled();
+        /// Returns a counter which increases with every change of position, dimensions, rotation or flip
+        /// @note Unlike was_moved and was_scaled reading it doesn't reset anything, so multiple observers may track it
+        unsigned get_revision() const {return m_revision;}
 
         /// Get position at normalized coordinates x and y relative to upper left corner of transform
         /// @example 0.0,0.0 Upper left corner; 0.5,0.5 middle point; 1.0,1.0 lower right corner
@@ -125,10 +132,10 @@ class Transform{
         void set_sort_mode(SortMode s) {m_sort_mode = s;}
         SortMode get_sort_mode() const {return m_sort_mode;}
 
-        void set_h_flip(bool val) {m_horizontal_flip = val;}
+        void set_h_flip(bool val) {m_horizontal_flip = val; m_revision++;}
         bool get_h_flip() const {return m_horizontal_flip;}
 
-        void set_v_flip(bool val) {m_vertical_flip = val;}
+        void set_v_flip(bool val) {m_vertical_flip = val; m_revision++;}
         bool get_v_flip() const {return m_vertical_flip;}
 
     private:
@@ -160,6 +167,7 @@ class Transform{
 
         bool m_moved = false;
         bool m_scaled = false;
+        unsigned m_revision = 0;
 
         static const float MIN_SCALE;
         static const float MIN_ROTATION;
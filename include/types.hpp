@@ -103,6 +103,36 @@ struct PixelRect {
     int w, h;
 };
 
+/// The outcome of a swept movement, see Actor::move_swept()
+struct SweepResult {
+    bool hit = false; ///< True if the movement got stopped by a collision
+    float fraction = 1.0f; ///< The part of the requested movement which got travelled, from 0 to 1
+    Point normal; ///< Surface normal of the first obstacle hit, zero if there wasn't any
+};
+
+/// Usage counters of the actor pool of a template, see MapData::get_actor_pool_stats()
+struct ActorPoolStats {
+    unsigned capacity = 0; ///< Maximum count of pooled actors, set by the POOL_SIZE template property
+    unsigned available = 0; ///< Count of actors currently waiting in the pool
+    unsigned hits = 0; ///< Spawns which got served by the pool
+    unsigned misses = 0; ///< Spawns which had to copy the template because the pool was empty
+};
+
+/// Change of the overlap between an actor and a trigger region, see Collision::trigger()
+enum class TriggerEvent {
+    enter, ///< The actor started to overlap the region during this update
+    stay, ///< The actor overlaps the region since an earlier update
+    exit, ///< The actor stopped overlapping the region during this update
+};
+
+/// State of a path search, see MapData::find_path()
+enum class PathStatus {
+    invalid, ///< There is no such path request
+    searching, ///< The search continues during the next updates
+    found,
+    no_path, ///< Start or goal are blocked, outside of the navigation grid or not connected
+};
+
 #ifdef __EMSCRIPTEN__
     constexpr bool WEB_BUILD = true;
 #else
@@ -161,6 +191,33 @@ enum class AnimSignal{
     wrap = 3, ///< Just reached first frame again after finishing the last frame
 };
 
+/**
+ * @brief Pre-resolved animation type and direction
+ *
+ * Obtained via Actor::get_animation_handle() once, it replaces the string lookup
+ * of animation methods called every frame. Handles stay valid for all actors of the same map.
+ */
+struct AnimationHandle {
+    int state = -1; ///< Interned id of the animation type, negative if invalid
+    Direction dir = Direction::invalid; ///< Direction of the animation, may be Direction::current
+
+    /// Returns true if the animation type could be resolved
+    bool valid() const {return (state >= 0 || state == current_state) && dir != Direction::invalid;}
+
+    static const int current_state = -2; ///< State id referring to the currently active animation type
+};
+
+/**
+ * @brief Pre-resolved property name of a DataBlock
+ *
+ * Obtained via DataBlock::get_key() once, it replaces the string lookup of property
+ * accessors called every frame. Keys stay valid for all DataBlocks.
+ */
+struct DataKey {
+    unsigned id = 0; ///< Interned id of the property name
+    mutable unsigned slot = 0; ///< Table slot of the last lookup, DataBlocks copied from the same template share it
+};
+
 /// Show the state of a button
 struct ButtonState {
     bool pressed = false; ///< True if up in frame before and now down
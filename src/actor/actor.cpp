@@ -18,6 +18,8 @@
  */
 #include "actor/actor.hpp"
 
+#include <algorithm>
+#include <cmath>
 #include <iostream>
 
 #include "map/mapdata.hpp"
@@ -73,11 +75,35 @@ tinyxml2::XMLError Actor::parse_base(tinyxml2::XMLElement* source) {
         Logger(Logger::error) << "Actor at x: " << x_pos << " y: " << y_pos << " is missing a custom name!";
         return XML_NO_ATTRIBUTE;
     }
-    m_name = p_actor_name;
+    set_name(p_actor_name);
 
     return XML_SUCCESS;
 }
 
+/// Rename the actor and keep the name index of its map up to date
+void Actor::set_name(const std::string& name) {
+    if(!m_handle.valid()) {
+        m_name = name;
+        return;
+    }
+    LayerCollection& layer_collection = get_map().get_layer_collection();
+    layer_collection.unindex_actor(*this);
+    m_name = name;
+    layer_collection.index_actor(*this);
+}
+
+/// Change the template type of the actor and keep the type index of its map up to date
+void Actor::set_type(const std::string& type) {
+    if(!m_handle.valid()) {
+        m_type = type;
+        return;
+    }
+    LayerCollection& layer_collection = get_map().get_layer_collection();
+    layer_collection.unindex_actor(*this);
+    m_type = type;
+    layer_collection.index_actor(*this);
+}
+
 /**
  * @brief Initialize custom actor properties from XML info
  * @param source The @c XMLElement which contains the information
@@ -108,7 +134,7 @@ tinyxml2::XMLError Actor::parse_properties(tinyxml2::XMLElement* source) {
                 Logger(Logger::error) << "Empty actor name specified";
                 return XML_ERROR_PARSING_ATTRIBUTE;
             }
-            m_type = p_actor_name;
+            set_type(p_actor_name);
         }
 
         // Parse current direction facing
@@ -143,7 +169,7 @@ tinyxml2::XMLError Actor::parse_properties(tinyxml2::XMLElement* source) {
                     Logger(Logger::error) << "You can't define a specific animation type as the current one";
                     return XML_WRONG_ATTRIBUTE_TYPE;
                 }
-                m_anim_state = anim;
+                m_anim_state = m_map->register_anim_state(anim);
             }
             else {
                 Logger(Logger::error) << "Missing animation type";
@@ -159,6 +185,26 @@ tinyxml2::XMLError Actor::parse_properties(tinyxml2::XMLElement* source) {
             }
         }
 
+        else if(name == "POOL_SIZE") {
+            XMLError eResult = p_property->QueryUnsignedAttribute("value", &m_pool_size);
+            if(eResult != XML_SUCCESS) {
+                Logger(Logger::error) << "Failed parsing the POOL_SIZE property";
+                return eResult;
+            }
+        }
+
+        // Parse collision filter bits, Tiled stores ints signed so -1 sets all bits
+        else if(name == "COLLISION_CATEGORY" || name == "COLLISION_MASK") {
+            int bits;
+            XMLError eResult = p_property->QueryIntAttribute("value", &bits);
+            if(eResult != XML_SUCCESS) {
+                Logger(Logger::error) << "Failed parsing the " << name << " property";
+                return eResult;
+            }
+            if(name == "COLLISION_CATEGORY") {m_collision_category = static_cast<Uint32>(bits);}
+            else {m_collision_mask = static_cast<Uint32>(bits);}
+        }
+
         else {
             XMLError eResult;
             const char* p_type = p_property->Attribute("type");
@@ -222,9 +268,12 @@ tinyxml2::XMLError Actor::parse_properties(tinyxml2::XMLElement* source) {
  */
 void Actor::render(float x_cam, float y_cam) const {
     if(m_hidden) {return;}
-    const Tile* current_tile = nullptr;
-    if(m_anim_state != AnimationType::none && valid_anim_state()) {current_tile = &m_animations.at(m_anim_state).at(m_direction);}
-    else {current_tile = &m_base_tile;}
+    const Tile* current_tile = get_anim_tile(m_anim_state, m_direction);
+    if(current_tile == nullptr) {
+        if(m_tiles == nullptr) {return;}
+        current_tile = &m_tiles->base_tile;
+    }
+    const AnimState& playback = (current_tile == &m_tiles->base_tile) ? m_base_anim : m_anim;
 
     Rect dest = m_transform.to_rect();
     dest.x -= x_cam;
@@ -233,10 +282,10 @@ void Actor::render(float x_cam, float y_cam) const {
     if(m_transform.is_rotated() || m_transform.is_flipped()) {
         double rotation = m_transform.get_rotation();
         auto rot = m_transform.get_rotation_center();
-        current_tile->render_extra(dest, rotation, m_transform.get_h_flip(), m_transform.get_v_flip(), rot.x, rot.y);
+        current_tile->render_extra(dest, playback, rotation, m_transform.get_h_flip(), m_transform.get_v_flip(), rot.x, rot.y);
     }
     else {
-        current_tile->render(dest);
+        current_tile->render(dest, playback);
     }
 }
 
@@ -269,6 +318,131 @@ bool Actor::move_absolute(float x, float y, Collidees target, const std::vector<
     return !unstuck(target,my_hitboxes,other_hitboxes,notify);
 }
 
+/**
+ * @brief Moves relative to current position and stops at the first obstacle on the way
+ *
+ * The hitboxes get swept along the movement, so fast actors can't tunnel through thin
+ * obstacles. Only the tile cells crossed by the movement and the actors within the swept
+ * area are tested. Obstacles which already overlap at the start get ignored.
+ * @return The travelled fraction of the movement and the surface normal of the obstacle
+ */
+SweepResult Actor::move_swept(float x, float y, Collidees target, const std::vector<std::string>& my_hitboxes, const std::vector<std::string>& other_hitboxes, bool notify) {
+    SweepResult result;
+    if(x == 0.0f && y == 0.0f) {return result;}
+    Point motion{x, y};
+
+    // Resolve hitbox names only once for all obstacles
+    HitboxSet mine;
+    for(const std::string& name : my_hitboxes) {
+        int id = HitboxSet::find_id(name);
+        if(id < 0) {continue;}
+        Rect hitbox = get_hitbox(static_cast<HitboxId>(id));
+        if(!hitbox.empty()) {mine.set(static_cast<HitboxId>(id), hitbox);}
+    }
+    std::vector<HitboxId> others;
+    for(const std::string& name : other_hitboxes) {
+        int id = HitboxSet::find_id(name);
+        if(id >= 0) {others.push_back(static_cast<HitboxId>(id));}
+    }
+    if(mine.empty() || others.empty()) {
+        move_relative(x,y);
+        return result;
+    }
+
+    // Bounding box of all participating hitboxes
+    Rect bounds = mine.begin()->rect;
+    for(const auto& hitbox : mine) {
+        float right = std::max(bounds.x + bounds.w, hitbox.rect.x + hitbox.rect.w);
+        float bottom = std::max(bounds.y + bounds.h, hitbox.rect.y + hitbox.rect.h);
+        bounds.x = std::min(bounds.x, hitbox.rect.x);
+        bounds.y = std::min(bounds.y, hitbox.rect.y);
+        bounds.w = right - bounds.x;
+        bounds.h = bottom - bounds.y;
+    }
+
+    // The obstacle of the first impact
+    TileCollisionGrid::Cell hit_tile;
+    Actor* hit_actor = nullptr;
+    HitboxId hit_mine = 0;
+    HitboxId hit_other = 0;
+    Rect hit_rect;
+
+    LayerCollection& layer_collection = get_map().get_layer_collection();
+    if(target == Collidees::tile || target == Collidees::tile_and_actor) {
+        for(MapLayer* map : layer_collection.get_map_layers()) {
+            map->for_each_collision_cell_along(bounds, motion, [&](const TileCollisionGrid::Cell& tile) {
+                for(const auto& first : mine) {
+                    for(HitboxId id : others) {
+                        const Rect* second = tile.hitboxes.find(id);
+                        if(second == nullptr || second->empty()) {continue;}
+                        if(sweep_rect(first.rect, motion, *second, result.fraction, result.normal)) {
+                            result.hit = true;
+                            hit_tile = tile;
+                            hit_actor = nullptr;
+                            hit_mine = first.id;
+                            hit_other = id;
+                            hit_rect = *second;
+                        }
+                    }
+                }
+                return result.fraction;
+            });
+        }
+    }
+    if(target == Collidees::actor || target == Collidees::tile_and_actor) {
+        // Only actors within the remaining swept area can be hit earlier
+        Rect swept = bounds;
+        swept.x += std::min(0.0f, x * result.fraction);
+        swept.y += std::min(0.0f, y * result.fraction);
+        swept.w += std::fabs(x * result.fraction);
+        swept.h += std::fabs(y * result.fraction);
+        for(ObjectLayer* obj : layer_collection.get_object_layers()) {
+            for(Actor* actor : obj->get_clip(swept)) {
+                if(actor == this) {continue;}
+                for(const auto& first : mine) {
+                    for(HitboxId id : others) {
+                        Rect second = actor->get_hitbox(id);
+                        if(second.empty()) {continue;}
+                        if(sweep_rect(first.rect, motion, second, result.fraction, result.normal)) {
+                            result.hit = true;
+                            hit_actor = actor;
+                            hit_mine = first.id;
+                            hit_other = id;
+                            hit_rect = second;
+                        }
+                    }
+                }
+            }
+        }
+    }
+
+    move_relative(x * result.fraction, y * result.fraction);
+
+    if(notify && result.hit) {
+        // The touching edge of both hitboxes
+        Rect first = get_hitbox(hit_mine);
+        Rect contact;
+        if(result.normal.x != 0.0f) {
+            contact.x = (result.normal.x < 0) ? hit_rect.x : hit_rect.x + hit_rect.w;
+            contact.y = std::max(first.y, hit_rect.y);
+            contact.h = std::min(first.y + first.h, hit_rect.y + hit_rect.h) - contact.y;
+        }
+        else {
+            contact.y = (result.normal.y < 0) ? hit_rect.y : hit_rect.y + hit_rect.h;
+            contact.x = std::max(first.x, hit_rect.x);
+            contact.w = std::min(first.x + first.w, hit_rect.x + hit_rect.w) - contact.x;
+        }
+        if(hit_actor != nullptr) {
+            add_collision(CollisionRecord::make_actor(hit_actor,hit_mine,hit_other,contact));
+            hit_actor->add_collision(CollisionRecord::make_actor(this,hit_other,hit_mine,contact));
+        }
+        else {
+            add_collision(CollisionRecord::make_tile(hit_tile.get_instance(),hit_mine,hit_other,contact));
+        }
+    }
+    return result;
+}
+
 void Actor::move_relative(float x, float y) {
     m_transform.move_pos(x,y);
 }
@@ -282,11 +456,11 @@ bool Actor::unstuck(Collidees target, const std::vector<std::string>& my_hitboxe
     bool moved = false;
     if(target == Collidees::tile || target == Collidees::tile_and_actor) {
         for(MapLayer* map : layer_collection.get_map_layers()) {
-            for(TileInstance& tile : map->get_clip(bounds)) {
+            map->for_each_collision_cell(bounds, [&](const TileCollisionGrid::Cell& tile) {
                 if(separate(tile,my_hitboxes,other_hitboxes,notify)) {
                     moved = true;
                 }
-            }
+            });
         }
     }
     if(target == Collidees::actor || target == Collidees::tile_and_actor) {
@@ -307,11 +481,11 @@ bool Actor::unstuck_along_path(float x, float y,Collidees target, const std::vec
     bool moved = false;
     if(target == Collidees::tile || target == Collidees::tile_and_actor) {
         for(MapLayer* map : layer_collection.get_map_layers()) {
-            for(TileInstance& tile : map->get_clip(bounds)) {
+            map->for_each_collision_cell(bounds, [&](const TileCollisionGrid::Cell& tile) {
                 if(separate_along_path(x,y,tile,my_hitboxes,other_hitboxes,notify)) {
                     moved = true;
                 }
-            }
+            });
         }
     }
     if(target == Collidees::actor || target == Collidees::tile_and_actor) {
@@ -337,90 +511,185 @@ bool Actor::unstuck_along_path(float x, float y,Collidees target, const std::vec
  * @param dir The direction of the animation
  * @return @c bool which indicates if the animation finished a cycle/wrapped around
  */
-bool Actor::animate(std::string anim, Direction dir, float speed) {
-    if(anim == AnimationType::current) {anim = m_anim_state;}
-    if(dir == Direction::current) {dir = m_direction;}
+bool Actor::animate(const std::string& anim, Direction dir, float speed) {
+    return animate(get_animation_handle(anim, dir), speed);
+}
 
-    Tile* current_tile = nullptr;
-    if(anim == AnimationType::none) {current_tile = &m_base_tile;}
-    else if(valid_anim_state(anim,dir)) {
-        current_tile = &m_animations[anim][dir];
-    }
-    else {return false;}
+/**
+ * @brief Set animation tile to specific frame
+ */
+bool Actor::set_animation(const std::string& anim, Direction dir, int frame) {
+    return set_animation(get_animation_handle(anim, dir), frame);
+}
 
-    if(m_anim_state != anim || m_direction != dir) {
-        // Set rendering dimensions to current tile
-        m_transform.set_dimensions(current_tile->get_w(), current_tile->get_h());
-        m_anim_state = anim;
-        m_direction = dir;
-        current_tile->init_anim();
-    }
+/**
+ * @brief Animate the actor
+ * @param anim The type of the animation
+ * @param dir The direction of the animation
+ * @return @c AnimSignal which indicates if the animation finished a cycle or hit its trigger frame
+ */
+AnimSignal Actor::animate_trigger(const std::string& anim, Direction dir, float speed) {
+    return animate_trigger(get_animation_handle(anim, dir), speed);
+}
 
-    return current_tile->push_anim(speed);
+/**
+ * @brief Resolve animation type and direction once for repeated use
+ * @param anim The type of the animation, may be AnimationType::current
+ * @param dir The direction of the animation, may be Direction::current
+ * @return @c AnimationHandle which is invalid if the animation type is unknown to the map
+ */
+AnimationHandle Actor::get_animation_handle(const std::string& anim, Direction dir) const {
+    AnimationHandle handle;
+    handle.dir = dir;
+    if(anim == AnimationType::current) {handle.state = AnimationHandle::current_state;}
+    else {handle.state = m_map->get_anim_state(anim);}
+    return handle;
+}
+
+/// Animate the actor by a pre-resolved animation handle
+bool Actor::animate(AnimationHandle anim, float speed) {
+    if(is_paused()) {return false;}
+    const Tile* current_tile = switch_animation(anim);
+    if(current_tile == nullptr) {return false;}
+    return current_tile->push_anim(get_playback(), speed, m_map->get_ticks());
+}
+
+/// Set animation tile of a pre-resolved animation handle to specific frame
+bool Actor::set_animation(AnimationHandle anim, int frame) {
+    const Tile* current_tile = switch_animation(anim);
+    if(current_tile == nullptr) {return false;}
+    return current_tile->set_frame(get_playback(), frame, m_map->get_ticks());
+}
+
+/// Animate the actor by a pre-resolved animation handle
+AnimSignal Actor::animate_trigger(AnimationHandle anim, float speed) {
+    if(is_paused()) {return AnimSignal::none;}
+    const Tile* current_tile = switch_animation(anim);
+    if(current_tile == nullptr) {return AnimSignal::missing;}
+    return current_tile->push_anim_trigger(get_playback(), speed, m_map->get_ticks());
 }
 
 /**
- * @brief Set animation tile to specific frame
+ * @brief Keep the actor awake, even outside of the activity regions of the map
+ * @param seconds How long the actor stays awake, at least until the next map update
  */
-bool Actor::set_animation(std::string anim, Direction dir, int frame) {
-    if(anim == AnimationType::current) {anim = m_anim_state;}
-    if(dir == Direction::current) {dir = m_direction;}
+void Actor::wake(float seconds) {
+    m_sleeping = false;
+    m_sleep_tick = false;
+    m_wake_pending = true;
+    m_wake_until = m_map->get_ticks() + static_cast<Uint32>(seconds * 1000);
+}
 
-    Tile* current_tile = nullptr;
-    if(anim == AnimationType::none) {current_tile = &m_base_tile;}
-    else if(valid_anim_state(anim,dir)) {
-        current_tile = &m_animations[anim][dir];
-    }
-    else {return false;}
+/// Returns true if wake() asks to keep the actor awake right now, consumes the pending wake up
+bool Actor::check_wake() {
+    bool awake = m_wake_pending || static_cast<Sint32>(m_wake_until - m_map->get_ticks()) > 0;
+    m_wake_pending = false;
+    return awake;
+}
 
-    if(m_anim_state != anim || m_direction != dir) {
-        // Set rendering dimensions to current tile
-        m_transform.set_dimensions(current_tile->get_w(), current_tile->get_h());
-        m_anim_state = anim;
+/**
+ * @brief Make the animation tile of the handle the active one
+ * @return Pointer to the now active tile or nullptr if the animation doesn't exist
+ *
+ * If the animation changes, rendering dimensions get adjusted and the
+ * new animation starts from its first frame.
+ */
+const Tile* Actor::switch_animation(AnimationHandle anim) {
+    int state = (anim.state == AnimationHandle::current_state) ? m_anim_state : anim.state;
+    Direction dir = (anim.dir == Direction::current) ? m_direction : anim.dir;
+
+    if(!valid_anim_state(state, dir)) {return nullptr;}
+    const Tile* current_tile = get_anim_tile(state, dir);
+
+    if(m_anim_state != state || m_direction != dir) {
+        m_anim_state = state;
         m_direction = dir;
-        current_tile->init_anim();
+        current_tile->init_anim(get_playback(), m_map->get_ticks());
+        // Set rendering dimensions to current tile
+        m_transform.set_dimensions(current_tile->get_w(get_playback()), current_tile->get_h(get_playback()));
     }
+    return current_tile;
+}
 
-    return current_tile->set_frame(frame);
+/// Returns the animation tile of the state direction combination or nullptr if there is none
+const Tile* Actor::get_anim_tile(int state, Direction dir) const {
+    if(m_tiles == nullptr) {return nullptr;}
+    if(state == 0) {return &m_tiles->base_tile;}
+    unsigned dir_index = dir_to_index(dir);
+    if(state < 0 || dir_index >= DIRECTION_COUNT) {return nullptr;}
+    unsigned slot = state * DIRECTION_COUNT + dir_index;
+    const std::vector<Tile>& animations = m_tiles->animations;
+    if(slot >= animations.size() || !animations[slot].is_valid()) {return nullptr;}
+    return &animations[slot];
 }
 
 /**
- * @brief Animate the actor
- * @param anim The type of the animation
- * @param dir The direction of the animation
- * @return @c AnimSignal which indicates if the animation finished a cycle or hit its trigger frame
+ * @brief Returns the tiles of this actor for modification
+ *
+ * Actors spawned from the same template share their tiles, so they
+ * get copied before the first modification.
  */
-AnimSignal Actor::animate_trigger(std::string anim, Direction dir, float speed) {
-    if(anim == AnimationType::current) {anim = m_anim_state;}
-    if(dir == Direction::current) {dir = m_direction;}
+ActorTiles& Actor::edit_tiles() {
+    if(m_tiles == nullptr) {m_tiles = std::make_shared<ActorTiles>();}
+    else if(m_tiles.use_count() > 1) {m_tiles = std::make_shared<ActorTiles>(*m_tiles);}
+    // The cached world hitboxes came from the old tiles
+    m_hitbox_key = HitboxCacheKey{};
+    return *m_tiles;
+}
 
-    Tile* current_tile = nullptr;
-    if(anim == AnimationType::none) {current_tile = &m_base_tile;}
-    else if(valid_anim_state(anim,dir)) {
-        current_tile = &m_animations[anim][dir];
-    }
-    else {return AnimSignal::missing;}
+/// Returns the frame count of the currently active animation tile or the base tile if there is none
+int Actor::get_frame_count() const {
+    const Tile* current_tile = get_anim_tile(m_anim_state, m_direction);
+    if(current_tile == nullptr) {current_tile = get_anim_tile(0, m_direction);}
+    return (current_tile == nullptr) ? 0 : current_tile->get_frame_count();
+}
 
-    if(m_anim_state != anim || m_direction != dir) {
-        // Set rendering dimensions to current tile
-        m_transform.set_dimensions(current_tile->get_w(), current_tile->get_h());
-        m_anim_state = anim;
-        m_direction = dir;
-        current_tile->init_anim();
-    }
+/// Set the base tile of the actor which is shown if there is no animation
+void Actor::set_tile(const Tile& tile) {
+    edit_tiles().base_tile = tile;
+    tile.init_anim(m_base_anim, m_map->get_ticks());
+}
 
-    return current_tile->push_anim_trigger(speed);
+/// Returns the name of the currently active animation type
+std::string Actor::get_animation() const {
+    return m_map->get_anim_state_name(m_anim_state);
 }
 
-/// Checks if the currently set animation state and direction are existing
-bool Actor::valid_anim_state(std::string anim, Direction dir) const {
-    //if(m_anim_state == AnimationType::none) {return true;}
-    if(m_animations.find(anim) == m_animations.end()) {
+/**
+ * @brief Store a copy of an animation tile in the animation table
+ * @param state The interned id of the animation type
+ * @param dir The direction of the animation
+ * @param tile The animation tile
+ */
+void Actor::add_animation(unsigned state, Direction dir, const Tile& tile) {
+    unsigned dir_index = dir_to_index(dir);
+    if(dir_index >= DIRECTION_COUNT) {
+        Logger(Logger::error) << "Direction " << static_cast<int>(dir) << " can't hold an animation";
+        return;
+    }
+    unsigned slot = state * DIRECTION_COUNT + dir_index;
+    std::vector<Tile>& animations = edit_tiles().animations;
+    if(slot >= animations.size()) {animations.resize((state + 1) * DIRECTION_COUNT);}
+    animations[slot] = tile;
+    animations[slot].init_anim(m_anim, m_map->get_ticks());
+}
+
+/// Checks if the animation state and direction are existing
+bool Actor::valid_anim_state(const std::string& anim, Direction dir) const {
+    int state = (anim == AnimationType::current) ? m_anim_state : m_map->get_anim_state(anim);
+    if(state < 0) {
         Logger(Logger::error) << "Animation state " << anim << " for actor " << m_name << " is not defined!";
         return false;
     }
-    if(m_animations.at(anim).find(dir) == m_animations.at(anim).end()) {
-        Logger(Logger::error) << "Direction" << static_cast<int>(dir) << " for animation state " << anim << " of actor " << m_name << " is not defined!";
+    return valid_anim_state(state, dir);
+}
+
+/// Checks if the interned animation state and direction are existing
+bool Actor::valid_anim_state(int state, Direction dir) const {
+    if(dir == Direction::current) {dir = m_direction;}
+    if(get_anim_tile(state, dir) == nullptr) {
+        std::string anim = (state >= 0) ? m_map->get_anim_state_name(state) : AnimationType::invalid;
+        Logger(Logger::error) << "Direction " << static_cast<int>(dir) << " for animation state " << anim << " of actor " << m_name << " is not defined!";
         return false;
     }
     return true;
@@ -431,49 +700,68 @@ bool Actor::valid_anim_state(std::string anim, Direction dir) const {
  * @param type The supplied type
  * @return @c Rect The hitbox
  * @note If there is no valid hitbox an empty one gets returned
- *
- * First the actor checks if the active animation has the hitbox with the name
- * and returns it instead.
  */
-Rect Actor::get_hitbox(std::string type) const {
-
-
-    Rect current_hitbox = {0,0,0,0};
-    // Try extracting hitbox from currenty active animated tile
-    if(m_anim_state != AnimationType::none && valid_anim_state()) {
-        current_hitbox = m_animations.at(m_anim_state).at(m_direction).get_hitbox(type);
-    }
-    // If that failed, extract hitbox from base actor tile
-    if(current_hitbox.empty()) {current_hitbox = m_base_tile.get_hitbox(type);}
-    // If that also failed just return the empty hitbox
-    if(current_hitbox.empty()) {return current_hitbox;}
-
-    // Otherwise adjust hitbox position and return
-    m_transform.transform_hitbox(current_hitbox);
-
-    return current_hitbox;
+Rect Actor::get_hitbox(const std::string& type) const {
+    int id = HitboxSet::find_id(type);
+    if(id < 0) {return Rect{0,0,0,0};}
+    return get_hitbox(static_cast<HitboxId>(id));
 }
 
 /**
- * @brief Returns all active hitboxes
+ * @brief Returns all active hitboxes in world coordinates
  *
  * To the hitboxes of the actor tile, possible hitboxes of the active
  * animation and its animation frame are added. Specific ones may override general ones.
+ *
+ * The result is cached and only recomputed if the transform, the tiles,
+ * the animation or one of the animation frames changed.
  */
-const std::map<std::string, Rect> Actor::get_hitboxes() const {
-    // Get all hitboxes from base tile
-    std::map<std::string, Rect> hitboxes = m_base_tile.get_hitboxes();
-    // If there is a valid animation tile, load those "ontop" of the other hitboxes
-    if(m_anim_state != AnimationType::none && valid_anim_state()) {
-        for(const auto& hitbox_pair: m_animations.at(m_anim_state).at(m_direction).get_hitboxes()) {
-            hitboxes[hitbox_pair.first] = hitbox_pair.second;
+const HitboxSet& Actor::get_hitboxes() const {
+    HitboxCacheKey key;
+    key.revision = m_transform.get_revision();
+    key.state = m_anim_state;
+    key.dir = m_direction;
+    key.base_frame = m_base_anim.frame;
+    const Tile* anim_tile = get_anim_tile(m_anim_state, m_direction);
+    if(anim_tile != nullptr) {key.frame = get_playback().frame;}
+
+    if(key == m_hitbox_key) {return m_world_hitboxes;}
+    m_hitbox_key = key;
+
+    HitboxSet hitboxes;
+    if(m_tiles != nullptr) {
+        // Get all hitboxes from base tile
+        const Tile& base_tile = m_tiles->base_tile;
+        hitboxes = base_tile.get_hitboxes(m_base_anim);
+        // If there is a valid animation tile, load those "ontop" of the other hitboxes
+        if(anim_tile != nullptr && anim_tile != &base_tile) {
+            hitboxes.merge(anim_tile->get_hitboxes(m_anim));
+        }
+        // Adjust each hitbox position
+        for(auto& hitbox : hitboxes) {
+            m_transform.transform_hitbox(hitbox.rect);
         }
     }
-    // Adjust each hitbox position and return
-    for(auto& hitbox_pair : hitboxes) {
-        m_transform.transform_hitbox(hitbox_pair.second);
+    // Contacts also depend on the pixel mask, which a new frame or flip can change while the hitboxes stay the same
+    Point mask_pos;
+    const PixelMask* mask = get_pixel_mask(mask_pos);
+    if(hitboxes != m_world_hitboxes || mask != m_hitbox_mask) {
+        m_world_hitboxes = hitboxes;
+        m_hitbox_mask = mask;
+        m_hitbox_generation++;
     }
-    return hitboxes;
+    return m_world_hitboxes;
+}
+
+/**
+ * @brief Returns a counter which increases whenever the world space hitboxes or the pixel mask change
+ *
+ * Moving, scaling or animating the actor only counts if it actually alters a hitbox
+ * or selects another mask, see get_pixel_mask().
+ */
+unsigned Actor::get_hitbox_generation() const {
+    get_hitboxes();
+    return m_hitbox_generation;
 }
 
 /**
@@ -515,18 +803,23 @@ bool Actor::on_ground(Collidees target, std::string my_hitbox, const std::vector
     return m_map->get_layer_collection().check_collision(temp, target,other_hitboxes);
 }
 
-bool Actor::separate(TileInstance& tile, const std::vector<std::string>& my_hitboxes, const std::vector<std::string>& other_hitboxes, bool notify) {
+bool Actor::separate(const TileCollisionGrid::Cell& tile, const std::vector<std::string>& my_hitboxes, const std::vector<std::string>& other_hitboxes, bool notify) {
     bool moved = false;
-    for(std::string first_hitbox_name : my_hitboxes) {
-        Rect first_hitbox = get_hitbox(first_hitbox_name);
+    for(const std::string& first_hitbox_name : my_hitboxes) {
+        int first_id = HitboxSet::find_id(first_hitbox_name);
+        if(first_id < 0) {continue;}
+        Rect first_hitbox = get_hitbox(static_cast<HitboxId>(first_id));
         if(first_hitbox.empty()) {continue;}
-        for(std::string second_hitbox_name : other_hitboxes) {
-            Rect second_hitbox = tile.get_hitbox(second_hitbox_name);
+        for(const std::string& second_hitbox_name : other_hitboxes) {
+            int second_id = HitboxSet::find_id(second_hitbox_name);
+            if(second_id < 0) {continue;}
+            Rect second_hitbox = tile.hitboxes.get(static_cast<HitboxId>(second_id));
             if(second_hitbox.empty()) {continue;}
             if(separate(first_hitbox, second_hitbox)) {
                 moved = true;
                 if(notify) {
-                    add_collision({tile,first_hitbox_name,second_hitbox_name});
+                    Rect contact = first_hitbox.get_intersection(second_hitbox);
+                    add_collision(CollisionRecord::make_tile(tile.get_instance(),static_cast<HitboxId>(first_id),static_cast<HitboxId>(second_id),contact));
                 }
             }
         }
@@ -537,17 +830,22 @@ bool Actor::separate(TileInstance& tile, const std::vector<std::string>& my_hitb
 bool Actor::separate(Actor& actor, const std::vector<std::string>& my_hitboxes, const std::vector<std::string>& other_hitboxes, bool notify) {
     if(&actor == this) {return false;}
     bool moved = false;
-    for(std::string first_hitbox_name : my_hitboxes) {
-        Rect first_hitbox = get_hitbox(first_hitbox_name);
+    for(const std::string& first_hitbox_name : my_hitboxes) {
+        int first_id = HitboxSet::find_id(first_hitbox_name);
+        if(first_id < 0) {continue;}
+        Rect first_hitbox = get_hitbox(static_cast<HitboxId>(first_id));
         if(first_hitbox.empty()) {continue;}
-        for(std::string second_hitbox_name : other_hitboxes) {
-            Rect second_hitbox = actor.get_hitbox(second_hitbox_name);
+        for(const std::string& second_hitbox_name : other_hitboxes) {
+            int second_id = HitboxSet::find_id(second_hitbox_name);
+            if(second_id < 0) {continue;}
+            Rect second_hitbox = actor.get_hitbox(static_cast<HitboxId>(second_id));
             if(second_hitbox.empty()) {continue;}
             if(separate(first_hitbox, second_hitbox)) {
                 moved = true;
                 if(notify) {
-                    add_collision({&actor,first_hitbox_name,second_hitbox_name});
-                    actor.add_collision({this,second_hitbox_name,first_hitbox_name});
+                    Rect contact = first_hitbox.get_intersection(second_hitbox);
+                    add_collision(CollisionRecord::make_actor(&actor,static_cast<HitboxId>(first_id),static_cast<HitboxId>(second_id),contact));
+                    actor.add_collision(CollisionRecord::make_actor(this,static_cast<HitboxId>(second_id),static_cast<HitboxId>(first_id),contact));
                 }
             }
         }
@@ -586,18 +884,23 @@ bool Actor::separate(const Rect& first, const Rect& second) {
     return true;
 }
 
-bool Actor::separate_along_path(float x, float y,TileInstance& tile, const std::vector<std::string>& my_hitboxes, const std::vector<std::string>& other_hitboxes, bool notify) {
+bool Actor::separate_along_path(float x, float y,const TileCollisionGrid::Cell& tile, const std::vector<std::string>& my_hitboxes, const std::vector<std::string>& other_hitboxes, bool notify) {
     bool moved = false;
-    for(std::string first_hitbox_name : my_hitboxes) {
-        Rect first_hitbox = get_hitbox(first_hitbox_name);
+    for(const std::string& first_hitbox_name : my_hitboxes) {
+        int first_id = HitboxSet::find_id(first_hitbox_name);
+        if(first_id < 0) {continue;}
+        Rect first_hitbox = get_hitbox(static_cast<HitboxId>(first_id));
         if(first_hitbox.empty()) {continue;}
-        for(std::string second_hitbox_name : other_hitboxes) {
-            Rect second_hitbox = tile.get_hitbox(second_hitbox_name);
+        for(const std::string& second_hitbox_name : other_hitboxes) {
+            int second_id = HitboxSet::find_id(second_hitbox_name);
+            if(second_id < 0) {continue;}
+            Rect second_hitbox = tile.hitboxes.get(static_cast<HitboxId>(second_id));
             if(second_hitbox.empty()) {continue;}
             if(separate_along_path(x, y,first_hitbox, second_hitbox)) {
                 moved = true;
                 if(notify) {
-                    add_collision({tile,first_hitbox_name,second_hitbox_name});
+                    Rect contact = first_hitbox.get_intersection(second_hitbox);
+                    add_collision(CollisionRecord::make_tile(tile.get_instance(),static_cast<HitboxId>(first_id),static_cast<HitboxId>(second_id),contact));
                 }
             }
         }
@@ -608,17 +911,22 @@ bool Actor::separate_along_path(float x, float y,TileInstance& tile, const std::
 bool Actor::separate_along_path(float x, float y,Actor& actor, const std::vector<std::string>& my_hitboxes, const std::vector<std::string>& other_hitboxes, bool notify) {
     if(&actor == this) {return false;}
     bool moved = false;
-    for(std::string first_hitbox_name : my_hitboxes) {
-        Rect first_hitbox = get_hitbox(first_hitbox_name);
+    for(const std::string& first_hitbox_name : my_hitboxes) {
+        int first_id = HitboxSet::find_id(first_hitbox_name);
+        if(first_id < 0) {continue;}
+        Rect first_hitbox = get_hitbox(static_cast<HitboxId>(first_id));
         if(first_hitbox.empty()) {continue;}
-        for(std::string second_hitbox_name : other_hitboxes) {
-            Rect second_hitbox = actor.get_hitbox(second_hitbox_name);
+        for(const std::string& second_hitbox_name : other_hitboxes) {
+            int second_id = HitboxSet::find_id(second_hitbox_name);
+            if(second_id < 0) {continue;}
+            Rect second_hitbox = actor.get_hitbox(static_cast<HitboxId>(second_id));
             if(second_hitbox.empty()) {continue;}
             if(separate_along_path(x, y,first_hitbox, second_hitbox)) {
                 moved = true;
                 if(notify) {
-                    add_collision({&actor,first_hitbox_name,second_hitbox_name});
-                    actor.add_collision({this,second_hitbox_name,first_hitbox_name});
+                    Rect contact = first_hitbox.get_intersection(second_hitbox);
+                    add_collision(CollisionRecord::make_actor(&actor,static_cast<HitboxId>(first_id),static_cast<HitboxId>(second_id),contact));
+                    actor.add_collision(CollisionRecord::make_actor(this,static_cast<HitboxId>(second_id),static_cast<HitboxId>(first_id),contact));
                 }
             }
         }
@@ -775,37 +1083,60 @@ bool Actor::separate_along_path(float x1, float y1, float x2, float y2, Actor& a
 
 
 bool Actor::check_collision(Actor& other, bool notify) {
+    std::vector<PendingCollision> pending;
+    bool collided = collect_collisions(other, pending);
+    if(notify) {
+        for(const PendingCollision& p : pending) {p.actor->add_collision(p.record);}
+    }
+    return collided;
+}
+
+/**
+ * @brief Test all hitboxes of this actor against all hitboxes of another actor
+ * @param pending Receives the collisions of both actors instead of adding them directly
+ *
+ * Doesn't modify either actor as long as their hitbox caches are up to date,
+ * so it may run concurrently for distinct pending buffers.
+ */
+bool Actor::collect_collisions(Actor& other, std::vector<PendingCollision>& pending) {
     bool collided = false;
-    for(auto first_hitbox : get_hitboxes()) {
-        Rect& first = first_hitbox.second;
+    for(const auto& first_hitbox : get_hitboxes()) {
+        const Rect& first = first_hitbox.rect;
         if(first.empty()) {continue;}
-        for(auto second_hitbox : other.get_hitboxes()) {
-            Rect& second = second_hitbox.second;
+        for(const auto& second_hitbox : other.get_hitboxes()) {
+            const Rect& second = second_hitbox.rect;
             if(second.empty()) {continue;}
             if(first.has_intersection(second)) {
+                Rect contact = first.get_intersection(second);
+                if(!pixels_overlap(contact, other)) {continue;}
                 collided = true;
-                if(notify) {
-                    add_collision({&other,first_hitbox.first,second_hitbox.first});
-                    other.add_collision({this,second_hitbox.first,first_hitbox.first});
-                }
+                pending.push_back({this, CollisionRecord::make_actor(&other,first_hitbox.id,second_hitbox.id,contact)});
+                pending.push_back({&other, CollisionRecord::make_actor(this,second_hitbox.id,first_hitbox.id,contact)});
             }
         }
     }
     return collided;
 }
+
 bool Actor::check_collision(Actor& other, const std::vector<std::string>& my_hitboxes, const std::vector<std::string>& other_hitboxes, bool notify) {
     bool collided = false;
-    for(std::string first_hitbox_name : my_hitboxes) {
-        Rect first_hitbox = get_hitbox(first_hitbox_name);
+    for(const std::string& first_hitbox_name : my_hitboxes) {
+        int first_id = HitboxSet::find_id(first_hitbox_name);
+        if(first_id < 0) {continue;}
+        Rect first_hitbox = get_hitbox(static_cast<HitboxId>(first_id));
         if(first_hitbox.empty()) {continue;}
-        for(std::string second_hitbox_name : other_hitboxes) {
-            Rect second_hitbox = other.get_hitbox(second_hitbox_name);
+        for(const std::string& second_hitbox_name : other_hitboxes) {
+            int second_id = HitboxSet::find_id(second_hitbox_name);
+            if(second_id < 0) {continue;}
+            Rect second_hitbox = other.get_hitbox(static_cast<HitboxId>(second_id));
             if(second_hitbox.empty()) {continue;}
             if(first_hitbox.has_intersection(second_hitbox)) {
+                Rect contact = first_hitbox.get_intersection(second_hitbox);
+                if(!pixels_overlap(contact, other)) {continue;}
                 collided = true;
                 if(notify) {
-                    add_collision({&other,first_hitbox_name,second_hitbox_name});
-                    other.add_collision({this,second_hitbox_name,first_hitbox_name});
+                    add_collision(CollisionRecord::make_actor(&other,static_cast<HitboxId>(first_id),static_cast<HitboxId>(second_id),contact));
+                    other.add_collision(CollisionRecord::make_actor(this,static_cast<HitboxId>(second_id),static_cast<HitboxId>(first_id),contact));
                 }
             }
         }
@@ -813,36 +1144,55 @@ bool Actor::check_collision(Actor& other, const std::vector<std::string>& my_hit
     return collided;
 }
 
-bool Actor::check_collision(TileInstance& other, bool notify) {
+bool Actor::check_collision(const TileCollisionGrid::Cell& other, bool notify) {
+    std::vector<PendingCollision> pending;
+    bool collided = collect_collisions(other, pending);
+    if(notify) {
+        for(const PendingCollision& p : pending) {p.actor->add_collision(p.record);}
+    }
+    return collided;
+}
+
+/**
+ * @brief Test all hitboxes of this actor against all hitboxes of a tile
+ * @param pending Receives the collisions instead of adding them directly
+ */
+bool Actor::collect_collisions(const TileCollisionGrid::Cell& other, std::vector<PendingCollision>& pending) {
     bool collided = false;
-    for(auto first_hitbox : get_hitboxes()) {
-        Rect& first = first_hitbox.second;
+    for(const auto& first_hitbox : get_hitboxes()) {
+        const Rect& first = first_hitbox.rect;
         if(first.empty()) {continue;}
-        for(auto second_hitbox : other.get_hitboxes()) {
-            Rect& second = second_hitbox.second;
+        for(const auto& second_hitbox : other.hitboxes) {
+            const Rect& second = second_hitbox.rect;
             if(second.empty()) {continue;}
             if(first.has_intersection(second)) {
+                Rect contact = first.get_intersection(second);
+                if(!pixels_overlap(contact, other)) {continue;}
                 collided = true;
-                if(notify) {
-                    add_collision({other,first_hitbox.first,second_hitbox.first});
-                }
+                pending.push_back({this, CollisionRecord::make_tile(other.get_instance(),first_hitbox.id,second_hitbox.id,contact)});
             }
         }
     }
     return collided;
 }
-bool Actor::check_collision(TileInstance& other, const std::vector<std::string>& my_hitboxes, const std::vector<std::string>& other_hitboxes, bool notify) {
+bool Actor::check_collision(const TileCollisionGrid::Cell& other, const std::vector<std::string>& my_hitboxes, const std::vector<std::string>& other_hitboxes, bool notify) {
     bool collided = false;
-    for(std::string first_hitbox_name : my_hitboxes) {
-        Rect first_hitbox = get_hitbox(first_hitbox_name);
+    for(const std::string& first_hitbox_name : my_hitboxes) {
+        int first_id = HitboxSet::find_id(first_hitbox_name);
+        if(first_id < 0) {continue;}
+        Rect first_hitbox = get_hitbox(static_cast<HitboxId>(first_id));
         if(first_hitbox.empty()) {continue;}
-        for(std::string second_hitbox_name : other_hitboxes) {
-            Rect second_hitbox = other.get_hitbox(second_hitbox_name);
+        for(const std::string& second_hitbox_name : other_hitboxes) {
+            int second_id = HitboxSet::find_id(second_hitbox_name);
+            if(second_id < 0) {continue;}
+            Rect second_hitbox = other.hitboxes.get(static_cast<HitboxId>(second_id));
             if(second_hitbox.empty()) {continue;}
             if(first_hitbox.has_intersection(second_hitbox)) {
+                Rect contact = first_hitbox.get_intersection(second_hitbox);
+                if(!pixels_overlap(contact, other)) {continue;}
                 collided = true;
                 if(notify) {
-                    add_collision({other,first_hitbox_name,second_hitbox_name});
+                    add_collision(CollisionRecord::make_tile(other.get_instance(),static_cast<HitboxId>(first_id),static_cast<HitboxId>(second_id),contact));
                 }
             }
         }
@@ -850,5 +1200,77 @@ bool Actor::check_collision(TileInstance& other, const std::vector<std::string>&
     return collided;
 }
 
+/**
+ * @brief Returns the pixel mask of the currently shown tile
+ * @param pos Receives the world position of the mask
+ * @return nullptr if the tile has no mask or the actor is rotated or scaled
+ *
+ * Without a mask the actor counts as fully opaque, so its hitboxes decide alone.
+ */
+const PixelMask* Actor::get_pixel_mask(Point& pos) const {
+    if(m_tiles == nullptr || m_transform.is_rotated()) {return nullptr;}
+    const Tile* current_tile = get_anim_tile(m_anim_state, m_direction);
+    if(current_tile == nullptr) {current_tile = &m_tiles->base_tile;}
+    const AnimState& playback = (current_tile == &m_tiles->base_tile) ? m_base_anim : m_anim;
+
+    Uint32 flip_flags = (m_transform.get_h_flip() ? 0x80000000 : 0) | (m_transform.get_v_flip() ? 0x40000000 : 0);
+    const PixelMask* mask = current_tile->get_pixel_mask(flip_flags, playback);
+    if(mask == nullptr) {return nullptr;}
+    Rect dest = m_transform.to_rect();
+    if(std::fabs(dest.w - mask->get_w()) >= 1.0f || std::fabs(dest.h - mask->get_h()) >= 1.0f) {return nullptr;}
+    pos = Point{dest.x, dest.y};
+    return mask;
+}
+
+/// Returns true if the opaque pixels of both actors overlap within the contact rect of two hitboxes
+bool Actor::pixels_overlap(const Rect& contact, const Actor& other) const {
+    Point own_pos, other_pos;
+    const PixelMask* own_mask = get_pixel_mask(own_pos);
+    const PixelMask* other_mask = other.get_pixel_mask(other_pos);
+    return PixelMask::overlap(contact, own_mask, own_pos, other_mask, other_pos);
+}
+
+/// Returns true if the opaque pixels of the actor and the tile overlap within the contact rect of two hitboxes
+bool Actor::pixels_overlap(const Rect& contact, const TileCollisionGrid::Cell& other) const {
+    Point own_pos, other_pos;
+    const PixelMask* own_mask = get_pixel_mask(own_pos);
+    const PixelMask* other_mask = other.get_pixel_mask(other_pos);
+    return PixelMask::overlap(contact, own_mask, own_pos, other_mask, other_pos);
+}
+
+/// Records the collision in the collision stream of the map, if collisions get registered
+void Actor::add_collision(const CollisionRecord& c) {
+    if(m_register_collisions) {
+        m_collision_view.add(m_map->get_collision_stream(), c);
+    }
+}
+
+/**
+ * @brief Returns all collisions of this actor since the start of the current frame
+ *
+ * The compact records of the collision stream get expanded here, so the cost
+ * of building Collision objects only occurs if they are actually requested.
+ * Collisions with actors which got removed since keep their actor id but no actor.
+ * @note References stay valid until the next call of this function
+ */
+std::vector<Collision>& Actor::get_collisions() {
+    m_collisions.clear();
+    const CollisionStream& stream = m_map->get_collision_stream();
+    const LayerCollection& layer_collection = m_map->get_layer_collection();
+    for(int i = m_collision_view.head(stream); i >= 0; i = stream[i].next) {
+        const CollisionRecord& record = stream[i];
+        // Don't hand out actors which got removed in the meantime
+        if(record.kind == CollisionRecord::actor && record.actor_handle.valid() && !layer_collection.check_actor(record.actor_handle)) {
+            CollisionRecord removed = record;
+            removed.other.actor = nullptr;
+            m_collisions.emplace_back(removed);
+        }
+        else {
+            m_collisions.emplace_back(record);
+        }
+    }
+    return m_collisions;
+}
+
 }} // namespace salmon::internal
 
@@ -22,17 +22,31 @@
 #include <string>
 #include <vector>
 #include <map>
+#include <memory>
 #include <tinyxml2.h>
 
 #include "transform.hpp"
 #include "actor/collision.hpp"
 #include "actor/data_block.hpp"
 #include "map/tile.hpp"
+#include "map/tile_collision_grid.hpp"
 #include "util/game_types.hpp"
+#include "util/slot_map.hpp"
 
 namespace salmon { namespace internal {
 
 class MapData;
+class ObjectLayer;
+struct ActorPool;
+
+/// Generational reference to an actor stored in a LayerCollection
+typedef SlotHandle ActorHandle;
+
+/// Tiles of an actor template which all actors spawned from it share
+struct ActorTiles {
+    Tile base_tile;
+    std::vector<Tile> animations; ///< Animation tiles indexed by state * DIRECTION_COUNT + direction index
+};
 
 /**
  * @brief Parse, store and manage all actors
@@ -47,9 +61,15 @@ class Actor{
         tinyxml2::XMLError parse_base(tinyxml2::XMLElement* source);
         tinyxml2::XMLError parse_properties(tinyxml2::XMLElement* source);
 
-        bool animate(std::string anim = AnimationType::current, Direction dir = Direction::current, float speed = 1.0);
-        bool set_animation(std::string anim = AnimationType::current, Direction dir = Direction::current, int frame = 0);
-        AnimSignal animate_trigger(std::string anim = AnimationType::current, Direction dir = Direction::current, float speed = 1.0);
+        bool animate(const std::string& anim = AnimationType::current, Direction dir = Direction::current, float speed = 1.0);
+        bool set_animation(const std::string& anim = AnimationType::current, Direction dir = Direction::current, int frame = 0);
+        AnimSignal animate_trigger(const std::string& anim = AnimationType::current, Direction dir = Direction::current, float speed = 1.0);
+
+        // Animation by pre-resolved handles
+        AnimationHandle get_animation_handle(const std::string& anim, Direction dir = Direction::current) const;
+        bool animate(AnimationHandle anim, float speed = 1.0);
+        bool set_animation(AnimationHandle anim, int frame = 0);
+        AnimSignal animate_trigger(AnimationHandle anim, float speed = 1.0);
 
         void render(float x_cam, float y_cam) const;
 
@@ -59,6 +79,7 @@ class Actor{
         // Move with collision
         bool move_relative(float x, float y, Collidees target, const std::vector<std::string>& my_hitboxes, const std::vector<std::string>& other_hitboxes, bool notify);
         bool move_absolute(float x, float y, Collidees target, const std::vector<std::string>& my_hitboxes, const std::vector<std::string>& other_hitboxes, bool notify);
+        SweepResult move_swept(float x, float y, Collidees target, const std::vector<std::string>& my_hitboxes, const std::vector<std::string>& other_hitboxes, bool notify);
         // Move without collision
         void move_relative(float x, float y);
         void move_absolute(float x, float y);
@@ -70,20 +91,27 @@ class Actor{
         bool check_collision(Actor& other, bool notify);
         bool check_collision(Actor& other, const std::vector<std::string>& my_hitboxes, const std::vector<std::string>& other_hitboxes, bool notify);
 
-        bool check_collision(TileInstance& other, bool notify);
-        bool check_collision(TileInstance& other, const std::vector<std::string>& my_hitboxes, const std::vector<std::string>& other_hitboxes, bool notify);
+        bool check_collision(const TileCollisionGrid::Cell& other, bool notify);
+
+        bool collect_collisions(Actor& other, std::vector<PendingCollision>& pending);
+        bool collect_collisions(const TileCollisionGrid::Cell& other, std::vector<PendingCollision>& pending);
+        bool check_collision(const TileCollisionGrid::Cell& other, const std::vector<std::string>& my_hitboxes, const std::vector<std::string>& other_hitboxes, bool notify);
+
+        const PixelMask* get_pixel_mask(Point& pos) const;
+        bool pixels_overlap(const Rect& contact, const Actor& other) const;
+        bool pixels_overlap(const Rect& contact, const TileCollisionGrid::Cell& other) const;
 
         // DEPRECATED! Use more granular overload instead
         bool on_ground(Direction dir = Direction::down, int tolerance = 0) const {return on_ground(Collidees::tile, DEFAULT_HITBOX, {DEFAULT_HITBOX},dir,tolerance);}
         bool on_ground(Collidees target, std::string my_hitbox, const std::vector<std::string>& other_hitboxes, Direction dir = Direction::down, int tolerance = 0) const;
 
         // Seperate hitboxes after collision
-        bool separate(TileInstance& tile, const std::vector<std::string>& my_hitboxes, const std::vector<std::string>& other_hitboxes, bool notify);
+        bool separate(const TileCollisionGrid::Cell& tile, const std::vector<std::string>& my_hitboxes, const std::vector<std::string>& other_hitboxes, bool notify);
         bool separate(Actor& actor, const std::vector<std::string>& my_hitboxes, const std::vector<std::string>& other_hitboxes, bool notify);
         bool separate(const Rect& first, const Rect& second);
 
         // Separate hitboxes after collision restricted to one direction given in x y values
-        bool separate_along_path(float x, float y,TileInstance& tile, const std::vector<std::string>& my_hitboxes, const std::vector<std::string>& other_hitboxes, bool notify);
+        bool separate_along_path(float x, float y,const TileCollisionGrid::Cell& tile, const std::vector<std::string>& my_hitboxes, const std::vector<std::string>& other_hitboxes, bool notify);
         bool separate_along_path(float x, float y,Actor& actor, const std::vector<std::string>& my_hitboxes, const std::vector<std::string>& other_hitboxes, bool notify);
         bool separate_along_path(float x, float y,const Rect& first, const Rect& second);
 
@@ -93,48 +121,103 @@ class Actor{
         Transform& get_transform() {return m_transform;}
         const Transform& get_transform() const {return m_transform;}
 
-        void set_name(std::string name) {m_name = name;}
+        void set_name(const std::string& name);
 
         // Trivial Getters
-        std::string get_animation() const {return m_anim_state;}
-        Tile& get_animation_tile() {return m_animations.at(m_anim_state).at(m_direction);}
-        std::map<std::string, std::map<Direction, Tile>>& get_animation_container() {return m_animations;}
+        std::string get_animation() const;
+        int get_current_frame() const {return get_playback().frame;}
+        int get_frame_count() const;
+        void add_animation(unsigned state, Direction dir, const Tile& tile);
         Direction get_direction() const {return m_direction;}
-        std::string get_name() const {return m_name;}
-        std::string get_type() const {return m_type;}
+        const std::string& get_name() const {return m_name;}
+        const std::string& get_type() const {return m_type;}
         MapData& get_map() {return *m_map;}
 
         DataBlock& get_data() {return m_data;}
         bool late_polling() const {return m_late_polling;}
+        unsigned get_pool_size() const {return m_pool_size;}
 
-        void set_tile(Tile tile) {m_base_tile = tile;}
+        void set_tile(const Tile& tile);
 
-        bool valid_anim_state(std::string anim, Direction dir) const;
+        bool valid_anim_state(const std::string& anim, Direction dir) const;
+        bool valid_anim_state(int state, Direction dir) const;
         bool valid_anim_state() const {return valid_anim_state(m_anim_state, m_direction);}
 
-        bool is_valid() const {return m_base_tile.is_valid();}
+        bool is_valid() const {return m_tiles != nullptr && m_tiles->base_tile.is_valid();}
 
         unsigned get_id() const {return m_id;}
         void set_id(unsigned id) {m_id = id;}
 
+        ActorHandle get_handle() const {return m_handle;}
+        void set_handle(ActorHandle handle) {m_handle = handle;}
+
+        /// The object layer storing the actor, nullptr unless the actor is stored in a LayerCollection
+        ObjectLayer* get_object_layer() const {return m_object_layer;}
+        /// Index of the actor within the actors of its object layer
+        Uint32 get_layer_position() const {return m_layer_position;}
+        void set_layer_position(ObjectLayer* layer, Uint32 position) {m_object_layer = layer; m_layer_position = position;}
+
+        /// The pool of the template the actor got acquired from, nullptr if that template has no pool
+        ActorPool* get_pool() const {return m_pool;}
+        void set_pool(ActorPool* pool) {m_pool = pool;}
+
         bool get_hidden() const {return m_hidden;}
         void set_hidden(bool mode) {m_hidden = mode;}
 
+        // Collision filtering, two actors collide if each mask contains the category of the other
+        Uint32 get_collision_category() const {return m_collision_category;}
+        Uint32 get_collision_mask() const {return m_collision_mask;}
+        void set_collision_category(Uint32 category) {m_collision_category = category;}
+        void set_collision_mask(Uint32 mask) {m_collision_mask = mask;}
+        bool can_collide(Uint32 category, Uint32 mask) const {return (m_collision_mask & category) && (mask & m_collision_category);}
+
+        // Simulation level of detail, see ActivityRegions
+        bool is_sleeping() const {return m_sleeping;}
+        /// Sleeping and not due for one of its reduced rate frames, so collisions and animations are skipped
+        bool is_paused() const {return m_sleeping && !m_sleep_tick;}
+        void set_sleeping(bool sleeping, bool tick) {m_sleeping = sleeping; m_sleep_tick = tick;}
+        void wake(float seconds = 0.0f);
+        bool check_wake();
+
         void set_layer(std::string layer) {m_layer_name = layer;}
-        std::string get_layer() const {return m_layer_name;}
+        const std::string& get_layer() const {return m_layer_name;}
 
         bool get_resize_hitbox() const {return m_resize_hitbox;}
         void set_resize_hitbox(bool mode) {m_resize_hitbox = mode;}
 
-        Rect get_hitbox(std::string type = DEFAULT_HITBOX) const;
-        const std::map<std::string, Rect> get_hitboxes() const;
+        Rect get_hitbox(const std::string& type = DEFAULT_HITBOX) const;
+        Rect get_hitbox(HitboxId id) const {return get_hitboxes().get(id);}
+        const HitboxSet& get_hitboxes() const;
+        unsigned get_hitbox_generation() const;
 
-        void add_collision(Collision c) {if(m_register_collisions) {m_collisions.push_back(c);}}
-        std::vector<Collision>& get_collisions() {return m_collisions;}
-        void clear_collisions() {m_collisions.clear();}
+        void add_collision(const CollisionRecord& c);
+        std::vector<Collision>& get_collisions();
+        void clear_collisions() {m_collision_view.clear();}
         void register_collisions(bool r) {if(!r) {clear_collisions();} m_register_collisions = r;}
 
     private:
+        const Tile* get_anim_tile(int state, Direction dir) const;
+        const Tile* switch_animation(AnimationHandle anim);
+        ActorTiles& edit_tiles();
+        void set_type(const std::string& type);
+
+        /// Playback state of the currently active animation tile
+        AnimState& get_playback() {return (m_anim_state == 0) ? m_base_anim : m_anim;}
+        const AnimState& get_playback() const {return (m_anim_state == 0) ? m_base_anim : m_anim;}
+
+        /// State which the cached world space hitboxes depend on
+        struct HitboxCacheKey {
+            unsigned revision = 0;
+            int state = -1;
+            Direction dir = Direction::invalid;
+            int frame = -1;
+            int base_frame = -1;
+            bool operator==(const HitboxCacheKey& other) const {
+                return revision == other.revision && state == other.state && dir == other.dir &&
+                       frame == other.frame && base_frame == other.base_frame;
+            }
+        };
+
         MapData* m_map;
 
         Transform m_transform;
@@ -143,20 +226,41 @@ class Actor{
         std::string m_type;
         std::string m_layer_name;
 
-        std::string m_anim_state = AnimationType::none; ///< Currently active animation
+        int m_anim_state = 0; ///< Interned id of currently active animation, 0 is AnimationType::none
         Direction m_direction = Direction::none; ///< Current direction facing
-        std::map<std::string, std::map<Direction, Tile>> m_animations; ///< 2D Map which stores all animation tiles
-        Tile m_base_tile;
+        std::shared_ptr<ActorTiles> m_tiles; ///< Shared with the template until modified
+        AnimState m_anim; ///< Playback state of the active animation tile
+        AnimState m_base_anim; ///< Playback state of the base tile
+
+        DataBlock m_data; ///< This holds custom user values by string, shared with the template until modified
 
-        DataBlock m_data; ///< This holds custom user values by string
+        mutable HitboxSet m_world_hitboxes; ///< Cached hitboxes in world coordinates
+        mutable HitboxCacheKey m_hitbox_key; ///< State at which m_world_hitboxes got computed
+        mutable unsigned m_hitbox_generation = 0; ///< Increases whenever m_world_hitboxes or m_hitbox_mask changes
+        mutable const PixelMask* m_hitbox_mask = nullptr; ///< Pixel mask at the time m_world_hitboxes got computed
 
-        std::vector<Collision> m_collisions;
+        CollisionView m_collision_view; ///< Collisions of this frame within the maps CollisionStream
+        std::vector<Collision> m_collisions; ///< Expanded collisions of the last get_collisions() call
         bool m_register_collisions = true;
 
         unsigned m_id = 0;
+        ActorHandle m_handle; ///< Invalid unless the actor is stored in a LayerCollection
+        ObjectLayer* m_object_layer = nullptr;
+        Uint32 m_layer_position = 0;
+        ActorPool* m_pool = nullptr;
 
         bool m_late_polling = false;
 
+        unsigned m_pool_size = 0; ///< Count of preconstructed copies kept by the map if this is a template
+
+        Uint32 m_collision_category = 1; ///< Category bits, set by COLLISION_CATEGORY
+        Uint32 m_collision_mask = 0xFFFFFFFF; ///< Categories to collide with, set by COLLISION_MASK
+
+        bool m_sleeping = false;
+        bool m_sleep_tick = false; ///< Sleeping but gets a regular frame this time
+        bool m_wake_pending = false; ///< Stay awake during the next update, set by wake()
+        Uint32 m_wake_until = 0; ///< Stay awake until this timestamp, set by wake()
+
         // If true the hitbox grows and shrinks with varying size
         bool m_resize_hitbox = true;
 
@@ -20,6 +20,7 @@
 
 #include "actor/actor.hpp"
 #include "map/tile.hpp"
+#include "map/trigger_regions.hpp"
 
 namespace salmon { namespace internal {
 
@@ -30,31 +31,45 @@ Collision::Collision() :
 
 }
 
-// Constructor for tile
-Collision::Collision(TileInstance tile, std::string my_hitbox, std::string other_hitbox) :
- type{CollisionType::tile}, transform{tile.get_transform()}
+// Constructor expanding a compact record
+Collision::Collision(const CollisionRecord& record) :
+ type{CollisionType::none}, my_hitbox_id{record.my_hitbox}, other_hitbox_id{record.other_hitbox},
+ actor_id{record.actor_id}, contact{record.contact}
 {
-    data.tile = tile.get_tile();
-    my_hitbox_name = my_hitbox;
-    other_hitbox_name = other_hitbox;
-
-}
-
-// Constructor for actor
-Collision::Collision(Actor* actor, std::string my_hitbox, std::string other_hitbox) :
- type{CollisionType::actor}, transform{actor->get_transform()}
-{
-    data.actor = actor;
-    my_hitbox_name = my_hitbox;
-    other_hitbox_name = other_hitbox;
-    actor_id = actor->get_id();
-}
-
-// Constructor for mouse
-Collision::Collision(std::string my_hitbox) :
- type{CollisionType::mouse}
-{
-    my_hitbox_name = my_hitbox;
+    switch(record.kind) {
+        case CollisionRecord::tile : {
+            type = CollisionType::tile;
+            TileInstance tile = record.get_tile_instance();
+            data.tile = tile.get_tile();
+            transform = tile.get_transform();
+            break;
+        }
+        case CollisionRecord::actor : {
+            type = CollisionType::actor;
+            data.actor = record.other.actor;
+            if(data.actor != nullptr) {
+                transform = data.actor->get_transform();
+            }
+            break;
+        }
+        case CollisionRecord::mouse : {
+            type = CollisionType::mouse;
+            break;
+        }
+        case CollisionRecord::trigger : {
+            type = CollisionType::trigger;
+            trigger_event = record.trigger_event;
+            if(record.other.trigger != nullptr) {
+                const Rect& bounds = record.other.trigger->bounds;
+                trigger_name = record.other.trigger->name;
+                transform = Transform(bounds.x, bounds.y, bounds.w, bounds.h, 0, 0);
+            }
+            break;
+        }
+        default : {
+            break;
+        }
+    }
 }
 
 unsigned Collision::get_actor_id() const {return actor_id;}
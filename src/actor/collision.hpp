@@ -23,6 +23,8 @@
 
 #include "transform.hpp"
 #include "util/game_types.hpp"
+#include "util/hitbox_set.hpp"
+#include "actor/collision_stream.hpp"
 
 namespace salmon { namespace internal {
 
@@ -32,6 +34,7 @@ class Tile;
 /**
  * @brief Store information of an actor collision
  *
+ * Expanded form of a CollisionRecord, only constructed when collisions are queried
  */
 
 class Collision{
@@ -41,30 +44,35 @@ class Collision{
             tile,
             actor,
             mouse,
+            trigger,
         };
 
     public:
         Collision();
-        Collision(std::string my_hitbox);
-        Collision(TileInstance tile, std::string my_hitbox, std::string other_hitbox);
-        Collision(Actor* actor, std::string my_hitbox, std::string other_hitbox);
+        Collision(const CollisionRecord& record);
 
         // Checks against tile types
         bool tile() const {return type == CollisionType::tile;}
         bool actor() const {return type == CollisionType::actor;}
         bool mouse() const {return type == CollisionType::mouse;}
+        bool trigger() const {return type == CollisionType::trigger;}
         bool none() const {return type == CollisionType::none;}
 
-        std::string my_hitbox() const {return my_hitbox_name;}
-        std::string other_hitbox() const {return other_hitbox_name;}
+        std::string my_hitbox() const {return HitboxSet::get_name(my_hitbox_id);}
+        std::string other_hitbox() const {return HitboxSet::get_name(other_hitbox_id);}
+        HitboxId get_my_hitbox_id() const {return my_hitbox_id;}
+        HitboxId get_other_hitbox_id() const {return other_hitbox_id;}
 
         // Return cause objects
         Actor* get_actor() const {return type == CollisionType::actor ? data.actor : nullptr;}
         unsigned get_actor_id() const;
         Tile* get_tile() const {return type == CollisionType::tile ? data.tile : nullptr;}
         TileInstance get_tile_instance() const;
+        const std::string& get_trigger_name() const {return trigger_name;}
+        TriggerEvent get_trigger_event() const {return trigger_event;}
 
         const Transform& get_transform() const {return transform;}
+        const Rect& get_contact() const {return contact;}
 
     private:
         CollisionType type;
@@ -76,11 +84,16 @@ class Collision{
 
         Transform transform;
 
-        std::string my_hitbox_name = "";
-        std::string other_hitbox_name = "";
+        HitboxId my_hitbox_id = HitboxSet::default_id;
+        HitboxId other_hitbox_id = HitboxSet::default_id;
 
         unsigned actor_id = 0;
 
+        Rect contact;
+
+        std::string trigger_name;
+        TriggerEvent trigger_event = TriggerEvent::enter;
+
 };
 }} // namespace salmon::internal
 
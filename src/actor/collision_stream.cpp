@@ -0,0 +1,112 @@
+/*
+ * Copyright 2017-2020 Agouti Games Team (see the AUTHORS file)
+ *
+ * This file is part of the RawSalmonEngine.
+ *
+ * The RawSalmonEngine is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * The RawSalmonEngine is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with the RawSalmonEngine.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#include "actor/collision_stream.hpp"
+
+#include <cmath>
+
+#include "actor/actor.hpp"
+#include "map/tile.hpp"
+
+namespace salmon { namespace internal {
+
+/// Record a collision with a tile
+CollisionRecord CollisionRecord::make_tile(const TileInstance& tile, HitboxId my_hitbox, HitboxId other_hitbox, const Rect& contact) {
+    CollisionRecord record;
+    record.kind = CollisionRecord::tile;
+    record.my_hitbox = my_hitbox;
+    record.other_hitbox = other_hitbox;
+    record.other.tile = tile.get_tile();
+    record.contact = contact;
+
+    // Tile transforms are unscaled with their origin in the upper left corner,
+    // so position, size, flip and quarter turns describe them completely
+    const Transform& trans = tile.get_transform();
+    Point pos = trans.get_relative(0,0);
+    Dimensions dim = trans.get_base_dimensions();
+    record.tile_rect = {pos.x, pos.y, dim.w, dim.h};
+    int turns = static_cast<int>(std::round(trans.get_rotation() / 90.0)) & 3;
+    record.tile_flags = (trans.get_h_flip() ? 1 : 0) | (trans.get_v_flip() ? 2 : 0) | (turns << 2);
+    return record;
+}
+
+/// Record a collision with an actor
+CollisionRecord CollisionRecord::make_actor(Actor* actor, HitboxId my_hitbox, HitboxId other_hitbox, const Rect& contact) {
+    CollisionRecord record;
+    record.kind = CollisionRecord::actor;
+    record.my_hitbox = my_hitbox;
+    record.other_hitbox = other_hitbox;
+    record.other.actor = actor;
+    record.actor_id = actor->get_id();
+    record.actor_handle = actor->get_handle();
+    record.contact = contact;
+    return record;
+}
+
+/// Record a collision with the mouse cursor
+CollisionRecord CollisionRecord::make_mouse(HitboxId my_hitbox, const Rect& contact) {
+    CollisionRecord record;
+    record.kind = CollisionRecord::mouse;
+    record.my_hitbox = my_hitbox;
+    record.other.actor = nullptr;
+    record.contact = contact;
+    return record;
+}
+
+/// Record an enter, stay or exit event of a trigger region
+CollisionRecord CollisionRecord::make_trigger(const TriggerRegion* region, TriggerEvent event, HitboxId my_hitbox, const Rect& contact) {
+    CollisionRecord record;
+    record.kind = CollisionRecord::trigger;
+    record.trigger_event = event;
+    record.my_hitbox = my_hitbox;
+    record.other.trigger = region;
+    record.contact = contact;
+    return record;
+}
+
+/// Reconstruct the tile instance which was collided with
+TileInstance CollisionRecord::get_tile_instance() const {
+    if(kind != CollisionRecord::tile) {return {nullptr, Transform()};}
+    Transform trans = {tile_rect.x, tile_rect.y, tile_rect.w, tile_rect.h, 0, 0};
+    trans.set_rotation_center(0.5,0.5);
+    trans.set_h_flip(tile_flags & 1);
+    trans.set_v_flip(tile_flags & 2);
+    trans.set_rotation(90.0 * (tile_flags >> 2));
+    return {other.tile, trans};
+}
+
+/// Append a record and return its index
+int CollisionStream::push(const CollisionRecord& record) {
+    m_records.push_back(record);
+    return static_cast<int>(m_records.size()) - 1;
+}
+
+/// Append a record to the stream and link it to the records of this view
+void CollisionView::add(CollisionStream& stream, const CollisionRecord& record) {
+    if(m_frame != stream.get_frame()) {
+        m_frame = stream.get_frame();
+        clear();
+    }
+    int index = stream.push(record);
+    stream[index].next = -1;
+    if(m_tail < 0) {m_head = index;}
+    else {stream[m_tail].next = index;}
+    m_tail = index;
+}
+
+}} // namespace salmon::internal
@@ -0,0 +1,131 @@
+/*
+ * Copyright 2017-2020 Agouti Games Team (see the AUTHORS file)
+ *
+ * This file is part of the RawSalmonEngine.
+ *
+ * The RawSalmonEngine is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * The RawSalmonEngine is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with the RawSalmonEngine.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#ifndef COLLISION_STREAM_HPP_INCLUDED
+#define COLLISION_STREAM_HPP_INCLUDED
+
+#include <vector>
+#include <SDL.h>
+
+#include "util/game_types.hpp"
+#include "util/hitbox_set.hpp"
+#include "util/slot_map.hpp"
+
+namespace salmon { namespace internal {
+
+class Actor;
+class Tile;
+class TileInstance;
+struct TriggerRegion;
+
+/**
+ * @brief Compact record of a single collision
+ *
+ * Trivially copyable so a whole frame of collisions lives in one buffer of a CollisionStream
+ */
+struct CollisionRecord {
+    enum Kind : Uint8 {
+        none,
+        tile,
+        actor,
+        mouse,
+        trigger,
+    };
+
+    static CollisionRecord make_tile(const TileInstance& tile, HitboxId my_hitbox, HitboxId other_hitbox, const Rect& contact);
+    static CollisionRecord make_actor(Actor* actor, HitboxId my_hitbox, HitboxId other_hitbox, const Rect& contact);
+    static CollisionRecord make_mouse(HitboxId my_hitbox, const Rect& contact);
+    static CollisionRecord make_trigger(const TriggerRegion* region, TriggerEvent event, HitboxId my_hitbox, const Rect& contact);
+
+    TileInstance get_tile_instance() const;
+
+    Kind kind = none;
+    Uint8 tile_flags = 0; ///< Bit 0 horizontal flip, bit 1 vertical flip, bit 2-3 quarter turns of the tile
+    TriggerEvent trigger_event = TriggerEvent::enter;
+    HitboxId my_hitbox = HitboxSet::default_id;
+    HitboxId other_hitbox = HitboxSet::default_id;
+    unsigned actor_id = 0;
+    SlotHandle actor_handle; ///< Detects actors which got removed after the collision
+
+    union {
+        Actor* actor;
+        Tile* tile;
+        const TriggerRegion* trigger;
+    } other;
+
+    Rect tile_rect; ///< Unrotated position and size of the tile collided with
+    Rect contact; ///< Intersection of both hitboxes in world coordinates
+    int next = -1; ///< Index of the next record of the same actor, negative if last
+};
+
+/// A collision which still has to be added to its actor, see Actor::collect_collisions()
+struct PendingCollision {
+    Actor* actor;
+    CollisionRecord record;
+};
+
+/**
+ * @brief Buffer which holds all collisions of the current frame
+ *
+ * Gets cleared at the start of each map update. Clearing doesn't touch the records,
+ * instead the frame counter invalidates all CollisionView objects pointing into it.
+ */
+class CollisionStream {
+    public:
+        void clear() {m_records.clear(); m_frame++;}
+        unsigned get_frame() const {return m_frame;}
+
+        int push(const CollisionRecord& record);
+
+        CollisionRecord& operator[](int index) {return m_records[index];}
+        const CollisionRecord& operator[](int index) const {return m_records[index];}
+        unsigned size() const {return m_records.size();}
+
+    private:
+        std::vector<CollisionRecord> m_records;
+        unsigned m_frame = 0;
+};
+
+/**
+ * @brief The collisions of a single actor inside a CollisionStream
+ *
+ * Records of one actor form a linked list via CollisionRecord::next.
+ * Iterate by: for(int i = view.head(stream); i >= 0; i = stream[i].next)
+ *
+ * A copied view starts out empty, so copied actors don't share collisions.
+ */
+class CollisionView {
+    public:
+        CollisionView() = default;
+        CollisionView(const CollisionView&) {}
+        CollisionView& operator=(const CollisionView&) {clear(); return *this;}
+        CollisionView(CollisionView&& other) noexcept = default;
+        CollisionView& operator=(CollisionView&& other) noexcept = default;
+
+        void add(CollisionStream& stream, const CollisionRecord& record);
+        int head(const CollisionStream& stream) const {return (m_frame == stream.get_frame()) ? m_head : -1;}
+        void clear() {m_head = -1; m_tail = -1;}
+
+    private:
+        int m_head = -1;
+        int m_tail = -1;
+        unsigned m_frame = 0;
+};
+}} // namespace salmon::internal
+
+#endif // COLLISION_STREAM_HPP_INCLUDED
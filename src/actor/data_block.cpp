@@ -18,66 +18,190 @@
  */
 #include "actor/data_block.hpp"
 
-#include <iostream>
+#include <cstring>
+
+#include "util/symbol_table.hpp"
 
 namespace salmon { namespace internal {
 
-void DataBlock::set_val(std::string name, bool val) {m_data_bool[name] = val;}
-void DataBlock::set_val(std::string name, int val) {m_data_int[name] = val;}
-void DataBlock::set_val(std::string name, float val) {m_data_float[name] = val;}
-void DataBlock::set_val(std::string name, std::string val) {m_data_string[name] = val;}
-//void DataBlock::set_val(std::string name, Actor& val) {m_data_actor[name] = val;}
-
-bool DataBlock::check_val_bool(std::string name) const {return !(m_data_bool.find(name) == m_data_bool.end());}
-bool DataBlock::check_val_int(std::string name) const {return !(m_data_int.find(name) == m_data_int.end());}
-bool DataBlock::check_val_float(std::string name) const {return !(m_data_float.find(name) == m_data_float.end());}
-bool DataBlock::check_val_string(std::string name) const {return !(m_data_string.find(name) == m_data_string.end());}
-
-bool DataBlock::get_val_bool(std::string name) const {
-    if(!check_val_bool(name)) {
-        // std::cerr << "Could not find boolean " << name << "\n";
-        return false;
-    }
-    else{
-        return m_data_bool.at(name);
-    }
+namespace {
+/// Global table of property names
+SymbolTable& data_names() {
+    static SymbolTable names;
+    return names;
 }
 
-int DataBlock::get_val_int(std::string name) const {
-    if(!check_val_int(name)) {
-        // std::cerr << "Could not find integer " << name << "\n";
-        return 0;
-    }
-    else{
-        return m_data_int.at(name);
-    }
+template <class T>
+Uint32 to_bits(T val) {
+    static_assert(sizeof(T) <= sizeof(Uint32), "Value doesn't fit into a table slot");
+    Uint32 bits = 0;
+    std::memcpy(&bits, &val, sizeof(T));
+    return bits;
+}
+
+template <class T>
+T from_bits(Uint32 bits) {
+    T val;
+    std::memcpy(&val, &bits, sizeof(T));
+    return val;
+}
+} // anonymous namespace
+
+/// Returns the key of a property name, interning it if it is new
+DataKey DataBlock::get_key(const std::string& name) {
+    DataKey key;
+    key.id = data_names().intern(name);
+    return key;
+}
+
+/// Resolve a property name without interning it, returns false if no block ever used it
+bool DataBlock::find_key(const std::string& name, DataKey& key) {
+    int id = data_names().find(name);
+    if(id < 0) {return false;}
+    key.id = static_cast<unsigned>(id);
+    return true;
 }
 
-float DataBlock::get_val_float(std::string name) const {
-    if(!check_val_float(name)) {
-        // std::cerr << "Could not find float " << name << "\n";
-        return 0.0f;
+unsigned DataBlock::hash(Uint32 key, Type type) {
+    Uint32 h = key * 5 + static_cast<Uint32>(type);
+    h ^= h >> 16;
+    h *= 0x45d9f3b;
+    h ^= h >> 16;
+    return h;
+}
+
+/**
+ * @brief Returns the slot index of the value or -1 if there is none
+ *
+ * The slot of the last lookup is tried first, it is the right one for
+ * all blocks which got copied from the same template.
+ */
+int DataBlock::find(const DataKey& key, Type type) const {
+    if(m_entries == nullptr || m_entries->slots.empty()) {return -1;}
+    const std::vector<Slot>& slots = m_entries->slots;
+    if(key.slot < slots.size() && slots[key.slot].type == type && slots[key.slot].key == key.id) {
+        return key.slot;
     }
-    else{
-        return m_data_float.at(name);
+    unsigned mask = slots.size() - 1;
+    for(unsigned i = hash(key.id, type) & mask; slots[i].type != Type::none; i = (i + 1) & mask) {
+        if(slots[i].key == key.id && slots[i].type == type) {
+            key.slot = i;
+            return i;
+        }
     }
+    return -1;
 }
 
-std::string DataBlock::get_val_string(std::string name) const {
-    if(!check_val_string(name)) {
-        // std::cerr << "Could not find string " << name << "\n";
-        return "";
+/// Returns the slot of the value for writing, adding it if it doesn't exist yet
+DataBlock::Slot& DataBlock::insert(const DataKey& key, Type type) {
+    Entries& entries = edit();
+    int index = find(key, type);
+    if(index >= 0) {return entries.slots[index];}
+
+    if((entries.size + 1) * 2 > entries.slots.size()) {grow();}
+    unsigned mask = entries.slots.size() - 1;
+    unsigned i = hash(key.id, type) & mask;
+    while(entries.slots[i].type != Type::none) {i = (i + 1) & mask;}
+
+    Slot& slot = entries.slots[i];
+    slot.key = key.id;
+    slot.type = type;
+    entries.size++;
+    if(type == Type::string) {
+        slot.value = entries.strings.size();
+        entries.strings.emplace_back();
     }
-    else{
-        return m_data_string.at(name);
+    key.slot = i;
+    return slot;
+}
+
+/// Double the table size and reinsert all values
+void DataBlock::grow() {
+    Entries& entries = *m_entries;
+    std::vector<Slot> old;
+    old.swap(entries.slots);
+    entries.slots.resize(old.empty() ? 8 : old.size() * 2);
+    unsigned mask = entries.slots.size() - 1;
+    for(const Slot& slot : old) {
+        if(slot.type == Type::none) {continue;}
+        unsigned i = hash(slot.key, slot.type) & mask;
+        while(entries.slots[i].type != Type::none) {i = (i + 1) & mask;}
+        entries.slots[i] = slot;
     }
 }
 
+/// Returns the entries for writing and detaches them from all copies of this block
+DataBlock::Entries& DataBlock::edit() {
+    if(m_entries == nullptr) {m_entries = std::make_shared<Entries>();}
+    else if(m_entries.use_count() > 1) {m_entries = std::make_shared<Entries>(*m_entries);}
+    return *m_entries;
+}
+
+void DataBlock::set_val(const DataKey& key, bool val) {insert(key, Type::boolean).value = to_bits(val);}
+void DataBlock::set_val(const DataKey& key, int val) {insert(key, Type::integer).value = to_bits(val);}
+void DataBlock::set_val(const DataKey& key, float val) {insert(key, Type::floating).value = to_bits(val);}
+void DataBlock::set_val(const DataKey& key, std::string val) {
+    Slot& slot = insert(key, Type::string);
+    m_entries->strings[slot.value] = std::move(val);
+}
+
+bool DataBlock::get_val_bool(const DataKey& key) const {
+    int index = find(key, Type::boolean);
+    return (index < 0) ? false : from_bits<bool>(m_entries->slots[index].value);
+}
+
+int DataBlock::get_val_int(const DataKey& key) const {
+    int index = find(key, Type::integer);
+    return (index < 0) ? 0 : from_bits<int>(m_entries->slots[index].value);
+}
+
+float DataBlock::get_val_float(const DataKey& key) const {
+    int index = find(key, Type::floating);
+    return (index < 0) ? 0.0f : from_bits<float>(m_entries->slots[index].value);
+}
+
+std::string DataBlock::get_val_string(const DataKey& key) const {
+    int index = find(key, Type::string);
+    return (index < 0) ? "" : m_entries->strings[m_entries->slots[index].value];
+}
+
+bool DataBlock::check_val_bool(const std::string& name) const {
+    DataKey key;
+    return find_key(name, key) && check_val_bool(key);
+}
+bool DataBlock::check_val_int(const std::string& name) const {
+    DataKey key;
+    return find_key(name, key) && check_val_int(key);
+}
+bool DataBlock::check_val_float(const std::string& name) const {
+    DataKey key;
+    return find_key(name, key) && check_val_float(key);
+}
+bool DataBlock::check_val_string(const std::string& name) const {
+    DataKey key;
+    return find_key(name, key) && check_val_string(key);
+}
+
+bool DataBlock::get_val_bool(const std::string& name) const {
+    DataKey key;
+    return find_key(name, key) ? get_val_bool(key) : false;
+}
+int DataBlock::get_val_int(const std::string& name) const {
+    DataKey key;
+    return find_key(name, key) ? get_val_int(key) : 0;
+}
+float DataBlock::get_val_float(const std::string& name) const {
+    DataKey key;
+    return find_key(name, key) ? get_val_float(key) : 0.0f;
+}
+std::string DataBlock::get_val_string(const std::string& name) const {
+    DataKey key;
+    return find_key(name, key) ? get_val_string(key) : "";
+}
+
+/// Drops the entries of this block only, copies keep theirs
 void DataBlock::clear() {
-    m_data_bool.clear();
-    m_data_float.clear();
-    m_data_int.clear();
-    m_data_string.clear();
+    m_entries.reset();
 }
 
 }} // namespace salmon::internal
@@ -19,42 +19,94 @@
 #ifndef DATA_BLOCK_HPP_INCLUDED
 #define DATA_BLOCK_HPP_INCLUDED
 
+#include <memory>
 #include <string>
-#include <map>
+#include <vector>
+#include <SDL.h>
+
+#include "util/game_types.hpp"
 
 namespace salmon { namespace internal {
 
 /**
  * @brief A class for holding user values by string
+ *
+ * Names are interned into keys shared by all blocks. The values live in a flat
+ * open addressing table of tagged entries, so a lookup by pre-resolved key usually
+ * is a single indexed load. Each name may hold one value of each type.
+ *
+ * The values are shared between copies until one of them gets modified,
+ * so actors spawned from a template don't duplicate its default properties.
  */
 class DataBlock{
     public:
+        static DataKey get_key(const std::string& name);
+
         // Getters and setters for the custom data blocks
-        void set_val(std::string name, bool val);
-        void set_val(std::string name, int val);
-        void set_val(std::string name, float val);
-        void set_val(std::string name, std::string val);
-        //void set_val(std::string name, Actor& val);
-
-        bool check_val_bool(std::string name) const;
-        bool check_val_int(std::string name) const;
-        bool check_val_float(std::string name) const;
-        bool check_val_string(std::string name) const;
-        //Actor& check_val_actor(std::string name);
-
-        bool get_val_bool(std::string name) const;
-        int get_val_int(std::string name) const;
-        float get_val_float(std::string name) const;
-        std::string get_val_string(std::string name) const;
-        //Actor& get_val_actor(std::string name);
+        void set_val(const std::string& name, bool val) {set_val(get_key(name), val);}
+        void set_val(const std::string& name, int val) {set_val(get_key(name), val);}
+        void set_val(const std::string& name, float val) {set_val(get_key(name), val);}
+        void set_val(const std::string& name, std::string val) {set_val(get_key(name), std::move(val));}
+
+        bool check_val_bool(const std::string& name) const;
+        bool check_val_int(const std::string& name) const;
+        bool check_val_float(const std::string& name) const;
+        bool check_val_string(const std::string& name) const;
+
+        bool get_val_bool(const std::string& name) const;
+        int get_val_int(const std::string& name) const;
+        float get_val_float(const std::string& name) const;
+        std::string get_val_string(const std::string& name) const;
+
+        // Access by pre-resolved key
+        void set_val(const DataKey& key, bool val);
+        void set_val(const DataKey& key, int val);
+        void set_val(const DataKey& key, float val);
+        void set_val(const DataKey& key, std::string val);
+
+        bool check_val_bool(const DataKey& key) const {return find(key, Type::boolean) >= 0;}
+        bool check_val_int(const DataKey& key) const {return find(key, Type::integer) >= 0;}
+        bool check_val_float(const DataKey& key) const {return find(key, Type::floating) >= 0;}
+        bool check_val_string(const DataKey& key) const {return find(key, Type::string) >= 0;}
+
+        bool get_val_bool(const DataKey& key) const;
+        int get_val_int(const DataKey& key) const;
+        float get_val_float(const DataKey& key) const;
+        std::string get_val_string(const DataKey& key) const;
 
         void clear();
 
     private:
-        std::map<std::string, bool> m_data_bool;
-        std::map<std::string, int> m_data_int;
-        std::map<std::string, float> m_data_float;
-        std::map<std::string, std::string> m_data_string;
+        enum class Type : Uint8 {
+            none,
+            boolean,
+            integer,
+            floating,
+            string,
+        };
+
+        /// Table entry, the value holds the bits of the bool, int or float or the index of the string
+        struct Slot {
+            Uint32 key = 0;
+            Type type = Type::none;
+            Uint32 value = 0;
+        };
+
+        struct Entries {
+            std::vector<Slot> slots; ///< Size is zero or a power of two, at most half full
+            unsigned size = 0;
+            std::vector<std::string> strings;
+        };
+
+        static bool find_key(const std::string& name, DataKey& key);
+        static unsigned hash(Uint32 key, Type type);
+
+        int find(const DataKey& key, Type type) const;
+        Slot& insert(const DataKey& key, Type type);
+        void grow();
+        Entries& edit();
+
+        std::shared_ptr<Entries> m_entries; ///< Shared with copies until written to, nullptr if empty
 };
 }} // namespace salmon::internal
 
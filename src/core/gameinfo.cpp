@@ -173,6 +173,24 @@ bool GameInfo::set_linear_filtering(bool mode) {
     return true;
 }
 
+/// Returns the thread pool which all maps share, see set_thread_count()
+ThreadPool& GameInfo::get_thread_pool() {
+    if(m_thread_pool == nullptr) {m_thread_pool.reset(new ThreadPool(m_thread_count));}
+    return *m_thread_pool;
+}
+
+/**
+ * @brief Set the number of threads of the shared thread pool
+ * @param threads The thread count including the calling thread, 0 for one per hardware thread
+ *
+ * The pool gets recreated on its next use.
+ */
+void GameInfo::set_thread_count(unsigned threads) {
+    if(threads == m_thread_count) {return;}
+    m_thread_count = threads;
+    m_thread_pool.reset();
+}
+
 /**
  * @brief Loads the supplied mapfile
  * @param mapfile Name of the .tmx map
@@ -20,6 +20,7 @@
 #define GAMEINFO_HPP_INCLUDED
 
 #include <SDL.h>
+#include <memory>
 #include <string>
 #include <stack>
 
@@ -30,6 +31,7 @@
 #include "core/font_manager.hpp"
 #include "graphics/texture_cache.hpp"
 #include "util/preloader.hpp"
+#include "util/thread_pool.hpp"
 
 namespace salmon { namespace internal {
 
@@ -53,6 +55,9 @@ public:
 
     bool set_linear_filtering(bool mode);
 
+    ThreadPool& get_thread_pool();
+    void set_thread_count(unsigned threads);
+
     Window& get_window() {return m_window;}
 
     MapData& get_map();
@@ -105,6 +110,9 @@ private:
 
     std::string m_current_path = ""; ///< Path to the directory of the currently active mapfile
 
+    unsigned m_thread_count = 0; ///< 0 for one thread per hardware thread
+    std::unique_ptr<ThreadPool> m_thread_pool; ///< Shared by all maps, created on first use
+
     std::vector<MapData> m_maps; ///< Stores the currently active game map
 };
 }} // namespace salmon::internal
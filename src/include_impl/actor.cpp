@@ -19,26 +19,48 @@
 #include "actor.hpp"
 
 #include "actor/actor.hpp"
+#include "map/layer_collection.hpp"
+#include "map/mapdata.hpp"
 
 namespace salmon {
 
-Actor::Actor(internal::Actor& impl) : m_impl{&impl} {}
-Actor::Actor(internal::Actor* impl) : m_impl{impl} {}
+Actor::Actor(internal::Actor& impl) : Actor(&impl) {}
+Actor::Actor(internal::Actor* impl) : m_impl{impl} {
+    if(m_impl != nullptr && m_impl->get_handle().valid()) {
+        m_layers = &m_impl->get_map().get_layer_collection();
+        m_slot = m_impl->get_handle().index;
+        m_generation = m_impl->get_handle().generation;
+    }
+}
 
-bool Actor::good() const {return (m_impl == nullptr) ? false : true ;}
+bool Actor::good() const {
+    if(m_impl == nullptr) {return false;}
+    if(m_layers != nullptr) {
+        internal::ActorHandle handle;
+        handle.index = m_slot;
+        handle.generation = m_generation;
+        return m_layers->check_actor(handle);
+    }
+    return true;
+}
 
-bool Actor::animate(std::string anim, Direction dir, float speed) {return m_impl->animate(anim,dir,speed);}
-bool Actor::set_animation(std::string anim, Direction dir, int frame) {return m_impl->set_animation(anim,dir,frame);}
-AnimSignal Actor::animate_trigger(std::string anim, Direction dir, float speed) {return m_impl->animate_trigger(anim,dir,speed);}
+bool Actor::animate(const std::string& anim, Direction dir, float speed) {return m_impl->animate(anim,dir,speed);}
+bool Actor::set_animation(const std::string& anim, Direction dir, int frame) {return m_impl->set_animation(anim,dir,frame);}
+AnimSignal Actor::animate_trigger(const std::string& anim, Direction dir, float speed) {return m_impl->animate_trigger(anim,dir,speed);}
+AnimationHandle Actor::get_animation_handle(const std::string& anim, Direction dir) const {return m_impl->get_animation_handle(anim,dir);}
+bool Actor::animate(AnimationHandle anim, float speed) {return m_impl->animate(anim,speed);}
+bool Actor::set_animation(AnimationHandle anim, int frame) {return m_impl->set_animation(anim,frame);}
+AnimSignal Actor::animate_trigger(AnimationHandle anim, float speed) {return m_impl->animate_trigger(anim,speed);}
 std::string Actor::get_animation() const {return m_impl->get_animation();}
 Direction Actor::get_direction() const {return m_impl->get_direction();}
 std::string Actor::get_name() const {return m_impl->get_name();}
 std::string Actor::get_template_name() const {return m_impl->get_type();}
 unsigned Actor::get_id() const {return m_impl->get_id();}
-bool Actor::valid_anim_state(std::string anim, Direction dir) const {return m_impl->valid_anim_state(anim,dir);}
+bool Actor::valid_anim_state(const std::string& anim, Direction dir) const {return m_impl->valid_anim_state(anim,dir);}
 
 bool Actor::move_relative(float x, float y, Collidees target, const std::vector<std::string>& my_hitboxes, const std::vector<std::string>& other_hitboxes, bool notify) {return m_impl->move_relative(x,y,target,my_hitboxes,other_hitboxes,notify);}
 bool Actor::move_absolute(float x, float y, Collidees target, const std::vector<std::string>& my_hitboxes, const std::vector<std::string>& other_hitboxes, bool notify) {return m_impl->move_absolute(x,y,target,my_hitboxes,other_hitboxes,notify);}
+SweepResult Actor::move_swept(float x, float y, Collidees target, const std::vector<std::string>& my_hitboxes, const std::vector<std::string>& other_hitboxes, bool notify) {return m_impl->move_swept(x,y,target,my_hitboxes,other_hitboxes,notify);}
 void Actor::move_relative(float x, float y) {m_impl->move_relative(x,y);}
 void Actor::move_absolute(float x, float y) {m_impl->move_absolute(x,y);}
 
@@ -76,16 +98,26 @@ std::vector<Collision> Actor::get_collisions() {
 void Actor::clear_collisions() {m_impl->clear_collisions();}
 void Actor::register_collisions(bool r) {m_impl->register_collisions(r);}
 
+void Actor::set_collision_filter(unsigned category, unsigned mask) {
+    m_impl->set_collision_category(category);
+    m_impl->set_collision_mask(mask);
+}
+unsigned Actor::get_collision_category() const {return m_impl->get_collision_category();}
+unsigned Actor::get_collision_mask() const {return m_impl->get_collision_mask();}
+
+bool Actor::is_sleeping() const {return m_impl->is_sleeping();}
+void Actor::wake(float seconds) {m_impl->wake(seconds);}
+
 bool Actor::get_hidden() const {return m_impl->get_hidden();}
 void Actor::set_hidden(bool mode) {m_impl->set_hidden(mode);}
 
 std::string Actor::get_layer() const {return m_impl->get_layer();}
 
 int Actor::get_current_anim_frame() const {
-    return m_impl->get_animation_tile().get_current_frame();
+    return m_impl->get_current_frame();
 }
 int Actor::get_anim_frame_count() const {
-    return m_impl->get_animation_tile().get_frame_count();
+    return m_impl->get_frame_count();
 }
 
 Rect Actor::get_hitbox(std::string name) const {return m_impl->get_hitbox(name);}
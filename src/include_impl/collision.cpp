@@ -29,12 +29,16 @@ bool Collision::tile() const {return m_impl->tile();}
 bool Collision::actor() const {return m_impl->actor();}
 bool Collision::mouse() const {return m_impl->mouse();}
 bool Collision::none() const {return m_impl->none();}
+bool Collision::trigger() const {return m_impl->trigger();}
 
 std::string Collision::my_hitbox() const {return m_impl->my_hitbox();}
 std::string Collision::other_hitbox() const {return m_impl->other_hitbox();}
 unsigned Collision::get_actor_id() const {return m_impl->get_actor_id();}
 TileInstance Collision::get_tile() const {return m_impl->get_tile_instance();}
+std::string Collision::get_trigger_name() const {return m_impl->get_trigger_name();}
+TriggerEvent Collision::get_trigger_event() const {return m_impl->get_trigger_event();}
 
 const Transform& Collision::get_transform() const {return m_impl->get_transform();}
+Rect Collision::get_contact() const {return m_impl->get_contact();}
 
 } // namespace salmon
@@ -24,20 +24,37 @@ namespace salmon {
 
 DataBlock::DataBlock(internal::DataBlock& impl) : m_impl{&impl} {}
 
-void DataBlock::set_val(std::string name, bool val) {m_impl->set_val(name,val);}
-void DataBlock::set_val(std::string name, int val) {m_impl->set_val(name,val);}
-void DataBlock::set_val(std::string name, float val) {m_impl->set_val(name,val);}
-void DataBlock::set_val(std::string name, std::string val) {m_impl->set_val(name,val);}
-
-bool DataBlock::check_val_bool(std::string name) const {return m_impl->check_val_bool(name);}
-bool DataBlock::check_val_int(std::string name) const {return m_impl->check_val_int(name);}
-bool DataBlock::check_val_float(std::string name) const {return m_impl->check_val_float(name);}
-bool DataBlock::check_val_string(std::string name) const {return m_impl->check_val_string(name);}
-
-bool DataBlock::get_val_bool(std::string name) const {return m_impl->get_val_bool(name);}
-int DataBlock::get_val_int(std::string name) const {return m_impl->get_val_int(name);}
-float DataBlock::get_val_float(std::string name) const {return m_impl->get_val_float(name);}
-std::string DataBlock::get_val_string(std::string name) const {return m_impl->get_val_string(name);}
+void DataBlock::set_val(const std::string& name, bool val) {m_impl->set_val(name,val);}
+void DataBlock::set_val(const std::string& name, int val) {m_impl->set_val(name,val);}
+void DataBlock::set_val(const std::string& name, float val) {m_impl->set_val(name,val);}
+void DataBlock::set_val(const std::string& name, std::string val) {m_impl->set_val(name,val);}
+
+bool DataBlock::check_val_bool(const std::string& name) const {return m_impl->check_val_bool(name);}
+bool DataBlock::check_val_int(const std::string& name) const {return m_impl->check_val_int(name);}
+bool DataBlock::check_val_float(const std::string& name) const {return m_impl->check_val_float(name);}
+bool DataBlock::check_val_string(const std::string& name) const {return m_impl->check_val_string(name);}
+
+bool DataBlock::get_val_bool(const std::string& name) const {return m_impl->get_val_bool(name);}
+int DataBlock::get_val_int(const std::string& name) const {return m_impl->get_val_int(name);}
+float DataBlock::get_val_float(const std::string& name) const {return m_impl->get_val_float(name);}
+std::string DataBlock::get_val_string(const std::string& name) const {return m_impl->get_val_string(name);}
+
+DataKey DataBlock::get_key(const std::string& name) {return internal::DataBlock::get_key(name);}
+
+void DataBlock::set_val(const DataKey& key, bool val) {m_impl->set_val(key,val);}
+void DataBlock::set_val(const DataKey& key, int val) {m_impl->set_val(key,val);}
+void DataBlock::set_val(const DataKey& key, float val) {m_impl->set_val(key,val);}
+void DataBlock::set_val(const DataKey& key, std::string val) {m_impl->set_val(key,std::move(val));}
+
+bool DataBlock::check_val_bool(const DataKey& key) const {return m_impl->check_val_bool(key);}
+bool DataBlock::check_val_int(const DataKey& key) const {return m_impl->check_val_int(key);}
+bool DataBlock::check_val_float(const DataKey& key) const {return m_impl->check_val_float(key);}
+bool DataBlock::check_val_string(const DataKey& key) const {return m_impl->check_val_string(key);}
+
+bool DataBlock::get_val_bool(const DataKey& key) const {return m_impl->get_val_bool(key);}
+int DataBlock::get_val_int(const DataKey& key) const {return m_impl->get_val_int(key);}
+float DataBlock::get_val_float(const DataKey& key) const {return m_impl->get_val_float(key);}
+std::string DataBlock::get_val_string(const DataKey& key) const {return m_impl->get_val_string(key);}
 
 void DataBlock::clear() {m_impl->clear();}
 
@@ -36,6 +36,8 @@ Window& GameInfo::get_window() {return m_impl->get_window();}
 
 bool GameInfo::set_linear_filtering(bool mode) {return m_impl->set_linear_filtering(mode);}
 
+void GameInfo::set_thread_count(unsigned threads) {m_impl->set_thread_count(threads);}
+
 void GameInfo::add_preload_directory(std::string dir) {
     m_impl->get_preloader().add_directory(m_impl->get_resource_path() + dir);
 }
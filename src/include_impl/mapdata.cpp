@@ -25,7 +25,10 @@
 #include "actor/primitive_text.hpp"
 #include "map/mapdata.hpp"
 #include "map/layer_collection.hpp"
+#include "map/map_layer.hpp"
 #include "map/object_layer.hpp"
+#include "map/tile.hpp"
+#include "util/hitbox_set.hpp"
 
 namespace salmon {
 
@@ -43,46 +46,219 @@ std::vector<Actor> MapData::get_actors() {
     }
     return temp;
 }
+Actor MapData::get_actor(const std::string& actor_name) {
+    return Actor(m_impl->get_layer_collection().get_actor(actor_name));
+}
+std::vector<Actor> MapData::get_actors_of_template(const std::string& actor_template_name) {
+    std::vector<Actor> temp;
+    for(auto* a : m_impl->get_layer_collection().get_actors_of_type(actor_template_name)) {
+        temp.emplace_back(a);
+    }
+    return temp;
+}
 Camera& MapData::get_camera() {return m_impl->get_camera();}
 
-Actor MapData::add_actor(std::string actor_template_name, std::string layer_name, std::string actor_name) {
-    if(m_impl->is_actor(actor_template_name)) {
-        internal::Actor a = m_impl->get_actor(actor_template_name);
-        return add_actor(&a, layer_name, actor_name);
+void MapData::build_nav_grid(const std::string& blocking_hitbox, const std::string& blocking_tile_type) {
+    m_impl->build_nav_grid(blocking_hitbox, blocking_tile_type);
+}
+void MapData::set_nav_blocked(Point point, bool blocked) {
+    internal::NavGrid& grid = m_impl->get_nav_grid();
+    unsigned x, y;
+    if(grid.to_cell(point, x, y)) {grid.set_blocked(x, y, blocked);}
+}
+PathStatus MapData::find_path(Point from, Point to, std::vector<Point>& path) {
+    return m_impl->get_nav_grid().find_path(from, to, path);
+}
+unsigned MapData::request_path(Point from, Point to, unsigned node_budget) {
+    return m_impl->get_nav_grid().request_path(from, to, node_budget);
+}
+PathStatus MapData::get_path(unsigned request, std::vector<Point>& path) {
+    return m_impl->get_nav_grid().get_path(request, path);
+}
+
+unsigned MapData::add_flow_field(const std::vector<Point>& goals) {return m_impl->add_flow_field(goals);}
+bool MapData::set_flow_field_goals(unsigned field, const std::vector<Point>& goals) {
+    internal::FlowField* flow_field = m_impl->get_flow_field(field);
+    if(flow_field == nullptr) {return false;}
+    flow_field->init(m_impl->get_nav_grid(), goals, &m_impl->get_layer_collection().get_thread_pool());
+    return true;
+}
+bool MapData::remove_flow_field(unsigned field) {return m_impl->remove_flow_field(field);}
+Point MapData::get_flow_direction(unsigned field, Point position) {
+    internal::FlowField* flow_field = m_impl->get_flow_field(field);
+    return (flow_field == nullptr) ? Point{0.0f, 0.0f} : flow_field->get_direction(position);
+}
+float MapData::get_flow_distance(unsigned field, Point position) {
+    internal::FlowField* flow_field = m_impl->get_flow_field(field);
+    return (flow_field == nullptr) ? -1.0f : flow_field->get_distance(position);
+}
+
+void MapData::set_activity_region(float margin, unsigned tick_interval) {
+    internal::ActivityRegions& activity = m_impl->get_layer_collection().get_activity();
+    activity.set_margin(margin);
+    activity.set_tick_interval(tick_interval);
+}
+unsigned MapData::add_activity_anchor(Point point, float radius) {
+    return m_impl->get_layer_collection().get_activity().add_anchor(point, radius);
+}
+unsigned MapData::add_activity_anchor(Actor actor, float radius) {
+    return m_impl->get_layer_collection().get_activity().add_anchor(actor.m_impl->get_handle(), radius);
+}
+bool MapData::remove_activity_anchor(unsigned anchor) {return m_impl->get_layer_collection().get_activity().remove_anchor(anchor);}
+unsigned MapData::get_awake_actor_count() {return m_impl->get_layer_collection().get_activity().get_awake_count();}
+unsigned MapData::get_sleeping_actor_count() {return m_impl->get_layer_collection().get_activity().get_sleeping_count();}
+
+/// Converts hitbox names to ids, returns false if none of a nonempty list of names is known
+static bool find_hitbox_ids(const std::vector<std::string>& names, std::vector<internal::HitboxId>& ids) {
+    for(const std::string& name : names) {
+        int id = internal::HitboxSet::find_id(name);
+        if(id >= 0) {ids.push_back(static_cast<internal::HitboxId>(id));}
     }
-    else {
-        std::cerr << "There is no actor template called: \"" << actor_template_name << "\"\n";
-        return Actor(nullptr);
+    return names.empty() || !ids.empty();
+}
+
+/// Returns the actors of hits, each only once
+static std::vector<Actor> to_actors(const std::vector<internal::QueryHit>& hits) {
+    std::vector<Actor> actors;
+    internal::Actor* last = nullptr;
+    for(const internal::QueryHit& hit : hits) {
+        // The hits of an actor are next to each other
+        if(hit.actor == last) {continue;}
+        last = hit.actor;
+        actors.emplace_back(hit.actor);
     }
+    return actors;
 }
-Actor MapData::add_actor(Actor actor, std::string layer_name, std::string actor_name) {
-    internal::Layer* dest_layer = m_impl->get_layer_collection().get_layer(layer_name);
+
+RaycastHit MapData::raycast(Point from, Point to, Collidees target, const std::vector<std::string>& hitboxes,
+                            const std::string& tile_type, Actor ignore) {
+    RaycastHit result;
+    result.point = to;
+    std::vector<internal::HitboxId> ids;
+    if(!find_hitbox_ids(hitboxes, ids)) {return result;}
+    Point delta{to.x - from.x, to.y - from.y};
+    internal::QueryHit hit;
+    if(!m_impl->get_layer_collection().raycast(from, delta, target, ids, tile_type, hit, ignore.m_impl)) {return result;}
+    result.hit = true;
+    result.fraction = hit.fraction;
+    result.point = {from.x + delta.x * hit.fraction, from.y + delta.y * hit.fraction};
+    result.normal = hit.normal;
+    result.hitbox = internal::HitboxSet::get_name(hit.hitbox);
+    if(hit.actor != nullptr) {result.actor = Actor(hit.actor);}
+    else {result.tile_type = hit.tile.tile->get_type();}
+    return result;
+}
+std::vector<Actor> MapData::get_actors_at(Point point, const std::vector<std::string>& hitboxes) {
+    std::vector<internal::HitboxId> ids;
+    std::vector<internal::QueryHit> hits;
+    if(find_hitbox_ids(hitboxes, ids)) {m_impl->get_layer_collection().query(point, Collidees::actor, ids, "", hits);}
+    return to_actors(hits);
+}
+std::vector<Actor> MapData::get_actors_in(Rect area, const std::vector<std::string>& hitboxes) {
+    std::vector<internal::HitboxId> ids;
+    std::vector<internal::QueryHit> hits;
+    if(find_hitbox_ids(hitboxes, ids)) {m_impl->get_layer_collection().query(area, Collidees::actor, ids, "", hits);}
+    return to_actors(hits);
+}
+bool MapData::check_point(Point point, Collidees target, const std::vector<std::string>& hitboxes, const std::string& tile_type) {
+    std::vector<internal::HitboxId> ids;
+    std::vector<internal::QueryHit> hits;
+    if(!find_hitbox_ids(hitboxes, ids)) {return false;}
+    return m_impl->get_layer_collection().query(point, target, ids, tile_type, hits, true);
+}
+
+int MapData::get_tile_type_id(const std::string& type) {return m_impl->get_ts_collection().find_tile_type(type);}
+unsigned MapData::get_tile_flag(const std::string& property) {return m_impl->get_ts_collection().find_tile_flag(property);}
+int MapData::get_tile_type_at(Point point) {
+    const std::vector<internal::MapLayer*>& layers = m_impl->get_layer_collection().get_map_layers();
+    for(auto it = layers.rbegin(); it != layers.rend(); ++it) {
+        internal::TileTypeId type = (*it)->get_tile_type_at(point);
+        if(type != 0) {return type;}
+    }
+    return 0;
+}
+unsigned MapData::get_tile_flags_at(Point point) {
+    internal::TileFlags flags = 0;
+    for(internal::MapLayer* layer : m_impl->get_layer_collection().get_map_layers()) {flags |= layer->get_tile_flags_at(point);}
+    return flags;
+}
+unsigned MapData::get_tile_flags_in(Rect area) {
+    internal::TileFlags flags = 0;
+    for(internal::MapLayer* layer : m_impl->get_layer_collection().get_map_layers()) {flags |= layer->get_tile_flags_in(area);}
+    return flags;
+}
+bool MapData::check_tile_type_in(Rect area, int type) {
+    if(type < 0 || type > 0xFFFF) {return false;}
+    for(internal::MapLayer* layer : m_impl->get_layer_collection().get_map_layers()) {
+        if(layer->has_tile_type_in(area, static_cast<internal::TileTypeId>(type))) {return true;}
+    }
+    return false;
+}
+
+/// Returns the object layer with the given name or nullptr if there is none
+static internal::ObjectLayer* find_object_layer(internal::MapData& map, const std::string& layer_name) {
+    internal::Layer* dest_layer = map.get_layer_collection().get_layer(layer_name);
     if(dest_layer == nullptr) {
         std::cerr << "There is no layer called: \"" << layer_name << "\"\n";
-        return Actor(nullptr);
+        return nullptr;
     }
     else if(dest_layer->get_type() != internal::Layer::object) {
         std::cerr << "The layer: \"" << layer_name << "\" is no object layer!\n";
-        return Actor(nullptr);
+        return nullptr;
     }
-    else {
-        internal::ObjectLayer* layer = static_cast<internal::ObjectLayer*>(dest_layer);
-        internal::Actor* added = layer->add_actor(*actor.m_impl);
+    return static_cast<internal::ObjectLayer*>(dest_layer);
+}
+
+Actor MapData::add_actor(std::string actor_template_name, std::string layer_name, std::string actor_name) {
+    if(m_impl->is_actor(actor_template_name)) {
+        internal::ObjectLayer* layer = find_object_layer(*m_impl, layer_name);
+        if(layer == nullptr) {return Actor(nullptr);}
+        internal::Actor* added = layer->add_actor(m_impl->acquire_actor(actor_template_name));
         added->set_name(actor_name);
         return Actor(added);
     }
+    else {
+        std::cerr << "There is no actor template called: \"" << actor_template_name << "\"\n";
+        return Actor(nullptr);
+    }
+}
+Actor MapData::add_actor(Actor actor, std::string layer_name, std::string actor_name) {
+    internal::ObjectLayer* layer = find_object_layer(*m_impl, layer_name);
+    if(layer == nullptr) {return Actor(nullptr);}
+    internal::Actor* added = layer->add_actor(*actor.m_impl);
+    added->set_name(actor_name);
+    return Actor(added);
 }
 
-bool MapData::remove_actor(Actor actor) {
-    std::vector<internal::ObjectLayer*> obj_layers = m_impl->get_layer_collection().get_object_layers();
-    for(internal::ObjectLayer* o : obj_layers) {
-        if(o->erase_actor(actor.m_impl)) {return true;}
+bool MapData::queue_add_actor(std::string actor_template_name, std::string layer_name, std::string actor_name) {
+    return m_impl->get_actor_commands().spawn(*m_impl, actor_template_name, layer_name, actor_name);
+}
+void MapData::queue_remove_actor(Actor actor) {
+    if(!actor.good()) {return;}
+    m_impl->get_actor_commands().despawn(actor.m_impl->get_handle());
+}
+ActorPoolStats MapData::get_actor_pool_stats(std::string actor_template_name) const {
+    return m_impl->get_actor_pool_stats(actor_template_name);
+}
+std::vector<Actor> MapData::get_spawned_actors() {
+    std::vector<Actor> spawned;
+    internal::LayerCollection& layer_collection = m_impl->get_layer_collection();
+    for(internal::ActorHandle handle : m_impl->get_actor_commands().get_spawned()) {
+        internal::Actor* actor = layer_collection.get_actor(handle);
+        // Might have been removed in the meantime
+        if(actor != nullptr) {spawned.emplace_back(actor);}
     }
-    return false;
+    return spawned;
+}
+
+bool MapData::remove_actor(Actor actor) {
+    // Removed actors may not be dereferenced anymore
+    if(!actor.good()) {return false;}
+    return m_impl->get_layer_collection().erase_actor(actor.m_impl);
 }
 
 Text MapData::get_text(std::string name) {
-    std::vector<internal::ObjectLayer*> obj_layers = m_impl->get_layer_collection().get_object_layers();
+    const std::vector<internal::ObjectLayer*>& obj_layers = m_impl->get_layer_collection().get_object_layers();
     internal::Primitive* text = nullptr;
     for(internal::ObjectLayer* l : obj_layers) {
         text = l->get_primitive(name);
@@ -110,14 +286,14 @@ Text MapData::add_text(std::string text_name, std::string layer_name, Rect r, st
     }
 }
 bool MapData::remove_text(Text text) {
-    std::vector<internal::ObjectLayer*> obj_layers = m_impl->get_layer_collection().get_object_layers();
+    const std::vector<internal::ObjectLayer*>& obj_layers = m_impl->get_layer_collection().get_object_layers();
     for(internal::ObjectLayer* l : obj_layers) {
         if(l->erase_primitive(text.m_impl)) {return true;}
     }
     return false;
 }
 
-bool MapData::hide_layer(std::string layer_name) {
+bool MapData::hide_layer(const std::string& layer_name) {
     internal::Layer* temp = m_impl->get_layer_collection().get_layer(layer_name);
     if(temp == nullptr) {
         std::cerr << "There is no layer called: \"" << layer_name << "\"\n";
@@ -128,7 +304,7 @@ bool MapData::hide_layer(std::string layer_name) {
         return true;
     }
 }
-bool MapData::unhide_layer(std::string layer_name) {
+bool MapData::unhide_layer(const std::string& layer_name) {
     internal::Layer* temp = m_impl->get_layer_collection().get_layer(layer_name);
     if(temp == nullptr) {
         std::cerr << "There is no layer called: \"" << layer_name << "\"\n";
@@ -139,10 +315,21 @@ bool MapData::unhide_layer(std::string layer_name) {
         return true;
     }
 }
+bool MapData::set_layer_collision_filter(const std::string& layer_name, unsigned category, unsigned mask) {
+    internal::Layer* temp = m_impl->get_layer_collection().get_layer(layer_name);
+    if(temp == nullptr || temp->get_type() != internal::Layer::map) {
+        std::cerr << "There is no map layer called: \"" << layer_name << "\"\n";
+        return false;
+    }
+    internal::MapLayer* layer = static_cast<internal::MapLayer*>(temp);
+    layer->set_collision_category(category);
+    layer->set_collision_mask(mask);
+    return true;
+}
 PixelDimensions MapData::get_dimensions() const {return m_impl->get_dimensions();}
 float MapData::get_delta_time() const {return m_impl->get_delta_time();}
 std::string MapData::get_path() const {return m_impl->get_full_path();}
 DataBlock MapData::get_data() {return m_impl->get_data();}
-salmon::Transform* MapData::get_layer_transform(std::string layer_name) {return m_impl->get_layer_transform(layer_name);}
+salmon::Transform* MapData::get_layer_transform(const std::string& layer_name) {return m_impl->get_layer_transform(layer_name);}
 
 } // namespace salmon
@@ -35,10 +35,36 @@ const float Transform::MIN_ROTATION = 0.01;
 Transform::Transform(float x_pos, float y_pos, float width, float height, float x_origin, float y_origin)
     : m_x_pos{x_pos}, m_y_pos{y_pos}, m_width{width}, m_height{height}, m_x_origin{x_origin}, m_y_origin{y_origin} {}
 
+Transform& Transform::operator=(const Transform& other) {
+    // Caches compare against old revisions of this transform or, after a whole actor copy, of the source
+    unsigned revision = std::max(m_revision, other.m_revision) + 1;
+    m_x_pos = other.m_x_pos;
+    m_y_pos = other.m_y_pos;
+    m_width = other.m_width;
+    m_height = other.m_height;
+    m_x_scale = other.m_x_scale;
+    m_y_scale = other.m_y_scale;
+    m_angle = other.m_angle;
+    m_x_rotate = other.m_x_rotate;
+    m_y_rotate = other.m_y_rotate;
+    m_x_origin = other.m_x_origin;
+    m_y_origin = other.m_y_origin;
+    m_x_sort = other.m_x_sort;
+    m_y_sort = other.m_y_sort;
+    m_sort_mode = other.m_sort_mode;
+    m_horizontal_flip = other.m_horizontal_flip;
+    m_vertical_flip = other.m_vertical_flip;
+    m_moved = true;
+    m_scaled = true;
+    m_revision = revision;
+    return *this;
+}
+
 void Transform::set_pos(float x, float y) {
     m_x_pos = x;
     m_y_pos = y;
     m_moved = true;
+    m_revision++;
 }
 
 void Transform::set_pos(float rel_src_x, float rel_src_y, float dest_x, float dest_y) {
@@ -51,12 +77,14 @@ void Transform::move_pos(float x, float y) {
     m_x_pos += x;
     m_y_pos += y;
     m_moved = true;
+    m_revision++;
 }
 
 void Transform::set_dimensions(float w, float h) {
     m_width=w;
     m_height=h;
     m_moved = true;
+    m_revision++;
     m_scaled = true;
 }
 
@@ -64,6 +92,7 @@ void Transform::set_scale(float x, float y) {
     m_x_scale = x;
     m_y_scale = y;
     m_moved = true;
+    m_revision++;
     m_scaled = true;
 }
 
@@ -77,6 +106,7 @@ void Transform::set_origin(float x, float y) {
     m_y_pos = location.y;
     m_x_origin = x;
     m_y_origin = y;
+    m_revision++;
 }
 
 Point Transform::get_relative(float x, float y) const {
@@ -212,6 +242,7 @@ void Transform::set_rotation_center(float x, float y) {
     // Formally set new rotation point
     m_x_rotate = x;
     m_y_rotate = y;
+    m_revision++;
 }
 
 bool Transform::is_scaled() const {
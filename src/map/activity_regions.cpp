@@ -0,0 +1,124 @@
+/*
+ * Copyright 2017-2020 Agouti Games Team (see the AUTHORS file)
+ *
+ * This file is part of the RawSalmonEngine.
+ *
+ * The RawSalmonEngine is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * The RawSalmonEngine is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with the RawSalmonEngine.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#include "map/activity_regions.hpp"
+
+#include <algorithm>
+
+#include "actor/actor.hpp"
+#include "map/object_layer.hpp"
+
+namespace salmon { namespace internal {
+
+namespace {
+/// Returns true if the rects touch, unlike Rect::has_intersection() this also holds for empty rects
+bool touches(const Rect& a, const Rect& b) {
+    return a.x <= b.x + b.w && b.x <= a.x + a.w && a.y <= b.y + b.h && b.y <= a.y + a.h;
+}
+
+/// Returns rect grown by distance on each side
+Rect grow(const Rect& rect, float distance) {
+    return Rect(rect.x - distance, rect.y - distance, rect.w + 2 * distance, rect.h + 2 * distance);
+}
+} // namespace
+
+/// Keep the actors within radius of the point awake, returns the id of the anchor
+unsigned ActivityRegions::add_anchor(Point point, float radius) {
+    m_anchors.push_back({m_next_anchor, SlotHandle(), point, radius});
+    return m_next_anchor++;
+}
+
+/// Keep the actors within radius of the bounding box of the actor awake, returns the id of the anchor
+unsigned ActivityRegions::add_anchor(SlotHandle actor, float radius) {
+    m_anchors.push_back({m_next_anchor, actor, Point(), radius});
+    return m_next_anchor++;
+}
+
+/// Remove the anchor with the given id, returns false if there is none
+bool ActivityRegions::remove_anchor(unsigned id) {
+    auto it = std::find_if(m_anchors.begin(), m_anchors.end(), [id](const Anchor& anchor) {return anchor.id == id;});
+    if(it == m_anchors.end()) {return false;}
+    m_anchors.erase(it);
+    return true;
+}
+
+/// Remove all anchors and disable sleeping
+void ActivityRegions::clear() {
+    m_margin = -1.0f;
+    m_tick_interval = 0;
+    m_anchors.clear();
+}
+
+/**
+ * @brief Decide which actors of the layers sleep during this frame
+ * @param camera The area shown by the camera in world coordinates
+ *
+ * Anchors of removed actors get dropped.
+ */
+void ActivityRegions::update(const std::vector<ObjectLayer*>& layers, const Rect& camera, SlotMap<Actor>& actors) {
+    m_frame++;
+    bool enabled = m_margin >= 0.0f;
+    if(!enabled && m_sleeping == 0) {
+        m_awake = 0;
+        for(ObjectLayer* layer : layers) {
+            if(!layer->get_suspended()) {m_awake += layer->get_actor_count();}
+        }
+        return;
+    }
+
+    m_areas.clear();
+    if(enabled) {
+        m_areas.push_back(grow(camera, m_margin));
+        m_anchors.erase(std::remove_if(m_anchors.begin(), m_anchors.end(), [&actors](const Anchor& anchor) {
+            return anchor.actor.valid() && !actors.valid(anchor.actor);
+        }), m_anchors.end());
+        for(const Anchor& anchor : m_anchors) {
+            if(anchor.actor.valid()) {
+                m_areas.push_back(grow(actors.get(anchor.actor)->get_transform().to_bounding_box(), anchor.radius));
+            }
+            else {
+                m_areas.push_back(grow(Rect(anchor.point.x, anchor.point.y, 0, 0), anchor.radius));
+            }
+        }
+    }
+
+    m_awake = 0;
+    m_sleeping = 0;
+    for(ObjectLayer* layer : layers) {
+        if(layer->get_suspended()) {continue;}
+        layer->for_each_actor([&](Actor* actor) {
+            bool awake = actor->check_wake() || !enabled;
+            if(!awake) {
+                Rect bounds = actor->get_transform().to_bounding_box();
+                for(const Rect& area : m_areas) {
+                    if(touches(bounds, area)) {awake = true; break;}
+                }
+            }
+            if(awake) {
+                actor->set_sleeping(false, false);
+                m_awake++;
+            }
+            else {
+                bool tick = m_tick_interval != 0 && (m_frame + actor->get_handle().index) % m_tick_interval == 0;
+                actor->set_sleeping(true, tick);
+                m_sleeping++;
+            }
+        });
+    }
+}
+}} // namespace salmon::internal
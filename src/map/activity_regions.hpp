@@ -0,0 +1,79 @@
+/*
+ * Copyright 2017-2020 Agouti Games Team (see the AUTHORS file)
+ *
+ * This file is part of the RawSalmonEngine.
+ *
+ * The RawSalmonEngine is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * The RawSalmonEngine is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with the RawSalmonEngine.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#ifndef ACTIVITY_REGIONS_HPP_INCLUDED
+#define ACTIVITY_REGIONS_HPP_INCLUDED
+
+#include <vector>
+
+#include "util/game_types.hpp"
+#include "util/slot_map.hpp"
+
+namespace salmon { namespace internal {
+
+class Actor;
+class ObjectLayer;
+
+/**
+ * @brief Areas around the camera and around anchors outside of which actors fall asleep
+ *
+ * Sleeping actors are left out of the collision checks and don't animate. With a tick
+ * interval each sleeping actor still gets a regular frame every nth update, staggered by
+ * slot index so the load spreads over the frames. An actor wakes once it overlaps an area
+ * again or when Actor::wake() gets called. Sleeping is disabled while the margin is negative.
+ * @note Actors of suspended object layers are neither awake nor sleeping
+ */
+class ActivityRegions {
+    public:
+        void set_margin(float margin) {m_margin = margin;}
+        float get_margin() const {return m_margin;}
+        void set_tick_interval(unsigned frames) {m_tick_interval = frames;}
+        unsigned get_tick_interval() const {return m_tick_interval;}
+
+        unsigned add_anchor(Point point, float radius);
+        unsigned add_anchor(SlotHandle actor, float radius);
+        bool remove_anchor(unsigned id);
+        void clear();
+
+        void update(const std::vector<ObjectLayer*>& layers, const Rect& camera, SlotMap<Actor>& actors);
+
+        unsigned get_awake_count() const {return m_awake;}
+        unsigned get_sleeping_count() const {return m_sleeping;}
+
+    private:
+        /// A point or actor which keeps the actors around it awake
+        struct Anchor {
+            unsigned id;
+            SlotHandle actor; ///< The followed actor, invalid for fixed points
+            Point point;
+            float radius;
+        };
+
+        float m_margin = -1.0f; ///< Distance around the camera within which actors stay awake
+        unsigned m_tick_interval = 0; ///< Sleeping actors get a frame every nth update, never if zero
+        std::vector<Anchor> m_anchors;
+        unsigned m_next_anchor = 1;
+        unsigned m_frame = 0;
+
+        unsigned m_awake = 0;
+        unsigned m_sleeping = 0;
+        std::vector<Rect> m_areas; ///< Scratch buffer of update()
+};
+}} // namespace salmon::internal
+
+#endif // ACTIVITY_REGIONS_HPP_INCLUDED
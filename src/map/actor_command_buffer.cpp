@@ -0,0 +1,105 @@
+/*
+ * Copyright 2017-2020 Agouti Games Team (see the AUTHORS file)
+ *
+ * This file is part of the RawSalmonEngine.
+ *
+ * The RawSalmonEngine is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * The RawSalmonEngine is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with the RawSalmonEngine.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#include "map/actor_command_buffer.hpp"
+
+#include <algorithm>
+
+#include "map/layer.hpp"
+#include "map/layer_collection.hpp"
+#include "map/mapdata.hpp"
+#include "map/object_layer.hpp"
+#include "util/logger.hpp"
+
+namespace salmon { namespace internal {
+
+/**
+ * @brief Queue spawning an actor from a template
+ * @return False if the template or the object layer doesn't exist
+ */
+bool ActorCommandBuffer::spawn(MapData& map, const std::string& template_name, const std::string& layer_name, const std::string& actor_name) {
+    if(!map.is_actor(template_name)) {
+        Logger(Logger::error) << "There is no actor template called: " << template_name;
+        return false;
+    }
+    Layer* layer = map.get_layer_collection().get_layer(layer_name);
+    if(layer == nullptr || layer->get_type() != Layer::object) {
+        Logger(Logger::error) << "There is no object layer called: " << layer_name;
+        return false;
+    }
+    m_spawns.push_back(Spawn{template_name, static_cast<ObjectLayer*>(layer), actor_name});
+    return true;
+}
+
+/// Queue removal of an actor, stale handles get ignored
+void ActorCommandBuffer::despawn(ActorHandle handle) {
+    m_despawns.push_back(handle);
+}
+
+/**
+ * @brief Apply all queued commands
+ *
+ * Despawns get applied before spawns so their slots can be reused.
+ * Each despawn is an O(1) removal from the object layer of the actor,
+ * afterwards each layer closes the gaps of all actors erased since the last apply.
+ */
+void ActorCommandBuffer::apply(LayerCollection& layer_collection) {
+    MapData& map = layer_collection.get_base_map();
+    m_spawned.clear();
+
+    if(!m_despawns.empty()) {
+        std::vector<Actor*> doomed;
+        doomed.reserve(m_despawns.size());
+        for(ActorHandle handle : m_despawns) {
+            Actor* actor = layer_collection.get_actor(handle);
+            if(actor != nullptr) {doomed.push_back(actor);}
+        }
+        // The same actor may have been queued more than once
+        std::sort(doomed.begin(), doomed.end());
+        doomed.erase(std::unique(doomed.begin(), doomed.end()), doomed.end());
+        for(Actor* actor : doomed) {
+            actor->get_object_layer()->erase_actor(actor);
+        }
+        m_despawns.clear();
+    }
+    for(ObjectLayer* layer : layer_collection.get_object_layers()) {
+        layer->compact_actors();
+    }
+
+    if(!m_spawns.empty()) {
+        m_spawned.reserve(m_spawns.size());
+        for(ObjectLayer* layer : layer_collection.get_object_layers()) {
+            layer->reserve_actors(std::count_if(m_spawns.begin(), m_spawns.end(), [layer](const Spawn& s) {return s.layer == layer;}));
+        }
+        for(const Spawn& spawn : m_spawns) {
+            Actor* actor = spawn.layer->add_actor(map.acquire_actor(spawn.template_name));
+            actor->set_name(spawn.name);
+            m_spawned.push_back(actor->get_handle());
+        }
+        m_spawns.clear();
+    }
+}
+
+/// Drop all queued commands without applying them
+void ActorCommandBuffer::clear() {
+    m_spawns.clear();
+    m_despawns.clear();
+    m_spawned.clear();
+}
+
+}} // namespace salmon::internal
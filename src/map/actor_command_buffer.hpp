@@ -0,0 +1,65 @@
+/*
+ * Copyright 2017-2020 Agouti Games Team (see the AUTHORS file)
+ *
+ * This file is part of the RawSalmonEngine.
+ *
+ * The RawSalmonEngine is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * The RawSalmonEngine is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with the RawSalmonEngine.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#ifndef ACTOR_COMMAND_BUFFER_HPP_INCLUDED
+#define ACTOR_COMMAND_BUFFER_HPP_INCLUDED
+
+#include <string>
+#include <vector>
+
+#include "actor/actor.hpp"
+
+namespace salmon { namespace internal {
+
+class LayerCollection;
+class MapData;
+class ObjectLayer;
+
+/**
+ * @brief Queue of actor spawns and despawns which get applied in one batch
+ *
+ * Game code may queue commands at any time, even while iterating over actors.
+ * The map applies them at the start of its next update, each object layer
+ * gets changed only once per batch.
+ */
+class ActorCommandBuffer {
+    public:
+        bool spawn(MapData& map, const std::string& template_name, const std::string& layer_name, const std::string& actor_name);
+        void despawn(ActorHandle handle);
+
+        void apply(LayerCollection& layer_collection);
+        void clear();
+
+        bool empty() const {return m_spawns.empty() && m_despawns.empty();}
+        /// Handles of the actors created by the last apply(), in the order they were queued
+        const std::vector<ActorHandle>& get_spawned() const {return m_spawned;}
+
+    private:
+        struct Spawn {
+            std::string template_name;
+            ObjectLayer* layer;
+            std::string name;
+        };
+
+        std::vector<Spawn> m_spawns;
+        std::vector<ActorHandle> m_despawns;
+        std::vector<ActorHandle> m_spawned;
+};
+}} // namespace salmon::internal
+
+#endif // ACTOR_COMMAND_BUFFER_HPP_INCLUDED
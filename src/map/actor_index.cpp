@@ -0,0 +1,57 @@
+/*
+ * Copyright 2017-2020 Agouti Games Team (see the AUTHORS file)
+ *
+ * This file is part of the RawSalmonEngine.
+ *
+ * The RawSalmonEngine is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * The RawSalmonEngine is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with the RawSalmonEngine.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#include "map/actor_index.hpp"
+
+namespace salmon { namespace internal {
+
+/// Store the handle under the key
+void ActorIndex::insert(const std::string& key, SlotHandle handle) {
+    std::vector<SlotHandle>& bucket = m_buckets[key];
+    if(handle.index >= m_positions.size()) {m_positions.resize(handle.index + 1);}
+    m_positions[handle.index] = bucket.size();
+    bucket.push_back(handle);
+}
+
+/// Remove the handle from the key, the last handle of the bucket takes its place
+void ActorIndex::erase(const std::string& key, SlotHandle handle) {
+    auto it = m_buckets.find(key);
+    if(it == m_buckets.end() || handle.index >= m_positions.size()) {return;}
+    std::vector<SlotHandle>& bucket = it->second;
+    Uint32 pos = m_positions[handle.index];
+    if(pos >= bucket.size() || bucket[pos] != handle) {return;}
+
+    bucket[pos] = bucket.back();
+    m_positions[bucket[pos].index] = pos;
+    bucket.pop_back();
+    if(bucket.empty()) {m_buckets.erase(it);}
+}
+
+void ActorIndex::clear() {
+    m_buckets.clear();
+    m_positions.clear();
+}
+
+/// Returns the handles of all actors stored under the key
+const std::vector<SlotHandle>& ActorIndex::find(const std::string& key) const {
+    static const std::vector<SlotHandle> none;
+    auto it = m_buckets.find(key);
+    return (it == m_buckets.end()) ? none : it->second;
+}
+
+}} // namespace salmon::internal
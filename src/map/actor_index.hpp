@@ -0,0 +1,51 @@
+/*
+ * Copyright 2017-2020 Agouti Games Team (see the AUTHORS file)
+ *
+ * This file is part of the RawSalmonEngine.
+ *
+ * The RawSalmonEngine is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * The RawSalmonEngine is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with the RawSalmonEngine.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#ifndef ACTOR_INDEX_HPP_INCLUDED
+#define ACTOR_INDEX_HPP_INCLUDED
+
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include "util/slot_map.hpp"
+
+namespace salmon { namespace internal {
+
+/**
+ * @brief Hash index from a string key to the handles of all actors with that key
+ *
+ * Each actor is stored under at most one key. Insertion and removal are O(1)
+ * because the position of each actor within its bucket is tracked by slot index.
+ * The order within a bucket isn't stable.
+ */
+class ActorIndex {
+    public:
+        void insert(const std::string& key, SlotHandle handle);
+        void erase(const std::string& key, SlotHandle handle);
+        void clear();
+
+        const std::vector<SlotHandle>& find(const std::string& key) const;
+
+    private:
+        std::unordered_map<std::string, std::vector<SlotHandle>> m_buckets;
+        std::vector<Uint32> m_positions; ///< Position within the bucket by slot index
+};
+}} // namespace salmon::internal
+
+#endif // ACTOR_INDEX_HPP_INCLUDED
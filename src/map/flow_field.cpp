@@ -0,0 +1,268 @@
+/*
+ * Copyright 2017-2020 Agouti Games Team (see the AUTHORS file)
+ *
+ * This file is part of the RawSalmonEngine.
+ *
+ * The RawSalmonEngine is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * The RawSalmonEngine is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with the RawSalmonEngine.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#include "map/flow_field.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <functional>
+#include <limits>
+
+#include "map/nav_grid.hpp"
+#include "util/thread_pool.hpp"
+
+namespace salmon { namespace internal {
+
+namespace {
+const float unreachable = std::numeric_limits<float>::infinity();
+}
+
+const Uint32 FlowField::no_parent;
+
+/**
+ * @brief Compute the field toward the cells containing the goals
+ * @param grid The grid to navigate on, has to outlive the field
+ * @param goals World positions, goals outside of the grid get ignored
+ * @param pool Spreads deriving the directions over threads, may be nullptr
+ */
+void FlowField::init(const NavGrid& grid, const std::vector<Point>& goals, ThreadPool* pool) {
+    m_grid = &grid;
+    m_goals = goals;
+    compute(pool);
+}
+
+/**
+ * @brief Follow the changes of the grid since the last update
+ * @param pool Spreads a full recomputation over threads, may be nullptr
+ * @return True if the field changed
+ *
+ * A rebuilt grid gets a full recomputation, changes of single cells an incremental one.
+ */
+bool FlowField::update(ThreadPool* pool) {
+    if(m_grid == nullptr) {return false;}
+    if(m_grid->get_generation() != m_generation) {
+        compute(pool);
+        return true;
+    }
+    if(m_change_count == m_grid->get_changes().size()) {return false;}
+    apply_changes();
+    return true;
+}
+
+/// Returns the unit vector toward the closest goal, zero at the goals and where none is reachable
+Point FlowField::get_direction(Point world) const {
+    Uint32 cell;
+    return lookup(world, cell) ? m_direction[cell] : Point{0.0f, 0.0f};
+}
+
+/// Returns the path cost to the closest goal or a negative value if there is none, see NavGrid::for_each_neighbour() for its unit
+float FlowField::get_distance(Point world) const {
+    Uint32 cell;
+    if(!lookup(world, cell) || m_distance[cell] == unreachable) {return -1.0f;}
+    return m_distance[cell];
+}
+
+bool FlowField::lookup(Point world, Uint32& cell) const {
+    unsigned x, y;
+    if(m_grid == nullptr || !m_grid->to_cell(world, x, y)) {return false;}
+    cell = y * m_grid->get_width() + x;
+    // The grid may have been rebuilt with another size since the last update
+    return cell < m_direction.size();
+}
+
+/// Recompute the whole field
+void FlowField::compute(ThreadPool* pool) {
+    const NavGrid& grid = *m_grid;
+    unsigned width = grid.get_width();
+    unsigned height = grid.get_height();
+    unsigned size = width * height;
+    m_generation = grid.get_generation();
+    m_change_count = grid.get_changes().size();
+    m_is_goal.assign(size, 0);
+    m_distance.assign(size, unreachable);
+    m_parent.assign(size, no_parent);
+    m_direction.assign(size, Point{0.0f, 0.0f});
+    m_open.clear();
+    m_touched.clear();
+
+    for(Point goal : m_goals) {
+        unsigned x, y;
+        if(!grid.to_cell(goal, x, y)) {continue;}
+        Uint32 cell = y * width + x;
+        m_is_goal[cell] = 1;
+        if(!grid.is_blocked(cell)) {push(cell, 0.0f);}
+    }
+    integrate();
+    m_touched.clear();
+
+    // Each direction only reads the finished integration field, so rows can be processed in parallel
+    auto rows = [this, width](unsigned from, unsigned to) {
+        for(Uint32 cell = from * width; cell < to * width; cell++) {update_direction(cell);}
+    };
+    const unsigned min_rows = 16;
+    if(pool == nullptr || height < min_rows * 2) {
+        rows(0, height);
+    }
+    else {
+        unsigned chunk = std::max(min_rows, height / (pool->get_thread_count() * 4));
+        unsigned chunks = (height + chunk - 1) / chunk;
+        pool->run(chunks, [&rows, chunk, height](unsigned i) {
+            rows(i * chunk, std::min(height, (i + 1) * chunk));
+        });
+    }
+}
+
+/**
+ * @brief Apply the changes of the grid since the last update
+ *
+ * Blocking a cell invalidates it and every cell whose parent chain leads through it,
+ * including diagonal moves past it. These get refilled from their intact neighbours.
+ * Costs of cells outside of the invalidated trees can only rise by blocking cells and
+ * stay valid. Freed cells get their costs from their neighbours and spread lower ones.
+ */
+void FlowField::apply_changes() {
+    const NavGrid& grid = *m_grid;
+    const std::vector<Uint32>& changes = grid.get_changes();
+    unsigned width = grid.get_width();
+    unsigned height = grid.get_height();
+    auto for_each_adjacent = [width, height](Uint32 cell, const std::function<void(Uint32)>& f) {
+        int x = cell % width;
+        int y = cell / width;
+        for(int n_y = std::max(y - 1, 0); n_y <= std::min<int>(y + 1, height - 1); n_y++) {
+            for(int n_x = std::max(x - 1, 0); n_x <= std::min<int>(x + 1, width - 1); n_x++) {
+                if(n_x != x || n_y != y) {f(n_y * width + n_x);}
+            }
+        }
+    };
+
+    // Cells which need their costs from the neighbours
+    std::vector<Uint32> invalid;
+    std::vector<Uint32> stack;
+    auto invalidate = [&](Uint32 root) {
+        stack.push_back(root);
+        while(!stack.empty()) {
+            Uint32 cell = stack.back();
+            stack.pop_back();
+            m_distance[cell] = unreachable;
+            m_parent[cell] = no_parent;
+            invalid.push_back(cell);
+            for_each_adjacent(cell, [&](Uint32 child) {
+                if(m_parent[child] == cell && child != cell) {stack.push_back(child);}
+            });
+        }
+    };
+
+    m_touched.clear();
+    for(unsigned i = m_change_count; i < changes.size(); i++) {
+        Uint32 changed = changes[i];
+        invalid.push_back(changed);
+        if(!grid.is_blocked(changed)) {continue;}
+        if(m_distance[changed] != unreachable) {invalidate(changed);}
+        // Diagonal moves next to a blocked cell may have become impossible
+        for_each_adjacent(changed, [&](Uint32 cell) {
+            Uint32 parent = m_parent[cell];
+            if(parent == no_parent || parent == cell) {return;}
+            bool reachable = false;
+            grid.for_each_neighbour(cell, [parent, &reachable](Uint32 neighbour, float) {
+                if(neighbour == parent) {reachable = true;}
+            });
+            if(!reachable) {invalidate(cell);}
+        });
+    }
+    m_change_count = changes.size();
+
+    // Seed the search with the intact neighbours of all invalidated and freed cells
+    m_open.clear();
+    for(Uint32 cell : invalid) {
+        if(grid.is_blocked(cell)) {continue;}
+        if(m_is_goal[cell]) {push(cell, 0.0f);}
+        grid.for_each_neighbour(cell, [this](Uint32 neighbour, float) {
+            if(m_distance[neighbour] != unreachable) {
+                m_open.push_back({m_distance[neighbour], neighbour});
+                std::push_heap(m_open.begin(), m_open.end());
+            }
+        });
+    }
+    integrate();
+
+    // Directions depend on the costs of all neighbours
+    auto refresh = [&](Uint32 cell) {
+        update_direction(cell);
+        for_each_adjacent(cell, [this](Uint32 neighbour) {update_direction(neighbour);});
+    };
+    for(Uint32 cell : invalid) {refresh(cell);}
+    for(Uint32 cell : m_touched) {refresh(cell);}
+    m_touched.clear();
+}
+
+/// Lower the cost of cell and queue it if that is an improvement
+void FlowField::push(Uint32 cell, float distance) {
+    if(distance >= m_distance[cell]) {return;}
+    m_distance[cell] = distance;
+    m_touched.push_back(cell);
+    m_open.push_back({distance, cell});
+    std::push_heap(m_open.begin(), m_open.end());
+}
+
+/// Run Dijkstra from the queued cells
+void FlowField::integrate() {
+    while(!m_open.empty()) {
+        std::pop_heap(m_open.begin(), m_open.end());
+        OpenNode node = m_open.back();
+        m_open.pop_back();
+        // Skip outdated duplicates
+        if(node.distance > m_distance[node.cell]) {continue;}
+        m_grid->for_each_neighbour(node.cell, [this, &node](Uint32 neighbour, float step) {
+            push(neighbour, node.distance + step);
+        });
+    }
+}
+
+/// Point cell at its cheapest neighbour
+void FlowField::update_direction(Uint32 cell) {
+    m_direction[cell] = {0.0f, 0.0f};
+    if(m_grid->is_blocked(cell) || m_distance[cell] == unreachable) {
+        m_parent[cell] = no_parent;
+        return;
+    }
+    if(m_is_goal[cell]) {
+        m_parent[cell] = cell;
+        return;
+    }
+
+    float best = unreachable;
+    Uint32 parent = no_parent;
+    m_grid->for_each_neighbour(cell, [this, &best, &parent](Uint32 neighbour, float step) {
+        float distance = m_distance[neighbour] + step;
+        if(distance < best) {
+            best = distance;
+            parent = neighbour;
+        }
+    });
+    m_parent[cell] = parent;
+    if(parent == no_parent) {return;}
+
+    unsigned width = m_grid->get_width();
+    Point from = m_grid->get_cell_origin(cell % width, cell / width);
+    Point to = m_grid->get_cell_origin(parent % width, parent / width);
+    Point delta{to.x - from.x, to.y - from.y};
+    float length = std::hypot(delta.x, delta.y);
+    if(length > 0.0f) {m_direction[cell] = {delta.x / length, delta.y / length};}
+}
+
+}} // namespace salmon::internal
@@ -0,0 +1,82 @@
+/*
+ * Copyright 2017-2020 Agouti Games Team (see the AUTHORS file)
+ *
+ * This file is part of the RawSalmonEngine.
+ *
+ * The RawSalmonEngine is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * The RawSalmonEngine is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with the RawSalmonEngine.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#ifndef FLOW_FIELD_HPP_INCLUDED
+#define FLOW_FIELD_HPP_INCLUDED
+
+#include <vector>
+#include <SDL.h>
+
+#include "util/game_types.hpp"
+
+namespace salmon { namespace internal {
+
+class NavGrid;
+class ThreadPool;
+
+/**
+ * @brief Directions toward the closest of a set of goal cells for every cell of a NavGrid
+ *
+ * The integration field holds the path cost from each cell to the closest goal and gets
+ * computed with Dijkstra. Each cell then points at its neighbour with the lowest cost,
+ * so any number of actors can steer along the field with a single lookup each.
+ *
+ * Changes of the NavGrid get applied incrementally by update(): Blocked cells and all
+ * cells whose path passed through them get recomputed from the intact surroundings,
+ * freed cells spread their lower costs.
+ */
+class FlowField {
+    public:
+        void init(const NavGrid& grid, const std::vector<Point>& goals, ThreadPool* pool);
+        bool update(ThreadPool* pool);
+
+        bool empty() const {return m_grid == nullptr;}
+        Point get_direction(Point world) const;
+        float get_distance(Point world) const;
+
+    private:
+        static const Uint32 no_parent = 0xFFFFFFFF;
+
+        struct OpenNode {
+            float distance;
+            Uint32 cell;
+            bool operator<(const OpenNode& other) const {return distance > other.distance;} ///< Makes the heap a min heap
+        };
+
+        void compute(ThreadPool* pool);
+        void apply_changes();
+        void integrate();
+        void push(Uint32 cell, float distance);
+        void update_direction(Uint32 cell);
+        bool lookup(Point world, Uint32& cell) const;
+
+        const NavGrid* m_grid = nullptr;
+        unsigned m_generation = 0; ///< Generation of m_grid the field got computed for
+        unsigned m_change_count = 0; ///< Count of changes of m_grid which are applied
+
+        std::vector<Point> m_goals; ///< World positions
+        std::vector<Uint8> m_is_goal;
+        std::vector<float> m_distance; ///< Integration field, infinite if no goal is reachable
+        std::vector<Uint32> m_parent; ///< Next cell toward the closest goal, the cell itself for goals
+        std::vector<Point> m_direction; ///< Unit vector toward the parent in world space
+        std::vector<OpenNode> m_open;
+        std::vector<Uint32> m_touched; ///< Cells whose cost changed during an incremental update
+};
+}} // namespace salmon::internal
+
+#endif // FLOW_FIELD_HPP_INCLUDED
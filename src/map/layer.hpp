@@ -64,7 +64,7 @@ class Layer {
         virtual bool render(const Camera& camera) const = 0;
 
         virtual LayerType get_type() {return LayerType::undefinied;}
-        std::string get_name() const {return m_name;}
+        const std::string& get_name() const {return m_name;}
         bool get_hidden() const {return m_hidden;}
         void hide() {m_hidden = true;}
         void unhide() {m_hidden = false;}
@@ -16,6 +16,7 @@
  * You should have received a copy of the GNU General Public License
  * along with the RawSalmonEngine.  If not, see <http://www.gnu.org/licenses/>.
  */
+#include <algorithm>
 #include <iostream>
 
 #include "actor/actor.hpp"
@@ -26,11 +27,54 @@
 #include "map/object_layer.hpp"
 #include "map/layer_collection.hpp"
 #include "map/tile.hpp"
+#include "map/tileset_collection.hpp"
 #include "core/gameinfo.hpp"
 #include "util/logger.hpp"
 
 namespace salmon { namespace internal {
 
+namespace {
+/// Return true if id is one of hitboxes or if hitboxes is empty
+bool match_hitbox(HitboxId id, const std::vector<HitboxId>& hitboxes) {
+    return hitboxes.empty() || std::find(hitboxes.begin(), hitboxes.end(), id) != hitboxes.end();
+}
+
+/// Like sweep_rect() for a ray, but a ray starting within rect hits it at fraction zero
+bool ray_hit(Point origin, Point delta, const Rect& rect, float& fraction, Point& normal) {
+    if(rect.has_intersection(origin)) {
+        if(fraction <= 0.0f) {return false;}
+        fraction = 0.0f;
+        normal = {0.0f, 0.0f};
+        return true;
+    }
+    return sweep_rect(Rect(origin.x, origin.y, 0, 0), delta, rect, fraction, normal);
+}
+
+/// Return the bounding box of the transform and all hitboxes of actor
+Rect collision_bounds(const Actor& actor) {
+    Rect bounds = actor.get_transform().to_bounding_box();
+    for(const auto& hitbox : actor.get_hitboxes()) {
+        if(hitbox.rect.empty()) {continue;}
+        float right = std::max(bounds.x + bounds.w, hitbox.rect.x + hitbox.rect.w);
+        float bottom = std::max(bounds.y + bounds.h, hitbox.rect.y + hitbox.rect.h);
+        bounds.x = std::min(bounds.x, hitbox.rect.x);
+        bounds.y = std::min(bounds.y, hitbox.rect.y);
+        bounds.w = right - bounds.x;
+        bounds.h = bottom - bounds.y;
+    }
+    return bounds;
+}
+
+/// Return true if contact a comes before contact b within LayerCollection::m_contacts
+template<typename Contact>
+bool contact_order(const Contact& a, const Contact& b) {
+    if(a.first.index != b.first.index) {return a.first.index < b.first.index;}
+    if(a.second.index != b.second.index) {return a.second.index < b.second.index;}
+    if(a.first_hitbox != b.first_hitbox) {return a.first_hitbox < b.first_hitbox;}
+    return a.second_hitbox < b.second_hitbox;
+}
+} // namespace
+
 /**
  * @brief Parses each layer and stores in vector member
  * @param source The @c XMLElement which stores the layer info
@@ -58,8 +102,23 @@ namespace salmon { namespace internal {
     /// Don't forget to implement the new pointer inheritance approach
     // Clear layer vector member of possible old data
     m_layers.clear();
+    m_map_layers.clear();
+    m_image_layers.clear();
+    m_object_layers.clear();
+    m_layer_names.clear();
+    m_actor_slots.clear();
+    m_actor_names.clear();
+    m_actor_types.clear();
+    m_actor_grid_entries.clear();
     m_layers.reserve(p_layers.size());
 
+    // A grid cell spans a few tiles, most actors are about one tile in size
+    const TilesetCollection& tilesets = base_map.get_ts_collection();
+    unsigned tile_size = std::max(tilesets.get_tile_w(), tilesets.get_tile_h());
+    m_actor_grid.set_cell_size((tile_size == 0) ? 128.0f : tile_size * 4.0f);
+    m_triggers.clear();
+    m_triggers.set_cell_size((tile_size == 0) ? 128.0f : tile_size * 4.0f);
+
     // Actually parse each layer of the vector of pointers
     for(unsigned i_layer = 0; i_layer < p_layers.size(); i_layer++) {
         XMLError eResult = XML_SUCCESS;
@@ -68,6 +127,15 @@ namespace salmon { namespace internal {
             Logger(Logger::error) << "Failed at parsing layer: " << i_layer;
             return eResult;
         }
+        // Lookups by name yield the first layer of that name
+        Layer* layer = m_layers.back().get();
+        m_layer_names.emplace(layer->get_name(), layer);
+        switch(layer->get_type()) {
+            case Layer::map: m_map_layers.push_back(static_cast<MapLayer*>(layer)); break;
+            case Layer::image: m_image_layers.push_back(static_cast<ImageLayer*>(layer)); break;
+            case Layer::object: m_object_layers.push_back(static_cast<ObjectLayer*>(layer)); break;
+            default: break;
+        }
     }
     return XML_SUCCESS;
  }
@@ -92,14 +160,16 @@ bool LayerCollection::render(const Camera& camera) const{
 /**
  * @brief Updates each object layer state
  *
- * First poll possible actor - actor, actor - tile and actor - mouse intersections
+ * First decide which actors sleep, then poll possible actor - actor, actor - tile and actor - mouse intersections and trigger region events
  * Then call update for each object layer (Establishes correct render order for actors)
  * @note Doesn't poll collisions on late updates
  */
 void LayerCollection::update() {
+    m_activity.update(m_object_layers, m_base_map->get_camera().get_transform().to_rect(), m_actor_slots);
     // Add possible collisions to actors
     collision_check();
     mouse_collision();
+    m_triggers.update(m_object_layers);
 }
 
 /**
@@ -107,9 +177,9 @@ void LayerCollection::update() {
  */
 std::vector<Actor*> LayerCollection::get_actors() {
     std::vector<Actor*> actor_list;
-    for(auto& layer : get_object_layers()) {
-        std::vector<Actor*> sublist = layer->get_actors();
-        actor_list.insert(actor_list.end(),sublist.begin(),sublist.end());
+    actor_list.reserve(m_actor_slots.size());
+    for(ObjectLayer* layer : m_object_layers) {
+        layer->for_each_actor([&actor_list](Actor* actor) {actor_list.push_back(actor);});
     }
     return actor_list;
 }
@@ -118,128 +188,323 @@ std::vector<Actor*> LayerCollection::get_actors() {
  * @brief Fetch all actors which have the given name
  * @return Vector of pointers to actor
  */
-std::vector<Actor*> LayerCollection::get_actors(std::string name) {
+std::vector<Actor*> LayerCollection::get_actors(const std::string& name) {
     std::vector<Actor*> actor_list;
-    for(auto& layer : get_object_layers()) {
-        std::vector<Actor*> sublist = layer->get_actors(name);
-        actor_list.insert(actor_list.end(),sublist.begin(),sublist.end());
+    for(ActorHandle handle : m_actor_names.find(name)) {
+        actor_list.push_back(m_actor_slots.get(handle));
     }
+    // The index doesn't keep the order, but scripts sharing names rely on it
+    std::sort(actor_list.begin(), actor_list.end(), [this](const Actor* a, const Actor* b) {return comes_before(*a, *b);});
     return actor_list;
 }
 
 /**
- * @brief Fetch first actor which has the name
- * @return Pointer to matching actor
+ * @brief Fetch all actors which got constructed from the given template
+ * @return Vector of pointers to actor
  */
-Actor* LayerCollection::get_actor(std::string name) {
-    for(auto& layer : get_object_layers()) {
-        Actor* a = layer->get_actor(name);
-        if(a != nullptr) {return a;}
+std::vector<Actor*> LayerCollection::get_actors_of_type(const std::string& type) {
+    std::vector<Actor*> actor_list;
+    for(ActorHandle handle : m_actor_types.find(type)) {
+        actor_list.push_back(m_actor_slots.get(handle));
     }
-    return nullptr;
+    return actor_list;
 }
 
 /**
- * @brief Fetches all MapLayers
- * @return Vector of MapLayer pointers
+ * @brief Fetch the first actor which has the name
+ * @return Pointer to matching actor
+ * @note If several actors share the name, the first one in the order of comes_before() gets returned
  */
-std::vector<MapLayer*> LayerCollection::get_map_layers() {
-    std::vector<MapLayer*> layer_list;
-    for(auto& layer : m_layers) {
-        if(layer->get_type() == Layer::map) {
-            layer_list.push_back(static_cast<MapLayer*>(layer.get()));
-        }
+Actor* LayerCollection::get_actor(const std::string& name) {
+    Actor* first = nullptr;
+    for(ActorHandle handle : m_actor_names.find(name)) {
+        Actor* actor = m_actor_slots.get(handle);
+        if(first == nullptr || comes_before(*actor, *first)) {first = actor;}
     }
-    return layer_list;
+    return first;
 }
 
 /**
- * @brief Fetches all ImageLayer
- * @return Vector of ImageLayer pointers
+ * @brief Returns true if actor a comes before actor b when going through the object layers in map order
+ *
+ * Within a layer the actor added first comes first, which is the order of a scan
+ * over the actors of all layers before actors got erased.
  */
-std::vector<ImageLayer*> LayerCollection::get_image_layers() {
-    std::vector<ImageLayer*> layer_list;
-    for(auto& layer : m_layers) {
-        if(layer->get_type() == Layer::image) {
-            layer_list.push_back(static_cast<ImageLayer*>(layer.get()));
-        }
+bool LayerCollection::comes_before(const Actor& a, const Actor& b) const {
+    if(a.get_object_layer() != b.get_object_layer()) {
+        auto layer_a = std::find(m_object_layers.begin(), m_object_layers.end(), a.get_object_layer());
+        auto layer_b = std::find(m_object_layers.begin(), m_object_layers.end(), b.get_object_layer());
+        return layer_a < layer_b;
     }
-    return layer_list;
+    return a.get_id() < b.get_id();
+}
+
+/// Add a stored actor to the name and type indexes
+void LayerCollection::index_actor(const Actor& actor) {
+    m_actor_names.insert(actor.get_name(), actor.get_handle());
+    m_actor_types.insert(actor.get_type(), actor.get_handle());
+}
+
+/// Remove a stored actor from the name and type indexes
+void LayerCollection::unindex_actor(const Actor& actor) {
+    m_actor_names.erase(actor.get_name(), actor.get_handle());
+    m_actor_types.erase(actor.get_type(), actor.get_handle());
 }
 
 /**
- * @brief Fetches all ObjectLayers
- * @return Vector of ObjectLayer pointers
+ * @brief Adds collisions for actor -- actor and actor -- tile hitbox intersections
+ *
+ * Contacts persist between calls. Only actors whose hitboxes, collision filter or
+ * participation changed since the last call get their contacts recomputed, the contacts
+ * between unchanged actors are carried over. If most actors changed, all actor pairs get
+ * tested in one batch instead. Tile contacts get recomputed for changed actors, for actors
+ * overlapping animated tiles and for all actors once a map layer moves or changes its filter.
+ *
+ * Actors of suspended layers, sleeping actors, actors with an empty category or mask and map layers
+ * without tile hitboxes are left out. Pairs whose categories and masks don't match
+ * get dropped before any narrowphase work.
+ *
+ * Each actor receives its actor collisions ordered by slot index of the other actor,
+ * then its tile collisions, independent of the thread count.
  */
-std::vector<ObjectLayer*> LayerCollection::get_object_layers() {
-    std::vector<ObjectLayer*> layer_list;
-    for(auto& layer : m_layers) {
-        if(layer->get_type() == Layer::object) {
-            layer_list.push_back(static_cast<ObjectLayer*>(layer.get()));
+void LayerCollection::collision_check() {
+    m_contact_pass++;
+    std::vector<Actor*> actors;
+    std::vector<Actor*> dirty;
+    actors.reserve(m_actor_slots.size());
+    for(ObjectLayer* layer : m_object_layers) {
+        if(layer->get_suspended()) {continue;}
+        layer->for_each_actor([&](Actor* actor) {
+            Uint32 category = actor->get_collision_category();
+            Uint32 mask = actor->get_collision_mask();
+            if(category == 0 || mask == 0 || actor->is_paused()) {return;}
+            actors.push_back(actor);
+
+            ActorHandle handle = actor->get_handle();
+            if(handle.index >= m_contact_entries.size()) {m_contact_entries.resize(handle.index + 1);}
+            ContactEntry& entry = m_contact_entries[handle.index];
+            unsigned generation = actor->get_hitbox_generation();
+            entry.dirty = entry.handle != handle || entry.seen + 1 != m_contact_pass || entry.hitbox_generation != generation ||
+                          entry.category != category || entry.mask != mask;
+            entry.handle = handle;
+            entry.hitbox_generation = generation;
+            entry.category = category;
+            entry.mask = mask;
+            entry.seen = m_contact_pass;
+            if(entry.dirty) {dirty.push_back(actor);}
+        });
+    }
+
+    // Drop the contacts of changed or vanished actors
+    auto stale = [this](ActorHandle handle) {
+        const ContactEntry& entry = m_contact_entries[handle.index];
+        return entry.dirty || entry.seen != m_contact_pass || entry.handle != handle;
+    };
+    m_contacts.erase(std::remove_if(m_contacts.begin(), m_contacts.end(), [&stale](const ActorContact& contact) {
+        return stale(contact.first) || stale(contact.second);
+    }), m_contacts.end());
+
+    // Testing all pairs at once pays off once a quarter of the actors changed
+    const unsigned full_check_ratio = 4;
+    if(dirty.size() * full_check_ratio >= actors.size()) {find_all_contacts(actors);}
+    else if(!dirty.empty()) {find_dirty_contacts(dirty);}
+
+    std::vector<MapLayer*> map_layers;
+    std::vector<unsigned> tile_layer_state;
+    for(MapLayer* layer : get_map_layers()) {
+        if(layer->has_collisions() && layer->get_collision_category() != 0 && layer->get_collision_mask() != 0) {
+            map_layers.push_back(layer);
+            tile_layer_state.push_back(layer->get_transform().get_revision());
+            tile_layer_state.push_back(layer->get_collision_category());
+            tile_layer_state.push_back(layer->get_collision_mask());
+        }
+    }
+    if(tile_layer_state != m_tile_layer_state) {
+        m_tile_layer_state = tile_layer_state;
+        find_tile_contacts(actors, map_layers);
+    }
+    else {
+        std::vector<Actor*> tile_actors;
+        for(Actor* actor : actors) {
+            const ContactEntry& entry = m_contact_entries[actor->get_handle().index];
+            if(entry.dirty || entry.animated_tiles) {tile_actors.push_back(actor);}
+        }
+        find_tile_contacts(tile_actors, map_layers);
+    }
+
+    for(const ActorContact& contact : m_contacts) {
+        Actor* first = m_actor_slots.get(contact.first);
+        Actor* second = m_actor_slots.get(contact.second);
+        first->add_collision(CollisionRecord::make_actor(second, contact.first_hitbox, contact.second_hitbox, contact.rect));
+        second->add_collision(CollisionRecord::make_actor(first, contact.second_hitbox, contact.first_hitbox, contact.rect));
+    }
+    for(Actor* actor : actors) {
+        for(const PendingCollision& p : m_contact_entries[actor->get_handle().index].tiles) {
+            p.actor->add_collision(p.record);
         }
     }
-    return layer_list;
 }
 
 /**
- * @brief Adds collisions for actor -- actor and actor -- tile hitbox intersections
+ * @brief Replaces all actor contacts by testing each pair of actors
+ *
+ * The hitboxes get tested in batches against the hitboxes of all following actors,
+ * in chunks on the thread pool.
  */
-void LayerCollection::collision_check() {
-    // Iterate over the hitboxes of all actors
-    std::vector<Actor*> actors = get_actors();
+void LayerCollection::find_all_contacts(const std::vector<Actor*>& actors) {
+    m_contacts.clear();
     if(actors.empty()) {return;}
-    for(unsigned i = 0; i < actors.size()-1; i++) {
-        for(unsigned j = i + 1; j < actors.size(); j++) {
-            actors[i]->check_collision(*actors[j],true);
+
+    m_actor_hitboxes.clear();
+    m_actor_hitbox_start.clear();
+    for(unsigned i = 0; i < actors.size(); i++) {
+        m_actor_hitbox_start.push_back(m_actor_hitboxes.size());
+        for(const auto& hitbox : actors[i]->get_hitboxes()) {
+            m_actor_hitboxes.push(hitbox.rect, i, hitbox.id);
         }
     }
+    m_actor_hitbox_start.push_back(m_actor_hitboxes.size());
 
-    for(Actor* actor : actors) {
-        Rect bounds = actor->get_transform().to_bounding_box();
-        for(MapLayer* layer : get_map_layers()) {
-            for(auto tile : layer->get_clip(bounds)) {
-                actor->check_collision(tile,true);
+    const unsigned min_chunk_size = 8;
+    unsigned chunk_size = std::max(min_chunk_size, static_cast<unsigned>(actors.size()) / (get_thread_pool().get_thread_count() * 4));
+    unsigned chunks = (actors.size() + chunk_size - 1) / chunk_size;
+
+    m_new_contacts.resize(chunks);
+    get_thread_pool().run(chunks, [&](unsigned chunk) {
+        std::vector<ActorContact>& found = m_new_contacts[chunk];
+        found.clear();
+        std::vector<unsigned> matches;
+        unsigned to = std::min<unsigned>((chunk + 1) * chunk_size, actors.size());
+        for(unsigned i = chunk * chunk_size; i < to; i++) {
+            unsigned others = m_actor_hitbox_start[i + 1];
+            for(unsigned first = m_actor_hitbox_start[i]; first < others; first++) {
+                matches.clear();
+                m_actor_hitboxes.query(m_actor_hitboxes.get_rect(first), others, matches);
+                for(unsigned second : matches) {
+                    const Actor* a = actors[i];
+                    const Actor* b = actors[m_actor_hitboxes.get_owner(second)];
+                    if(!a->can_collide(b->get_collision_category(), b->get_collision_mask())) {continue;}
+                    ActorContact contact{a->get_handle(), b->get_handle(), m_actor_hitboxes.get_id(first), m_actor_hitboxes.get_id(second),
+                                         m_actor_hitboxes.get_rect(first).get_intersection(m_actor_hitboxes.get_rect(second))};
+                    if(!a->pixels_overlap(contact.rect, *b)) {continue;}
+                    if(contact.first.index > contact.second.index) {
+                        std::swap(contact.first, contact.second);
+                        std::swap(contact.first_hitbox, contact.second_hitbox);
+                    }
+                    found.push_back(contact);
+                }
             }
         }
+    });
+
+    for(const std::vector<ActorContact>& found : m_new_contacts) {
+        m_contacts.insert(m_contacts.end(), found.begin(), found.end());
     }
+    std::sort(m_contacts.begin(), m_contacts.end(), contact_order<ActorContact>);
 }
 
-/// Returns true if the given actor exists
-bool LayerCollection::check_actor(const Actor* actor) {
-    for(Actor* a : get_actors()) {
-        if(a == actor) {return true;}
+/**
+ * @brief Adds the contacts of the changed actors to the carried over contacts
+ *
+ * Candidate pairs come from the spatial index of the actor bounds. A pair of two
+ * changed actors gets tested once, from the actor with the lower slot index.
+ */
+void LayerCollection::find_dirty_contacts(const std::vector<Actor*>& dirty) {
+    sync_actor_grid();
+    m_contact_candidates.clear();
+    for(Actor* actor : dirty) {
+        Uint32 own_index = actor->get_handle().index;
+        m_actor_grid.query(collision_bounds(*actor), [&](Uint32 index) {
+            if(index == own_index || index >= m_contact_entries.size()) {return;}
+            const ContactEntry& entry = m_contact_entries[index];
+            if(entry.seen != m_contact_pass || entry.handle != m_actor_grid_entries[index].handle) {return;}
+            if(entry.dirty && index < own_index) {return;}
+            if(!actor->can_collide(entry.category, entry.mask)) {return;}
+            m_contact_candidates.emplace_back(actor, m_actor_slots.get(entry.handle));
+        });
     }
-    return false;
-}
+    if(m_contact_candidates.empty()) {return;}
 
-/// Erase the actor from object layer
-bool LayerCollection::erase_actor(Actor* pointer) {
-    for(ObjectLayer* l : get_object_layers()) {
-        if(l->erase_actor(pointer)) {
-            return true;
+    const unsigned min_chunk_size = 32;
+    unsigned chunk_size = std::max(min_chunk_size, static_cast<unsigned>(m_contact_candidates.size()) / (get_thread_pool().get_thread_count() * 4));
+    unsigned chunks = (m_contact_candidates.size() + chunk_size - 1) / chunk_size;
+
+    m_new_contacts.resize(chunks);
+    get_thread_pool().run(chunks, [&](unsigned chunk) {
+        std::vector<ActorContact>& found = m_new_contacts[chunk];
+        found.clear();
+        unsigned to = std::min<unsigned>((chunk + 1) * chunk_size, m_contact_candidates.size());
+        for(unsigned i = chunk * chunk_size; i < to; i++) {
+            const Actor* a = m_contact_candidates[i].first;
+            const Actor* b = m_contact_candidates[i].second;
+            if(a->get_handle().index > b->get_handle().index) {std::swap(a, b);}
+            for(const auto& first : a->get_hitboxes()) {
+                for(const auto& second : b->get_hitboxes()) {
+                    if(first.rect.has_intersection(second.rect)) {
+                        Rect contact = first.rect.get_intersection(second.rect);
+                        if(!a->pixels_overlap(contact, *b)) {continue;}
+                        found.push_back({a->get_handle(), b->get_handle(), first.id, second.id, contact});
+                    }
+                }
+            }
         }
+    });
+
+    std::size_t carried = m_contacts.size();
+    for(const std::vector<ActorContact>& found : m_new_contacts) {
+        m_contacts.insert(m_contacts.end(), found.begin(), found.end());
     }
-    return false;
+    std::sort(m_contacts.begin() + carried, m_contacts.end(), contact_order<ActorContact>);
+    std::inplace_merge(m_contacts.begin(), m_contacts.begin() + carried, m_contacts.end(), contact_order<ActorContact>);
 }
 
-/// Erase the actor from object layer
-bool LayerCollection::erase_actor(std::string name) {
-    for(ObjectLayer* l : get_object_layers()) {
-        if(l->erase_actor(name)) {
-            return true;
+/// Recomputes the tile contacts of the given actors in chunks on the thread pool
+void LayerCollection::find_tile_contacts(const std::vector<Actor*>& actors, const std::vector<MapLayer*>& map_layers) {
+    if(actors.empty()) {return;}
+    const unsigned min_chunk_size = 8;
+    unsigned chunk_size = std::max(min_chunk_size, static_cast<unsigned>(actors.size()) / (get_thread_pool().get_thread_count() * 4));
+    unsigned chunks = (actors.size() + chunk_size - 1) / chunk_size;
+
+    // Each actor only writes to its own entry
+    get_thread_pool().run(chunks, [&](unsigned chunk) {
+        unsigned to = std::min<unsigned>((chunk + 1) * chunk_size, actors.size());
+        for(unsigned i = chunk * chunk_size; i < to; i++) {
+            Actor* actor = actors[i];
+            ContactEntry& entry = m_contact_entries[actor->get_handle().index];
+            entry.tiles.clear();
+            entry.animated_tiles = false;
+            Rect bounds = actor->get_transform().to_bounding_box();
+            for(MapLayer* layer : map_layers) {
+                if(!actor->can_collide(layer->get_collision_category(), layer->get_collision_mask())) {continue;}
+                layer->for_each_collision_cell(bounds, [actor, &entry](const TileCollisionGrid::Cell& tile) {
+                    entry.animated_tiles = entry.animated_tiles || tile.animated;
+                    actor->collect_collisions(tile, entry.tiles);
+                });
+            }
         }
-    }
-    return false;
+    });
+}
+
+/// Erase the actor from its object layer, the pointer has to refer to an actor stored in this collection
+bool LayerCollection::erase_actor(Actor* pointer) {
+    if(pointer == nullptr || pointer->get_object_layer() == nullptr) {return false;}
+    return pointer->get_object_layer()->erase_actor(pointer);
+}
+
+/// Erase the first actor with the given name from its object layer
+bool LayerCollection::erase_actor(const std::string& name) {
+    return erase_actor(get_actor(name));
 }
 
 /// Return layer with the given name
-Layer* LayerCollection::get_layer(std::string name) {
-    for(auto& l : m_layers) {
-        if(l->get_name() == name) {
-            return l.get();
-        }
-    }
-    return nullptr;
+Layer* LayerCollection::get_layer(const std::string& name) {
+    auto it = m_layer_names.find(name);
+    return (it == m_layer_names.end()) ? nullptr : it->second;
+}
+
+/// Returns the thread pool which the game shares between all maps
+ThreadPool& LayerCollection::get_thread_pool() {
+    return m_base_map->get_game().get_thread_pool();
 }
 
 /**
@@ -251,27 +516,180 @@ void LayerCollection::mouse_collision() {
     MouseState mouse = m_base_map->get_game().get_input_cache().get_mouse_state();
     PixelPoint click{round(mouse.x_pos + cam.x), round(mouse.y_pos + cam.y)};
 
-    // Fetch all currently visible actors
-    std::vector<Actor*> actors;
-    auto layers = get_object_layers();
-    for(ObjectLayer* layer : layers) {
-        std::vector<Actor*> temp = layer->get_clip(cam);
-        actors.insert(actors.end(),temp.begin(),temp.end());
+    std::vector<QueryHit> hits;
+    query(Point{static_cast<float>(click.x), static_cast<float>(click.y)}, Collidees::actor, {}, "", hits);
+    for(const QueryHit& hit : hits) {
+        if(hit.actor->is_paused()) {continue;}
+        // Trigger the OnMouse response
+        hit.actor->add_collision(CollisionRecord::make_mouse(hit.hitbox, Rect(click.x, click.y, 1, 1)));
     }
+}
 
-    // Check all hitboxes of each actor if they intersect with the mouse cursor
-    for(Actor* a : actors) {
-        for(std::pair<std::string, Rect> hitbox : a->get_hitboxes()) {
-            PixelRect rect = hitbox.second;
-            if(rect.has_intersection(click)) {
-                // Trigger the OnMouse response
-                // a->respond(Response::on_mouse, Collision(hitbox.first));
-                a->add_collision(Collision(hitbox.first));
+/**
+ * @brief Brings the spatial index of all actors up to date
+ *
+ * Only actors whose slot or transform changed since the last sync get reinserted,
+ * erased actors get dropped from the index.
+ */
+void LayerCollection::sync_actor_grid() {
+    m_actor_grid_pass++;
+    for(ObjectLayer* layer : m_object_layers) {
+        layer->for_each_actor([this](Actor* actor) {
+            ActorHandle handle = actor->get_handle();
+            if(handle.index >= m_actor_grid_entries.size()) {m_actor_grid_entries.resize(handle.index + 1);}
+            GridEntry& entry = m_actor_grid_entries[handle.index];
+            unsigned revision = actor->get_transform().get_revision();
+            unsigned hitbox_generation = actor->get_hitbox_generation();
+            if(entry.handle != handle || entry.revision != revision || entry.hitbox_generation != hitbox_generation || !m_actor_grid.contains(handle.index)) {
+                m_actor_grid.insert(handle.index, collision_bounds(*actor));
+                entry.handle = handle;
+                entry.revision = revision;
+                entry.hitbox_generation = hitbox_generation;
             }
+            entry.seen = m_actor_grid_pass;
+        });
+    }
+    for(Uint32 i = 0; i < m_actor_grid_entries.size(); i++) {
+        if(m_actor_grid_entries[i].seen != m_actor_grid_pass && m_actor_grid.contains(i)) {
+            m_actor_grid.erase(i);
+            m_actor_grid_entries[i] = GridEntry();
         }
     }
 }
 
+/**
+ * @brief Finds the first hitbox hit by a ray
+ * @param origin The start of the ray
+ * @param delta The ray vector, the ray ends at origin + delta
+ * @param target Enum value which tells if to check against tiles, actors or both
+ * @param hitboxes The hitbox ids to check against, all hitboxes if empty
+ * @param tile_type Only tiles of this type get hit, any tile if empty
+ * @param hit Gets set to the first hit
+ * @param ignore An actor which never gets hit, usually the one casting the ray
+ * @return true if anything got hit
+ *
+ * A ray starting within a hitbox hits it at fraction zero. Tiles are found via the collision
+ * grid of each map layer, actors via a spatial index of their bounding boxes.
+ */
+bool LayerCollection::raycast(Point origin, Point delta, Collidees target, const std::vector<HitboxId>& hitboxes,
+                              const std::string& tile_type, QueryHit& hit, const Actor* ignore) {
+    hit = QueryHit();
+    bool found = false;
+    int type_id = m_base_map->get_ts_collection().find_tile_type(tile_type);
+    if((target == Collidees::tile || target == Collidees::tile_and_actor) && type_id >= 0) {
+        for(MapLayer* map : m_map_layers) {
+            map->for_each_collision_cell_on_ray(origin, delta, [&](const TileCollisionGrid::Cell& cell) {
+                if(type_id == 0 || cell.tile->get_type_id() == type_id) {
+                    for(const auto& hitbox : cell.hitboxes) {
+                        if(!match_hitbox(hitbox.id, hitboxes)) {continue;}
+                        if(ray_hit(origin, delta, hitbox.rect, hit.fraction, hit.normal)) {
+                            found = true;
+                            hit.tile = cell;
+                            hit.hitbox = hitbox.id;
+                            hit.rect = hitbox.rect;
+                        }
+                    }
+                }
+                return hit.fraction;
+            });
+        }
+    }
+    if(target == Collidees::actor || target == Collidees::tile_and_actor) {
+        sync_actor_grid();
+        m_actor_grid.query_ray(origin, delta, [&](Uint32 index) {
+            Actor* actor = m_actor_slots.get(m_actor_grid_entries[index].handle);
+            if(actor != nullptr && actor != ignore) {
+                for(const auto& hitbox : actor->get_hitboxes()) {
+                    if(!match_hitbox(hitbox.id, hitboxes)) {continue;}
+                    if(ray_hit(origin, delta, hitbox.rect, hit.fraction, hit.normal)) {
+                        found = true;
+                        hit.actor = actor;
+                        hit.hitbox = hitbox.id;
+                        hit.rect = hitbox.rect;
+                    }
+                }
+            }
+            return hit.fraction;
+        });
+    }
+    return found;
+}
+
+/**
+ * @brief Collects the hitboxes within bounds which pass test
+ *
+ * Tiles come first, in layer order. The tile type filter doesn't apply to actors.
+ */
+template<typename Test>
+bool LayerCollection::query_with(const Rect& bounds, Collidees target, const std::vector<HitboxId>& hitboxes,
+                                 const std::string& tile_type, std::vector<QueryHit>& hits, bool first_only, Test test) {
+    bool found = false;
+    QueryHit hit;
+    hit.fraction = 0.0f;
+    int type_id = m_base_map->get_ts_collection().find_tile_type(tile_type);
+    if((target == Collidees::tile || target == Collidees::tile_and_actor) && type_id >= 0) {
+        for(MapLayer* map : m_map_layers) {
+            map->for_each_collision_cell(bounds, [&](const TileCollisionGrid::Cell& cell) {
+                if(first_only && found) {return;}
+                if(type_id != 0 && cell.tile->get_type_id() != type_id) {return;}
+                for(const auto& hitbox : cell.hitboxes) {
+                    if(!match_hitbox(hitbox.id, hitboxes) || !test(hitbox.rect)) {continue;}
+                    found = true;
+                    hit.tile = cell;
+                    hit.hitbox = hitbox.id;
+                    hit.rect = hitbox.rect;
+                    hits.push_back(hit);
+                    if(first_only) {return;}
+                }
+            });
+        }
+    }
+    if((target == Collidees::actor || target == Collidees::tile_and_actor) && !(first_only && found)) {
+        hit.tile = TileCollisionGrid::Cell();
+        sync_actor_grid();
+        m_actor_grid.query(bounds, [&](Uint32 index) {
+            if(first_only && found) {return;}
+            Actor* actor = m_actor_slots.get(m_actor_grid_entries[index].handle);
+            if(actor == nullptr) {return;}
+            for(const auto& hitbox : actor->get_hitboxes()) {
+                if(!match_hitbox(hitbox.id, hitboxes) || !test(hitbox.rect)) {continue;}
+                found = true;
+                hit.actor = actor;
+                hit.hitbox = hitbox.id;
+                hit.rect = hitbox.rect;
+                hits.push_back(hit);
+                if(first_only) {return;}
+            }
+        });
+    }
+    return found;
+}
+
+/**
+ * @brief Appends all hitboxes which intersect area to hits
+ * @param area The area to check
+ * @param target Enum value which tells if to check against tiles, actors or both
+ * @param hitboxes The hitbox ids to check against, all hitboxes if empty
+ * @param tile_type Only tiles of this type are found, any tile if empty
+ * @param hits Gets the found hitboxes appended, tiles first
+ * @param first_only Stop at the first found hitbox
+ * @return true if any hitbox got found
+ */
+bool LayerCollection::query(const Rect& area, Collidees target, const std::vector<HitboxId>& hitboxes,
+                            const std::string& tile_type, std::vector<QueryHit>& hits, bool first_only) {
+    return query_with(area, target, hitboxes, tile_type, hits, first_only, [&area](const Rect& rect) {
+        return area.has_intersection(rect);
+    });
+}
+
+/// Appends all hitboxes which contain point to hits, see query()
+bool LayerCollection::query(Point point, Collidees target, const std::vector<HitboxId>& hitboxes,
+                            const std::string& tile_type, std::vector<QueryHit>& hits, bool first_only) {
+    return query_with(Rect(point.x, point.y, 0, 0), target, hitboxes, tile_type, hits, first_only, [point](const Rect& rect) {
+        return rect.has_intersection(point);
+    });
+}
+
 /**
  * @brief Tests if hitbox collides with specified targets hitboxes
  * @param rect The box to check collision for
@@ -283,18 +701,20 @@ bool LayerCollection::check_collision(Rect rect, Collidees target, const std::ve
     bool collided = false;
     if(target == Collidees::tile || target == Collidees::tile_and_actor) {
         for(MapLayer* map : get_map_layers()) {
-            for(TileInstance& tile : map->get_clip(rect)) {
-                for(std::string hitbox_name : other_hitboxes) {
-                    Rect other_rect = tile.get_hitbox(hitbox_name);
+            map->for_each_collision_cell(rect, [&](const TileCollisionGrid::Cell& tile) {
+                for(const std::string& hitbox_name : other_hitboxes) {
+                    int id = HitboxSet::find_id(hitbox_name);
+                    if(id < 0) {continue;}
+                    Rect other_rect = tile.hitboxes.get(static_cast<HitboxId>(id));
                     if(rect.has_intersection(other_rect)) {collided = true;}
                 }
-            }
+            });
         }
     }
     if(target == Collidees::actor || target == Collidees::tile_and_actor) {
         for(ObjectLayer* obj : get_object_layers()) {
             for(Actor* actor : obj->get_clip(rect)) {
-                for(std::string hitbox_name : other_hitboxes) {
+                for(const std::string& hitbox_name : other_hitboxes) {
                     Rect other_rect = actor->get_hitbox(hitbox_name);
                     if(rect.has_intersection(other_rect)) {collided = true;}
                 }
@@ -21,9 +21,21 @@
 
 #include <vector>
 #include <memory>
+#include <string>
+#include <unordered_map>
 #include <tinyxml2.h>
 
+#include "actor/actor.hpp"
+#include "actor/collision_stream.hpp"
+#include "map/activity_regions.hpp"
+#include "map/actor_index.hpp"
+#include "map/tile_collision_grid.hpp"
+#include "map/trigger_regions.hpp"
 #include "util/game_types.hpp"
+#include "util/hitbox_batch.hpp"
+#include "util/slot_map.hpp"
+#include "util/spatial_hash.hpp"
+#include "util/thread_pool.hpp"
 
 namespace salmon {
 
@@ -31,13 +43,22 @@ class Camera;
 
 namespace internal {
 
-class Actor;
 class Layer;
 class MapData;
 class MapLayer;
 class ObjectLayer;
 class ImageLayer;
 
+/// A hitbox found by LayerCollection::raycast() or LayerCollection::query()
+struct QueryHit {
+    float fraction = 1.0f; ///< Position of the hit along the ray, zero for area queries
+    Point normal; ///< Surface normal at the hit, zero for area queries
+    Actor* actor = nullptr; ///< The actor which got hit or nullptr if it is a tile
+    TileCollisionGrid::Cell tile; ///< The tile which got hit if there is no actor
+    HitboxId hitbox = 0;
+    Rect rect; ///< The hitbox in world coordinates
+};
+
 /**
  * @brief Container for all possible map layers. Inits, updates, draws and deletes layers.
  */
@@ -51,21 +72,38 @@ class LayerCollection {
         void update();
 
         std::vector<Actor*> get_actors();
-        std::vector<Actor*> get_actors(std::string name);
-        Actor* get_actor(std::string name);
-        bool check_actor(const Actor* actor);
-        bool erase_actor(std::string name);
+        std::vector<Actor*> get_actors(const std::string& name);
+        std::vector<Actor*> get_actors_of_type(const std::string& type);
+        Actor* get_actor(const std::string& name);
+        Actor* get_actor(ActorHandle handle) {return m_actor_slots.get(handle);}
+        bool check_actor(ActorHandle handle) const {return m_actor_slots.valid(handle);}
+        bool erase_actor(const std::string& name);
         bool erase_actor(Actor* pointer);
 
+        // Maintenance of the name and type indexes, called by ObjectLayer and Actor
+        void index_actor(const Actor& actor);
+        void unindex_actor(const Actor& actor);
+        const std::vector<ActorHandle>& find_actors(const std::string& name) const {return m_actor_names.find(name);}
+        bool comes_before(const Actor& a, const Actor& b) const;
+
         bool check_collision(Rect rect, Collidees target, const std::vector<std::string>& other_hitboxes);
 
-        std::vector<MapLayer*> get_map_layers();
-        std::vector<ImageLayer*> get_image_layers();
-        std::vector<ObjectLayer*> get_object_layers();
+        // Spatial queries
+        bool raycast(Point origin, Point delta, Collidees target, const std::vector<HitboxId>& hitboxes, const std::string& tile_type, QueryHit& hit, const Actor* ignore = nullptr);
+        bool query(const Rect& area, Collidees target, const std::vector<HitboxId>& hitboxes, const std::string& tile_type, std::vector<QueryHit>& hits, bool first_only = false);
+        bool query(Point point, Collidees target, const std::vector<HitboxId>& hitboxes, const std::string& tile_type, std::vector<QueryHit>& hits, bool first_only = false);
+
+        const std::vector<MapLayer*>& get_map_layers() const {return m_map_layers;}
+        const std::vector<ImageLayer*>& get_image_layers() const {return m_image_layers;}
+        const std::vector<ObjectLayer*>& get_object_layers() const {return m_object_layers;}
 
-        Layer* get_layer(std::string name);
+        Layer* get_layer(const std::string& name);
 
         MapData& get_base_map() {return *m_base_map;}
+        SlotMap<Actor>& get_actor_slots() {return m_actor_slots;}
+        ThreadPool& get_thread_pool();
+        TriggerRegions& get_triggers() {return m_triggers;}
+        ActivityRegions& get_activity() {return m_activity;}
 
         // Don't allow copy construction and assignment because our destructor would delete twice!
         LayerCollection(const LayerCollection& other) = delete;
@@ -77,9 +115,68 @@ class LayerCollection {
     private:
         void mouse_collision();
         void collision_check();
+        void find_all_contacts(const std::vector<Actor*>& actors);
+        void find_dirty_contacts(const std::vector<Actor*>& dirty);
+        void find_tile_contacts(const std::vector<Actor*>& actors, const std::vector<MapLayer*>& map_layers);
+        void sync_actor_grid();
+        template<typename Test>
+        bool query_with(const Rect& bounds, Collidees target, const std::vector<HitboxId>& hitboxes, const std::string& tile_type, std::vector<QueryHit>& hits, bool first_only, Test test);
+
+        /// State at which an actor got stored in m_actor_grid
+        struct GridEntry {
+            ActorHandle handle;
+            unsigned revision = 0;
+            unsigned hitbox_generation = 0;
+            unsigned seen = 0; ///< Sync pass which found the actor last
+        };
+
+        /// Overlap of two actor hitboxes, kept until one of the actors changes
+        struct ActorContact {
+            ActorHandle first; ///< The actor with the lower slot index
+            ActorHandle second;
+            HitboxId first_hitbox;
+            HitboxId second_hitbox;
+            Rect rect; ///< Intersection of both hitboxes
+        };
+
+        /// Collision state of an actor at the last collision_check()
+        struct ContactEntry {
+            ActorHandle handle;
+            unsigned hitbox_generation = 0;
+            Uint32 category = 0;
+            Uint32 mask = 0;
+            unsigned seen = 0; ///< Pass which found the actor taking part last
+            bool dirty = true; ///< Contacts of the actor get recomputed in this pass
+            bool animated_tiles = false; ///< Overlaps animated tiles, so its tile contacts get recomputed each pass
+            std::vector<PendingCollision> tiles; ///< Collisions with tiles
+        };
 
         MapData* m_base_map;
+        SlotMap<Actor> m_actor_slots; ///< Storage of the actors of all object layers, outlives m_layers
+        TriggerRegions m_triggers; ///< Trigger regions of all object layers
+        ActivityRegions m_activity; ///< Decides which actors sleep
+        ActorIndex m_actor_names; ///< Actors by name, outlives m_layers
+        ActorIndex m_actor_types; ///< Actors by template type, outlives m_layers
+        std::unordered_map<std::string, Layer*> m_layer_names; ///< First layer of each name
         std::vector<std::unique_ptr<Layer>> m_layers;
+        // Views of m_layers by type, in the same order
+        std::vector<MapLayer*> m_map_layers;
+        std::vector<ImageLayer*> m_image_layers;
+        std::vector<ObjectLayer*> m_object_layers;
+
+        HitboxBatch m_actor_hitboxes; ///< Hitboxes of all colliding actors, used when most of them changed
+        std::vector<unsigned> m_actor_hitbox_start; ///< Index of the first hitbox of each actor within m_actor_hitboxes
+
+        std::vector<ContactEntry> m_contact_entries; ///< By slot index
+        std::vector<ActorContact> m_contacts; ///< Sorted by slot indices, then hitbox ids
+        std::vector<std::vector<ActorContact> > m_new_contacts; ///< One buffer per narrowphase task
+        std::vector<std::pair<Actor*, Actor*> > m_contact_candidates; ///< Actor pairs whose bounds overlap
+        std::vector<unsigned> m_tile_layer_state; ///< Revision and filter of each colliding map layer
+        unsigned m_contact_pass = 0;
+
+        SpatialHash m_actor_grid; ///< Bounds of the transform and hitboxes of all actors by slot index, synced before each query
+        std::vector<GridEntry> m_actor_grid_entries; ///< By slot index
+        unsigned m_actor_grid_pass = 0;
 };
 }} // namespace salmon::internal
 
@@ -70,6 +70,26 @@ tinyxml2::XMLError MapLayer::init(tinyxml2::XMLElement* source) {
     if(eResult != XML_SUCCESS) offsety = 0;
 
     m_transform.set_pos(offsetx,offsety);
+
+    // Parse collision filter bits, Tiled stores ints signed so -1 sets all bits
+    XMLElement* p_properties = source->FirstChildElement("properties");
+    if(p_properties != nullptr) {
+        for(XMLElement* p_property = p_properties->FirstChildElement("property"); p_property != nullptr; p_property = p_property->NextSiblingElement("property")) {
+            const char* p_name = p_property->Attribute("name");
+            if(p_name == nullptr) return XML_ERROR_PARSING_ATTRIBUTE;
+            std::string name(p_name);
+            if(name != "COLLISION_CATEGORY" && name != "COLLISION_MASK") {continue;}
+            int bits;
+            eResult = p_property->QueryIntAttribute("value", &bits);
+            if(eResult != XML_SUCCESS) {
+                Logger(Logger::error) << "Failed parsing the " << name << " property of map layer " << m_name;
+                return eResult;
+            }
+            if(name == "COLLISION_CATEGORY") {m_collision_category = static_cast<Uint32>(bits);}
+            else {m_collision_mask = static_cast<Uint32>(bits);}
+        }
+    }
+
     // Parse actual map data
     XMLElement* p_data = source->FirstChildElement("data");
     if(p_data == nullptr) return XML_ERROR_PARSING_ELEMENT;
@@ -157,6 +177,9 @@ tinyxml2::XMLError MapLayer::init(tinyxml2::XMLElement* source) {
         return XML_ERROR_PARSING_ATTRIBUTE;
     }
 
+    m_collision_grid.init(m_map_grid, *m_ts_collection, m_layer_collection->get_base_map());
+    m_query_grid.init(m_map_grid, *m_ts_collection, m_layer_collection->get_base_map());
+
     return XML_SUCCESS;
 }
 
@@ -212,41 +235,10 @@ std::vector<TileInstance> MapLayer::get_clip(Rect rect) const {
     float x_decimals = round(rect.x - p.x) - (rect.x - p.x);
     float y_decimals = round(rect.y - p.y) - (rect.y - p.y);
 
-    const Uint32 FLIPPED_HORIZONTALLY_FLAG = 0x80000000;
-    const Uint32 FLIPPED_VERTICALLY_FLAG   = 0x40000000;
-    const Uint32 FLIPPED_DIAGONALLY_FLAG   = 0x20000000;
-
     for(std::tuple<Uint32, int, int> tile : old) {
         Uint32 tile_id = std::get<0>(tile);
         Tile* tile_p = m_ts_collection->get_tile(tile_id);
-
-        Transform trans = {x_decimals + std::get<1>(tile)+rect.x,
-                           y_decimals + std::get<2>(tile)+rect.y,
-                           static_cast<float>(tile_p->get_w()),
-                           static_cast<float>(tile_p->get_h()),
-                           0,0};
-        trans.set_rotation_center(0.5,0.5);
-        if(tile_id >= FLIPPED_DIAGONALLY_FLAG) {
-            // Read out flags
-            bool flipped_horizontally = (tile_id & FLIPPED_HORIZONTALLY_FLAG);
-            bool flipped_vertically = (tile_id & FLIPPED_VERTICALLY_FLAG);
-            bool flipped_diagonally = (tile_id & FLIPPED_DIAGONALLY_FLAG);
-            double angle = 0;
-            // This snippet was determined via trial and error
-            // I have no idea why this even works, but it does
-            if(flipped_diagonally) {
-                angle = 270;
-                if(flipped_horizontally == flipped_vertically) {
-                    angle = 90;
-                }
-                flipped_vertically = !flipped_vertically;
-            }
-            trans.set_h_flip(flipped_horizontally);
-            trans.set_v_flip(flipped_vertically);
-            trans.set_rotation(angle);
-        }
-
-        tiles.push_back({tile_p,trans});
+        tiles.emplace_back(tile_p, tile_id, x_decimals + std::get<1>(tile) + rect.x, y_decimals + std::get<2>(tile) + rect.y);
     }
     return tiles;
 }
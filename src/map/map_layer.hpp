@@ -27,6 +27,8 @@
 
 #include "map/layer.hpp"
 #include "map/tile.hpp"
+#include "map/tile_collision_grid.hpp"
+#include "map/tile_query_grid.hpp"
 
 namespace salmon { namespace internal {
 
@@ -43,6 +45,47 @@ class MapLayer : public Layer{
         std::vector< std::tuple<Uint32, int, int> > clip(Rect rect) const;
         std::vector<TileInstance> get_clip(Rect rect) const;
 
+        /// Calls f with each tile cell whose hitboxes may intersect rect, see TileCollisionGrid::for_each()
+        template<typename Function>
+        void for_each_collision_cell(const Rect& rect, Function f) const {
+            m_collision_grid.for_each(rect, m_transform.get_relative(0,0), f);
+        }
+        /// Calls f with each tile cell which may be hit by rect moving along motion, see TileCollisionGrid::for_each_along()
+        template<typename Function>
+        void for_each_collision_cell_along(const Rect& rect, Point motion, Function f) const {
+            m_collision_grid.for_each_along(rect, motion, m_transform.get_relative(0,0), f);
+        }
+        /// Calls f with each tile cell which may be hit by a ray, see TileCollisionGrid::for_each_on_ray()
+        template<typename Function>
+        void for_each_collision_cell_on_ray(Point origin, Point delta, Function f) const {
+            m_collision_grid.for_each_on_ray(origin, delta, m_transform.get_relative(0,0), f);
+        }
+
+        unsigned get_width() const {return m_width;} ///< Return width in tiles
+        unsigned get_height() const {return m_height;} ///< Return height in tiles
+        /// Return the global tile id including flip flags at the given cell, zero if empty
+        Uint32 get_tile_id(unsigned x, unsigned y) const {
+            return (y < m_map_grid.size() && x < m_map_grid[y].size()) ? m_map_grid[y][x] : 0;
+        }
+        const TilesetCollection& get_ts_collection() const {return *m_ts_collection;}
+
+        /// Return the interned type of the tile at the world position, zero if there is none
+        TileTypeId get_tile_type_at(Point pos) const {return m_query_grid.get_type(to_local(pos));}
+        /// Return the boolean properties of the tile at the world position
+        TileFlags get_tile_flags_at(Point pos) const {return m_query_grid.get_flags(to_local(pos));}
+        /// Return the union of the boolean properties of all tiles overlapping the world area
+        TileFlags get_tile_flags_in(const Rect& area) const {return m_query_grid.get_flags(to_local(area));}
+        /// Return true if a tile of the type overlaps the world area
+        bool has_tile_type_in(const Rect& area, TileTypeId type) const {return m_query_grid.has_type(to_local(area), type);}
+
+        /// Return true if any tile of this layer has hitboxes
+        bool has_collisions() const {return !m_collision_grid.empty();}
+        // Collision filtering of the tiles in this layer, see Actor::can_collide()
+        Uint32 get_collision_category() const {return m_collision_category;}
+        Uint32 get_collision_mask() const {return m_collision_mask;}
+        void set_collision_category(Uint32 category) {m_collision_category = category;}
+        void set_collision_mask(Uint32 mask) {m_collision_mask = mask;}
+
         LayerType get_type() override {return LayerType::map;}
 
         static MapLayer* parse(tinyxml2::XMLElement* source, std::string name, LayerCollection* layer_collection, tinyxml2::XMLError& eresult);
@@ -62,6 +105,15 @@ class MapLayer : public Layer{
         std::vector< std::tuple<Uint32, int, int> > clip_ortho(Rect rect) const;
         std::vector< std::tuple<Uint32, int, int> > clip_y_stagger(Rect rect) const;
         std::vector< std::tuple<Uint32, int, int> > clip_x_stagger(Rect rect) const;
+        Point to_local(Point pos) const {
+            Point origin = m_transform.get_relative(0,0);
+            return {pos.x - origin.x, pos.y - origin.y};
+        }
+        Rect to_local(const Rect& rect) const {
+            Point origin = m_transform.get_relative(0,0);
+            return {rect.x - origin.x, rect.y - origin.y, rect.w, rect.h};
+        }
+
         void calc_tile_range(Rect src_rect, int tile_w, int tile_h, int& x_from, int& x_to, int& y_from, int& y_to, int& x_start, int& y_start) const;
 
         TilesetCollection* m_ts_collection;
@@ -69,6 +121,11 @@ class MapLayer : public Layer{
         unsigned m_height;
 
         std::vector<std::vector<Uint32> > m_map_grid; ///< The actual map layer information
+        TileCollisionGrid m_collision_grid; ///< Precomputed tile hitboxes of m_map_grid
+        TileQueryGrid m_query_grid; ///< Tile types and boolean tile properties of m_map_grid
+
+        Uint32 m_collision_category = 1; ///< Category bits, set by COLLISION_CATEGORY
+        Uint32 m_collision_mask = 0xFFFFFFFF; ///< Categories to collide with, set by COLLISION_MASK
 };
 }} // namespace salmon::internal
 
@@ -29,6 +29,7 @@
 #include "map/tileset.hpp"
 #include "map/layer.hpp"
 #include "util/parse.hpp"
+#include "util/thread_pool.hpp"
 #include "util/attribute_parser.hpp"
 #include "util/logger.hpp"
 
@@ -36,7 +37,9 @@ namespace salmon { namespace internal {
 
 /// Plain constructor
 MapData::MapData(GameInfo* game) : m_game{game},
-m_camera{{0, 0, 0, 0}} {}
+m_camera{{0, 0, 0, 0}} {
+    m_anim_states.intern(AnimationType::none);
+}
 
 /**
  * @brief Parses the supplied .tmx file
@@ -90,6 +93,9 @@ tinyxml2::XMLError MapData::init_map(std::string filename, SDL_Renderer** render
         return eResult;
     }
 
+    // Start the map clock, which animated tiles and actor templates get initialized with
+    m_last_update = SDL_GetTicks();
+
     /// @note First parse tilesets, then layers, because layers depend on tileset information
     // This initiates the parsing of all tilesets
     eResult = m_ts_collection.init(pMap, this);
@@ -107,6 +113,9 @@ tinyxml2::XMLError MapData::init_map(std::string filename, SDL_Renderer** render
         }
     }
 
+    // Templates are complete now, so the pooled copies share their tiles
+    fill_actor_pools();
+
     // Get the first layer of three possible layer types
     std::string l = "layer";
     std::string i = "imagelayer";
@@ -125,6 +134,24 @@ tinyxml2::XMLError MapData::init_map(std::string filename, SDL_Renderer** render
         return eResult;
     }
 
+    // Derive the navigation grid if the map asks for one
+    m_flow_fields.clear();
+    std::string nav_hitbox = m_data.check_val_string("NAV_HITBOX") ? m_data.get_val_string("NAV_HITBOX") : "";
+    std::string nav_tile_type = m_data.check_val_string("NAV_TILE_TYPE") ? m_data.get_val_string("NAV_TILE_TYPE") : "";
+    if(!nav_hitbox.empty() || !nav_tile_type.empty()) {
+        build_nav_grid(nav_hitbox, nav_tile_type);
+    }
+    else {
+        m_nav_grid.clear();
+    }
+
+    // Let actors far from the camera sleep if the map asks for it
+    ActivityRegions& activity = m_layer_collection.get_activity();
+    activity.clear();
+    if(m_data.check_val_float("ACTIVITY_MARGIN")) {activity.set_margin(m_data.get_val_float("ACTIVITY_MARGIN"));}
+    else if(m_data.check_val_int("ACTIVITY_MARGIN")) {activity.set_margin(m_data.get_val_int("ACTIVITY_MARGIN"));}
+    if(m_data.check_val_int("SLEEP_TICK_INTERVAL")) {activity.set_tick_interval(std::max(0, m_data.get_val_int("SLEEP_TICK_INTERVAL")));}
+
     // Initialize last_update timestamp
     m_last_update = SDL_GetTicks();
 
@@ -296,8 +323,18 @@ void MapData::update() {
     //m_delta_time = 1.0f / 60.0f;
     m_last_update = current_time;
 
+    // Discard collisions of the previous frame
+    m_collision_stream.clear();
+
+    // Spawn and despawn actors queued since the last update
+    m_actor_commands.apply(m_layer_collection);
+
     // Checks and changes animated tiles
-    m_ts_collection.push_all_anim();
+    m_ts_collection.push_all_anim(current_time);
+
+    // Follow changes of the navigation grid and continue queued path searches
+    update_flow_fields();
+    m_nav_grid.update();
 
     // Registers inter actor-tile-mouse collision
     m_layer_collection.update();
@@ -354,9 +391,7 @@ void MapData::add_actor_animation(std::string name, std::string anim, Direction
     if(m_actor_templates.find(name) == m_actor_templates.end()) {m_actor_templates.insert(std::make_pair(name, Actor(this)));}
 
     Actor& temp = m_actor_templates.at(name);
-    auto& animations = temp.get_animation_container();
-    animations[anim][dir] = *tile;
-    animations[anim][dir].init_anim();
+    temp.add_animation(register_anim_state(anim), dir, *tile);
 }
 
 /**
@@ -421,8 +456,8 @@ tinyxml2::XMLError MapData::add_actor_template(tinyxml2::XMLElement* source, Til
 }
 
 /// @brief Returns the first actor with the given name
-Actor* MapData::fetch_actor(std::string name) {
-    std::vector<Actor*> actor_list =  m_layer_collection.get_actors(std::string(name));
+Actor* MapData::fetch_actor(const std::string& name) {
+    const std::vector<ActorHandle>& actor_list = m_layer_collection.find_actors(name);
     if(actor_list.size() > 1) {
         // std::cerr << "Error: More than one actor called " << name<< " !\n";;
     }
@@ -430,7 +465,7 @@ Actor* MapData::fetch_actor(std::string name) {
         // std::cerr << "Error: No actor called " << name << " found!\n";
     }
     else {
-        return actor_list[0];
+        return m_layer_collection.get_actor(actor_list[0]);
     }
     return nullptr;
 }
@@ -446,16 +481,128 @@ bool MapData::is_actor(std::string name) const {
 }
 
 /// Return Actor template which was parsed with tile with the given tile ID
-Actor MapData::get_actor(Uint32 gid) const {
+const Actor& MapData::get_actor(Uint32 gid) const {
     return m_actor_templates.at(m_gid_to_actor_temp_name.at(gid));
 }
 
 /// Return Actor template by name
-Actor MapData::get_actor(std::string name) const {
+const Actor& MapData::get_actor(std::string name) const {
     return m_actor_templates.at(name);
 }
 
-Transform* MapData::get_layer_transform(std::string layer_name) {
+/**
+ * @brief Build the navigation grid from all map layers
+ * @param hitbox Tiles with a hitbox of this name are blocking, none if empty
+ * @param tile_type Tiles of this type are blocking, none if empty
+ */
+void MapData::build_nav_grid(const std::string& hitbox, const std::string& tile_type) {
+    m_nav_grid.init(m_layer_collection.get_map_layers(), hitbox, tile_type, *this);
+    if(m_nav_grid.empty()) {
+        Logger(Logger::warning) << "Map has no map layer to build a navigation grid from";
+    }
+}
+
+/**
+ * @brief Create a flow field toward the goals over the navigation grid
+ * @param goals World positions, the field leads to the closest one
+ * @return The id of the field, zero if there is no navigation grid
+ */
+unsigned MapData::add_flow_field(const std::vector<Point>& goals) {
+    if(m_nav_grid.empty()) {
+        Logger(Logger::error) << "Flow fields need a navigation grid, build one first";
+        return 0;
+    }
+    unsigned id = m_next_flow_field++;
+    m_flow_fields[id].init(m_nav_grid, goals, &m_layer_collection.get_thread_pool());
+    return id;
+}
+
+/// Return the flow field with the given id or nullptr if there is none
+FlowField* MapData::get_flow_field(unsigned id) {
+    auto it = m_flow_fields.find(id);
+    return (it == m_flow_fields.end()) ? nullptr : &it->second;
+}
+
+/**
+ * @brief Apply changes of the navigation grid to all flow fields
+ *
+ * A single field spreads its work over the thread pool, several fields get updated in parallel.
+ */
+void MapData::update_flow_fields() {
+    if(m_flow_fields.empty()) {return;}
+    ThreadPool& pool = m_layer_collection.get_thread_pool();
+    if(m_flow_fields.size() == 1) {
+        m_flow_fields.begin()->second.update(&pool);
+        return;
+    }
+    std::vector<FlowField*> fields;
+    fields.reserve(m_flow_fields.size());
+    for(auto& field : m_flow_fields) {fields.push_back(&field.second);}
+    pool.run(fields.size(), [&fields](unsigned i) {fields[i]->update(nullptr);});
+}
+
+/// Construct the pooled actors of all templates which request a pool
+void MapData::fill_actor_pools() {
+    m_actor_pools.clear();
+    for(auto& actor_pair : m_actor_templates) {
+        unsigned size = actor_pair.second.get_pool_size();
+        if(size == 0) {continue;}
+        ActorPool& pool = m_actor_pools[actor_pair.first];
+        pool.source = &actor_pair.second;
+        pool.actors.reserve(size);
+        pool.actors.resize(size, actor_pair.second);
+        pool.stats.capacity = size;
+    }
+}
+
+/**
+ * @brief Returns a new actor of the template with the given name
+ *
+ * If the template has a pool, a preconstructed actor is taken from it.
+ * Otherwise the template gets copied.
+ * The actor remembers the pool, so recycle_actor() finds it even after a type change.
+ */
+Actor MapData::acquire_actor(const std::string& name) {
+    auto it = m_actor_pools.find(name);
+    if(it == m_actor_pools.end()) {return m_actor_templates.at(name);}
+    ActorPool& pool = it->second;
+    if(!pool.actors.empty()) {
+        pool.stats.hits++;
+        Actor actor = std::move(pool.actors.back());
+        pool.actors.pop_back();
+        actor.set_pool(&pool);
+        return actor;
+    }
+    pool.stats.misses++;
+    Actor actor = *pool.source;
+    actor.set_pool(&pool);
+    return actor;
+}
+
+/**
+ * @brief Return an erased actor to the pool of the template it got acquired from
+ *
+ * The actor gets reset to the template state by copying the template, which
+ * shares its tiles and data with the template again.
+ * Actors of templates without pool or with a full pool are left untouched.
+ */
+void MapData::recycle_actor(Actor& actor) {
+    ActorPool* pool = actor.get_pool();
+    if(pool == nullptr || pool->actors.size() >= pool->stats.capacity) {return;}
+    pool->actors.push_back(std::move(actor));
+    pool->actors.back() = *pool->source;
+}
+
+/// Returns the usage counters of the pool of the template, all zero if it has none
+ActorPoolStats MapData::get_actor_pool_stats(const std::string& name) const {
+    auto it = m_actor_pools.find(name);
+    if(it == m_actor_pools.end()) {return ActorPoolStats();}
+    ActorPoolStats stats = it->second.stats;
+    stats.available = it->second.actors.size();
+    return stats;
+}
+
+Transform* MapData::get_layer_transform(const std::string& layer_name) {
     Layer* l = m_layer_collection.get_layer(layer_name);
     if(l == nullptr) {return nullptr;}
     else {return &l->get_transform();}
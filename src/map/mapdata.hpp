@@ -20,15 +20,21 @@
 #define MAPDATA_HPP_INCLUDED
 
 #include <SDL.h>
+#include <map>
 #include <vector>
 #include <string>
 #include <tinyxml2.h>
 
 #include "camera.hpp"
+#include "actor/collision_stream.hpp"
 #include "actor/data_block.hpp"
+#include "map/actor_command_buffer.hpp"
+#include "map/flow_field.hpp"
 #include "map/layer_collection.hpp"
+#include "map/nav_grid.hpp"
 #include "map/tileset_collection.hpp"
 #include "util/game_types.hpp"
+#include "util/symbol_table.hpp"
 
 namespace salmon {
 class Transform;
@@ -38,6 +44,13 @@ class Actor;
 class GameInfo;
 class Tile;
 
+/// Preconstructed copies of an actor template
+struct ActorPool {
+    const Actor* source = nullptr; ///< The template
+    std::vector<Actor> actors;
+    ActorPoolStats stats;
+};
+
 /**
  * @brief Container for the layers, tilesets, additional data, key/event matrix and camera of the map.
  *
@@ -82,30 +95,55 @@ class MapData {
         PixelDimensions get_dimensions() const;
 
         float get_delta_time() const {return m_delta_time;}
+        Uint32 get_ticks() const {return m_last_update;} ///< Return timestamp of the last update
         DataBlock& get_data() {return m_data;}
         GameInfo& get_game() {return *m_game;}
         TilesetCollection& get_ts_collection() {return m_ts_collection;}
         LayerCollection& get_layer_collection() {return m_layer_collection;}
+        CollisionStream& get_collision_stream() {return m_collision_stream;}
+        ActorCommandBuffer& get_actor_commands() {return m_actor_commands;}
+        NavGrid& get_nav_grid() {return m_nav_grid;}
         salmon::Camera& get_camera() {return m_camera;}
         const TileLayout get_tile_layout() {return m_tile_layout;}
 
         // Actor management
         bool is_actor(Uint32 gid) const;
         bool is_actor(std::string name) const;
-        Actor get_actor(Uint32 gid) const;
-        Actor get_actor(std::string name) const;
+        const Actor& get_actor(Uint32 gid) const;
+        const Actor& get_actor(std::string name) const;
+
+        // Pooled actor construction
+        Actor acquire_actor(const std::string& name);
+        void recycle_actor(Actor& actor);
+        ActorPoolStats get_actor_pool_stats(const std::string& name) const;
 
         tinyxml2::XMLError add_actor_template(tinyxml2::XMLElement* source, Tile* tile);
         void add_actor_animation(std::string name, std::string anim, Direction dir, Tile* tile);
 
-        Actor* fetch_actor(std::string name);
+        // Interned animation types
+        unsigned register_anim_state(const std::string& anim) {return m_anim_states.intern(anim);}
+        int get_anim_state(const std::string& anim) const {return m_anim_states.find(anim);}
+        const std::string& get_anim_state_name(unsigned state) const {return m_anim_states.get_name(state);}
+        unsigned get_anim_state_count() const {return m_anim_states.size();}
+
+        Actor* fetch_actor(const std::string& name);
+
+        void build_nav_grid(const std::string& hitbox, const std::string& tile_type);
 
-        Transform* get_layer_transform(std::string layer_name);
+        // Flow fields over the navigation grid
+        unsigned add_flow_field(const std::vector<Point>& goals);
+        FlowField* get_flow_field(unsigned id);
+        bool remove_flow_field(unsigned id) {return m_flow_fields.erase(id) != 0;}
+
+        Transform* get_layer_transform(const std::string& layer_name);
 
     private:
         unsigned get_w() const;
         unsigned get_h() const;
 
+        void fill_actor_pools();
+        void update_flow_fields();
+
         GameInfo* m_game;
 
         std::string m_full_path = ""; ///< Path to tmx file
@@ -115,19 +153,29 @@ class MapData {
         SDL_Color m_bg_color;
 
         DataBlock m_data; ///< This holds custom user values by string
-        Uint32 m_last_update;
+        Uint32 m_last_update = 0;
         float m_delta_time = 0.f;
 
         salmon::Camera m_camera;
 
         LayerCollection m_layer_collection;
 
+        CollisionStream m_collision_stream; ///< Collisions of all actors registered during the current frame
+
+        ActorCommandBuffer m_actor_commands; ///< Spawns and despawns which get applied at the next update
+
+        NavGrid m_nav_grid; ///< Walkability of the map layers, built on demand or at load via NAV_HITBOX and NAV_TILE_TYPE
+        std::map<unsigned, FlowField> m_flow_fields; ///< Fields over m_nav_grid by id
+        unsigned m_next_flow_field = 1;
+
         TileLayout m_tile_layout;
 
         TilesetCollection m_ts_collection;
 
         std::map<std::string, Actor> m_actor_templates; ///< List of all actor templates by name
         std::map<Uint32, std::string> m_gid_to_actor_temp_name; ///< List of actor template names by global tile id
+        std::map<std::string, ActorPool> m_actor_pools; ///< Pools of templates with a POOL_SIZE by template name
+        SymbolTable m_anim_states; ///< Animation types of all actors by id, AnimationType::none is always 0
 
         SDL_Renderer** mpp_renderer = nullptr;
 };
@@ -0,0 +1,537 @@
+/*
+ * Copyright 2017-2020 Agouti Games Team (see the AUTHORS file)
+ *
+ * This file is part of the RawSalmonEngine.
+ *
+ * The RawSalmonEngine is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * The RawSalmonEngine is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with the RawSalmonEngine.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#include "map/nav_grid.hpp"
+
+#include <algorithm>
+#include <cmath>
+
+#include "map/map_layer.hpp"
+#include "map/mapdata.hpp"
+#include "map/tile.hpp"
+#include "map/tileset_collection.hpp"
+#include "util/hitbox_set.hpp"
+
+namespace salmon { namespace internal {
+
+namespace {
+int sign(int value) {return (value > 0) - (value < 0);}
+
+/// Cost of the shortest eight directional path on an empty grid, in cells
+float octile(int dx, int dy) {
+    const float diagonal = 1.41421356f;
+    dx = std::abs(dx);
+    dy = std::abs(dy);
+    return (dx < dy) ? dx * diagonal + (dy - dx) : dy * diagonal + (dx - dy);
+}
+} // namespace
+
+/**
+ * @brief Build the grid from the tiles of map layers
+ * @param layers The map layers to take the tiles from, the first one sets size and position
+ * @param hitbox Tiles with a hitbox of this name are blocking, none if empty
+ * @param tile_type Tiles of this type are blocking, none if empty
+ * @param base_map The map which determines the tile layout
+ */
+void NavGrid::init(const std::vector<MapLayer*>& layers, const std::string& hitbox, const std::string& tile_type, MapData& base_map) {
+    clear();
+    if(layers.empty()) {return;}
+    m_layers = layers;
+    m_hitbox = hitbox.empty() ? -1 : HitboxSet::find_id(hitbox);
+    m_tile_type = tile_type;
+    m_width = layers.front()->get_width();
+    m_height = layers.front()->get_height();
+
+    // Mirror the cell positions used by MapLayer::clip
+    const MapData::TileLayout layout = base_map.get_tile_layout();
+    const TilesetCollection& ts_collection = base_map.get_ts_collection();
+    m_tile_w = static_cast<int>(ts_collection.get_tile_w());
+    m_tile_h = static_cast<int>(ts_collection.get_tile_h());
+    m_step_x = m_tile_w;
+    m_step_y = m_tile_h;
+    m_hexagonal = layout.orientation != "orthogonal";
+    m_stagger_index_odd = layout.stagger_index_odd;
+    if(m_hexagonal) {
+        if(layout.stagger_axis_y) {
+            m_step_y = m_tile_h / 2 + layout.hexsidelength / 2;
+            m_shift_x = m_tile_w / 2;
+        }
+        else {
+            m_step_x = m_tile_w / 2 + layout.hexsidelength / 2;
+            m_shift_y = m_tile_h / 2;
+        }
+    }
+    if(m_step_x <= 0) {m_step_x = 1;}
+    if(m_step_y <= 0) {m_step_y = 1;}
+
+    reset_cells();
+    refresh(0, 0, m_width, m_height);
+    m_generation++;
+    m_changes.clear();
+}
+
+/**
+ * @brief Build a free orthogonal grid which isn't backed by map layers
+ * @param tile_w, tile_h The cell size in pixels, the grid starts at the world origin
+ *
+ * Cells only get blocked through set_blocked(), refresh() frees them again.
+ */
+void NavGrid::init(unsigned width, unsigned height, int tile_w, int tile_h) {
+    clear();
+    m_width = width;
+    m_height = height;
+    m_tile_w = m_step_x = std::max(tile_w, 1);
+    m_tile_h = m_step_y = std::max(tile_h, 1);
+    m_hexagonal = false;
+    reset_cells();
+    m_generation++;
+    m_changes.clear();
+}
+
+/// Allocate the free cells and the search state for the current size
+void NavGrid::reset_cells() {
+    unsigned size = m_width * m_height;
+    m_blocked.assign(size, 0);
+    m_cost.assign(size, 0.0f);
+    m_parent.assign(size, 0);
+    m_opened.assign(size, 0);
+    m_closed.assign(size, 0);
+}
+
+/**
+ * @brief Reevaluate the blocking state of an area from the current tiles
+ *
+ * Changed cells discard cached paths and restart the running search.
+ * @note Overrides cells changed by set_blocked()
+ */
+void NavGrid::refresh(unsigned x, unsigned y, unsigned w, unsigned h) {
+    unsigned x_to = std::min(x + w, m_width);
+    unsigned y_to = std::min(y + h, m_height);
+    for(unsigned i_y = y; i_y < y_to; i_y++) {
+        for(unsigned i_x = x; i_x < x_to; i_x++) {
+            bool blocked = false;
+            for(MapLayer* layer : m_layers) {
+                Uint32 tile_id = layer->get_tile_id(i_x, i_y);
+                if(tile_id != 0 && is_tile_blocking(tile_id, *layer)) {
+                    blocked = true;
+                    break;
+                }
+            }
+            Uint32 cell = i_y * m_width + i_x;
+            if(m_blocked[cell] != blocked) {
+                m_blocked[cell] = blocked;
+                grid_changed(cell);
+            }
+        }
+    }
+}
+
+/// Drop the grid, all requests and cached paths
+void NavGrid::clear() {
+    m_layers.clear();
+    m_tile_blocking.clear();
+    m_width = m_height = 0;
+    m_blocked.clear();
+    m_generation++;
+    m_changes.clear();
+    m_shift_x = m_shift_y = 0;
+    m_cost.clear();
+    m_parent.clear();
+    m_opened.clear();
+    m_closed.clear();
+    m_open.clear();
+    m_stamp = 0;
+    m_searching = false;
+    m_requests.clear();
+    m_results.clear();
+    clear_cache();
+}
+
+/// Returns true if the tile has the blocking hitbox or tile type, memoized per tile id
+bool NavGrid::is_tile_blocking(Uint32 tile_id, const MapLayer& layer) {
+    auto it = m_tile_blocking.find(tile_id);
+    if(it != m_tile_blocking.end()) {return it->second;}
+
+    bool blocking = false;
+    Tile* tile = layer.get_ts_collection().get_tile(tile_id);
+    if(tile != nullptr) {
+        if(!m_tile_type.empty() && tile->get_type() == m_tile_type) {blocking = true;}
+        if(m_hitbox >= 0) {
+            const Rect* rect = tile->get_hitboxes().find(static_cast<HitboxId>(m_hitbox));
+            if(rect != nullptr && !rect->empty()) {blocking = true;}
+        }
+    }
+    m_tile_blocking.emplace(tile_id, blocking);
+    return blocking;
+}
+
+/// Mark a single cell as blocked or walkable, until the next refresh() of that cell
+void NavGrid::set_blocked(unsigned x, unsigned y, bool blocked) {
+    if(x >= m_width || y >= m_height) {return;}
+    Uint32 cell = y * m_width + x;
+    if(m_blocked[cell] == blocked) {return;}
+    m_blocked[cell] = blocked;
+    grid_changed(cell);
+}
+
+/// Invalidate everything derived from the blocking state and log the change
+void NavGrid::grid_changed(Uint32 cell) {
+    clear_cache();
+    m_searching = false;
+    // A log longer than the grid is no help for incremental updates, treat it as a rebuild
+    if(m_changes.size() >= m_blocked.size()) {
+        m_generation++;
+        m_changes.clear();
+    }
+    else {
+        m_changes.push_back(cell);
+    }
+}
+
+void NavGrid::clear_cache() {
+    m_cache.clear();
+    m_cache_order.clear();
+}
+
+/// Returns the position of the upper left corner of the cell relative to the layer
+Point NavGrid::get_cell_origin(int x, int y) const {
+    Point origin{static_cast<float>(x * m_step_x), static_cast<float>(y * m_step_y)};
+    if(m_shift_x != 0 && is_shifted(y)) {origin.x += m_shift_x;}
+    if(m_shift_y != 0 && is_shifted(x)) {origin.y += m_shift_y;}
+    return origin;
+}
+
+/**
+ * @brief Find the cell containing a world position
+ * @return False if the position lies outside of the grid
+ * @note On staggered layouts the overlapping corners of neighbouring cells aren't told apart
+ */
+bool NavGrid::to_cell(Point world, unsigned& x, unsigned& y) const {
+    Point layer_pos = m_layers.empty() ? Point{0, 0} : m_layers.front()->get_transform().get_relative(0,0);
+    float local_x = world.x - layer_pos.x;
+    float local_y = world.y - layer_pos.y;
+    int i_x, i_y;
+    if(m_shift_x != 0) {
+        i_y = static_cast<int>(std::floor(local_y / m_step_y));
+        if(is_shifted(i_y)) {local_x -= m_shift_x;}
+        i_x = static_cast<int>(std::floor(local_x / m_step_x));
+    }
+    else {
+        i_x = static_cast<int>(std::floor(local_x / m_step_x));
+        if(m_shift_y != 0 && is_shifted(i_x)) {local_y -= m_shift_y;}
+        i_y = static_cast<int>(std::floor(local_y / m_step_y));
+    }
+    if(i_x < 0 || i_y < 0 || i_x >= static_cast<int>(m_width) || i_y >= static_cast<int>(m_height)) {return false;}
+    x = i_x;
+    y = i_y;
+    return true;
+}
+
+/// Returns the world position of the center of the cell
+Point NavGrid::to_world(unsigned x, unsigned y) const {
+    Point layer_pos = m_layers.empty() ? Point{0, 0} : m_layers.front()->get_transform().get_relative(0,0);
+    Point origin = get_cell_origin(x, y);
+    return {layer_pos.x + origin.x + m_tile_w / 2.0f, layer_pos.y + origin.y + m_tile_h / 2.0f};
+}
+
+bool NavGrid::to_index(Point world, Uint32& index) const {
+    unsigned x, y;
+    if(!to_cell(world, x, y)) {return false;}
+    index = y * m_width + x;
+    return true;
+}
+
+void NavGrid::to_points(const std::vector<Uint32>& cells, std::vector<Point>& path) const {
+    path.clear();
+    path.reserve(cells.size());
+    for(Uint32 cell : cells) {
+        path.push_back(to_world(cell % m_width, cell / m_width));
+    }
+}
+
+/**
+ * @brief Search a path right away
+ * @param path Gets the cell centers along the path from start to goal
+ *
+ * On orthogonal maps only the turning points of the path are returned,
+ * the straight lines between them are free.
+ * @note Restarts a queued search which was in progress
+ */
+PathStatus NavGrid::find_path(Point from, Point to, std::vector<Point>& path) {
+    path.clear();
+    Uint32 start, goal;
+    if(!to_index(from, start) || !to_index(to, goal)) {return PathStatus::no_path;}
+    m_searching = false;
+    std::vector<Uint32> cells;
+    PathStatus status = begin_search(start, goal, cells);
+    if(status == PathStatus::searching) {status = continue_search(start, goal, 0, cells);}
+    to_points(cells, path);
+    return status;
+}
+
+/**
+ * @brief Queue a path search which runs during the following updates
+ * @param node_budget Maximum count of expanded nodes per update, zero means unlimited
+ * @return The id to fetch the result with get_path()
+ */
+unsigned NavGrid::request_path(Point from, Point to, unsigned node_budget) {
+    unsigned id = m_next_request++;
+    if(m_next_request == 0) {m_next_request = 1;}
+    Request request{id, 0, 0, node_budget};
+    if(!to_index(from, request.start) || !to_index(to, request.goal)) {
+        m_results[id].status = PathStatus::no_path;
+    }
+    else {
+        m_results[id].status = PathStatus::searching;
+        m_requests.push_back(request);
+    }
+    return id;
+}
+
+/**
+ * @brief Fetch the result of a queued search
+ *
+ * Finished results get discarded after fetching them.
+ * @return PathStatus::invalid if there is no such request
+ */
+PathStatus NavGrid::get_path(unsigned request, std::vector<Point>& path) {
+    path.clear();
+    auto it = m_results.find(request);
+    if(it == m_results.end()) {return PathStatus::invalid;}
+    PathStatus status = it->second.status;
+    if(status == PathStatus::searching) {return status;}
+    to_points(it->second.cells, path);
+    m_results.erase(it);
+    return status;
+}
+
+/**
+ * @brief Advance the queued searches
+ *
+ * The first request expands up to its node budget. If it finishes the next one starts.
+ */
+void NavGrid::update() {
+    while(!m_requests.empty()) {
+        const Request& request = m_requests.front();
+        Result& result = m_results[request.id];
+        PathStatus status = PathStatus::searching;
+        if(!m_searching) {
+            status = begin_search(request.start, request.goal, result.cells);
+            m_searching = (status == PathStatus::searching);
+        }
+        if(m_searching) {
+            status = continue_search(request.start, request.goal, request.budget, result.cells);
+        }
+        result.status = status;
+        if(status == PathStatus::searching) {return;}
+        m_searching = false;
+        m_requests.pop_front();
+    }
+}
+
+/**
+ * @brief Resolve trivial searches and cache hits, otherwise reset the search state
+ * @return PathStatus::searching if continue_search() has to run
+ */
+PathStatus NavGrid::begin_search(Uint32 start, Uint32 goal, std::vector<Uint32>& cells) {
+    cells.clear();
+    if(m_blocked[start] || m_blocked[goal]) {return PathStatus::no_path;}
+    if(start == goal) {
+        cells.push_back(start);
+        return PathStatus::found;
+    }
+    auto it = m_cache.find((static_cast<Uint64>(start) << 32) | goal);
+    if(it != m_cache.end()) {
+        cells = it->second;
+        return PathStatus::found;
+    }
+
+    m_stamp++;
+    if(m_stamp == 0) {
+        std::fill(m_opened.begin(), m_opened.end(), 0);
+        std::fill(m_closed.begin(), m_closed.end(), 0);
+        m_stamp = 1;
+    }
+    m_open.clear();
+    open(start, start, 0.0f, goal);
+    return PathStatus::searching;
+}
+
+/**
+ * @brief Expand nodes of the running search
+ * @param budget Maximum count of expanded nodes, zero means unlimited
+ * @param cells Gets the path from start to goal if it got found
+ */
+PathStatus NavGrid::continue_search(Uint32 start, Uint32 goal, unsigned budget, std::vector<Uint32>& cells) {
+    unsigned expanded = 0;
+    while(!m_open.empty()) {
+        if(budget != 0 && expanded >= budget) {return PathStatus::searching;}
+        std::pop_heap(m_open.begin(), m_open.end());
+        Uint32 cell = m_open.back().cell;
+        m_open.pop_back();
+        // Skip outdated duplicates
+        if(m_closed[cell] == m_stamp) {continue;}
+        m_closed[cell] = m_stamp;
+        expanded++;
+
+        if(cell == goal) {
+            cells.clear();
+            for(Uint32 i = goal; i != start; i = m_parent[i]) {cells.push_back(i);}
+            cells.push_back(start);
+            std::reverse(cells.begin(), cells.end());
+
+            if(m_cache_size != 0) {
+                if(m_cache.size() >= m_cache_size) {
+                    m_cache.erase(m_cache_order.front());
+                    m_cache_order.pop_front();
+                }
+                Uint64 key = (static_cast<Uint64>(start) << 32) | goal;
+                m_cache[key] = cells;
+                m_cache_order.push_back(key);
+            }
+            return PathStatus::found;
+        }
+
+        if(m_hexagonal) {expand_hex(cell, goal);}
+        else {expand_jump_points(cell, goal);}
+    }
+    return PathStatus::no_path;
+}
+
+/// Add cell to the open list unless it is already known with a lower cost
+void NavGrid::open(Uint32 cell, Uint32 parent, float cost, Uint32 goal) {
+    if(m_opened[cell] == m_stamp && cost >= m_cost[cell]) {return;}
+    m_opened[cell] = m_stamp;
+    m_cost[cell] = cost;
+    m_parent[cell] = parent;
+    m_open.push_back({cost + heuristic(cell, goal), cell});
+    std::push_heap(m_open.begin(), m_open.end());
+}
+
+/// Lower bound of the path cost between two cells
+float NavGrid::heuristic(Uint32 from, Uint32 to) const {
+    int from_x = from % m_width;
+    int from_y = from / m_width;
+    int to_x = to % m_width;
+    int to_y = to / m_width;
+    if(!m_hexagonal) {return octile(to_x - from_x, to_y - from_y);}
+    Point a = get_cell_origin(from_x, from_y);
+    Point b = get_cell_origin(to_x, to_y);
+    return std::hypot(b.x - a.x, b.y - a.y);
+}
+
+/**
+ * @brief Open the jump points reachable from cell
+ *
+ * Only the directions which may not be reached more cheaply through the parent get
+ * followed. Diagonal moves require both adjacent orthogonal cells to be free.
+ */
+void NavGrid::expand_jump_points(Uint32 cell, Uint32 goal) {
+    int x = cell % m_width;
+    int y = cell / m_width;
+    Uint32 parent = m_parent[cell];
+    int dx = sign(x - static_cast<int>(parent % m_width));
+    int dy = sign(y - static_cast<int>(parent / m_width));
+
+    int directions[8][2];
+    unsigned count = 0;
+    auto add = [&](int ddx, int ddy) {
+        directions[count][0] = ddx;
+        directions[count][1] = ddy;
+        count++;
+    };
+    if(dx == 0 && dy == 0) {
+        // The start node
+        for(int ddy = -1; ddy <= 1; ddy++) {
+            for(int ddx = -1; ddx <= 1; ddx++) {
+                if(ddx != 0 || ddy != 0) {add(ddx, ddy);}
+            }
+        }
+    }
+    else if(dx != 0 && dy != 0) {
+        add(dx, 0);
+        add(0, dy);
+        add(dx, dy);
+    }
+    else if(dx != 0) {
+        add(dx, 0);
+        add(dx, 1);
+        add(dx, -1);
+        add(0, 1);
+        add(0, -1);
+    }
+    else {
+        add(0, dy);
+        add(1, dy);
+        add(-1, dy);
+        add(1, 0);
+        add(-1, 0);
+    }
+
+    for(unsigned i = 0; i < count; i++) {
+        int jump_x, jump_y;
+        if(jump(x, y, directions[i][0], directions[i][1], goal, jump_x, jump_y)) {
+            open(jump_y * m_width + jump_x, cell, m_cost[cell] + octile(jump_x - x, jump_y - y), goal);
+        }
+    }
+}
+
+/**
+ * @brief Walk from a cell in one direction until reaching a jump point
+ * @return False if the walk ends at a blocked cell without finding one
+ *
+ * A jump point is the goal or a cell with a neighbour which can't be reached
+ * optimally without passing through it.
+ */
+bool NavGrid::jump(int x, int y, int dx, int dy, Uint32 goal, int& out_x, int& out_y) const {
+    while(true) {
+        if(dx != 0 && dy != 0 && (is_blocked(x + dx, y) || is_blocked(x, y + dy))) {return false;}
+        x += dx;
+        y += dy;
+        if(is_blocked(x, y)) {return false;}
+
+        bool found = static_cast<Uint32>(y) * m_width + x == goal;
+        if(!found) {
+            if(dx != 0 && dy != 0) {
+                int dummy_x, dummy_y;
+                found = jump(x, y, dx, 0, goal, dummy_x, dummy_y) || jump(x, y, 0, dy, goal, dummy_x, dummy_y);
+            }
+            else if(dx != 0) {
+                found = (!is_blocked(x, y - 1) && is_blocked(x - dx, y - 1)) || (!is_blocked(x, y + 1) && is_blocked(x - dx, y + 1));
+            }
+            else {
+                found = (!is_blocked(x - 1, y) && is_blocked(x - 1, y - dy)) || (!is_blocked(x + 1, y) && is_blocked(x + 1, y - dy));
+            }
+        }
+        if(found) {
+            out_x = x;
+            out_y = y;
+            return true;
+        }
+    }
+}
+
+/// Open the free neighbours of cell on a staggered layout
+void NavGrid::expand_hex(Uint32 cell, Uint32 goal) {
+    float cost = m_cost[cell];
+    for_each_neighbour(cell, [this, cell, cost, goal](Uint32 neighbour, float step) {
+        open(neighbour, cell, cost + step, goal);
+    });
+}
+
+}} // namespace salmon::internal
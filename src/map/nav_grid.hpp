@@ -0,0 +1,206 @@
+/*
+ * Copyright 2017-2020 Agouti Games Team (see the AUTHORS file)
+ *
+ * This file is part of the RawSalmonEngine.
+ *
+ * The RawSalmonEngine is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * The RawSalmonEngine is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with the RawSalmonEngine.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#ifndef NAV_GRID_HPP_INCLUDED
+#define NAV_GRID_HPP_INCLUDED
+
+#include <algorithm>
+#include <cmath>
+#include <deque>
+#include <string>
+#include <unordered_map>
+#include <vector>
+#include <SDL.h>
+
+#include "util/game_types.hpp"
+
+namespace salmon { namespace internal {
+
+class MapData;
+class MapLayer;
+
+/**
+ * @brief Walkability grid of the map tiles with path searches on top
+ *
+ * A cell is blocked if the tile of any map layer at that cell has the blocking hitbox
+ * or the blocking tile type. Orthogonal maps are searched with jump point search over
+ * eight directions without cutting corners, staggered and hexagonal maps with A* over
+ * the six neighbours of each cell.
+ *
+ * Queued searches run one after another during update() and expand at most the node
+ * budget of their request per update. Found paths get cached until the grid changes.
+ */
+class NavGrid {
+    public:
+        void init(const std::vector<MapLayer*>& layers, const std::string& hitbox, const std::string& tile_type, MapData& base_map);
+        void init(unsigned width, unsigned height, int tile_w, int tile_h);
+        void refresh(unsigned x, unsigned y, unsigned w, unsigned h);
+        void clear();
+
+        bool empty() const {return m_blocked.empty();}
+        unsigned get_width() const {return m_width;}
+        unsigned get_height() const {return m_height;}
+        bool is_blocked(int x, int y) const {
+            return x < 0 || y < 0 || x >= static_cast<int>(m_width) || y >= static_cast<int>(m_height) || m_blocked[y * m_width + x];
+        }
+        bool is_blocked(Uint32 cell) const {return m_blocked[cell];}
+        void set_blocked(unsigned x, unsigned y, bool blocked);
+
+        /// Changes with every rebuild, after which get_changes() starts over
+        unsigned get_generation() const {return m_generation;}
+        /// Cells whose blocking state changed since the last rebuild, in order of change
+        const std::vector<Uint32>& get_changes() const {return m_changes;}
+
+        template<typename Function>
+        void for_each_neighbour(Uint32 cell, Function f) const;
+
+        bool to_cell(Point world, unsigned& x, unsigned& y) const;
+        Point to_world(unsigned x, unsigned y) const;
+        Point get_cell_origin(int x, int y) const;
+
+        PathStatus find_path(Point from, Point to, std::vector<Point>& path);
+        unsigned request_path(Point from, Point to, unsigned node_budget);
+        PathStatus get_path(unsigned request, std::vector<Point>& path);
+        void update();
+
+        void set_cache_size(unsigned size) {m_cache_size = size; clear_cache();}
+
+    private:
+        struct Request {
+            unsigned id;
+            Uint32 start;
+            Uint32 goal;
+            unsigned budget; ///< Maximum expanded nodes per update, zero means unlimited
+        };
+        struct Result {
+            PathStatus status = PathStatus::searching;
+            std::vector<Uint32> cells;
+        };
+        struct OpenNode {
+            float estimate; ///< Cost so far plus heuristic
+            Uint32 cell;
+            bool operator<(const OpenNode& other) const {return estimate > other.estimate;} ///< Makes the heap a min heap
+        };
+
+        bool is_shifted(int i) const {return (i % 2 != 0) == m_stagger_index_odd;}
+        bool is_tile_blocking(Uint32 tile_id, const MapLayer& layer);
+        void grid_changed(Uint32 cell);
+        void clear_cache();
+        void to_points(const std::vector<Uint32>& cells, std::vector<Point>& path) const;
+        bool to_index(Point world, Uint32& index) const;
+        void reset_cells();
+
+        PathStatus begin_search(Uint32 start, Uint32 goal, std::vector<Uint32>& cells);
+        PathStatus continue_search(Uint32 start, Uint32 goal, unsigned budget, std::vector<Uint32>& cells);
+        void open(Uint32 cell, Uint32 parent, float cost, Uint32 goal);
+        float heuristic(Uint32 from, Uint32 to) const;
+        void expand_jump_points(Uint32 cell, Uint32 goal);
+        bool jump(int x, int y, int dx, int dy, Uint32 goal, int& out_x, int& out_y) const;
+        void expand_hex(Uint32 cell, Uint32 goal);
+
+        std::vector<MapLayer*> m_layers; ///< Source of the tiles, the first one also sets the grid position
+        int m_hitbox = -1; ///< Id of the blocking hitbox or -1 if there is none
+        std::string m_tile_type; ///< The blocking tile type, empty if there is none
+        std::unordered_map<Uint32, bool> m_tile_blocking; ///< Whether tile ids including flip flags are blocking
+
+        unsigned m_width = 0;
+        unsigned m_height = 0;
+        std::vector<Uint8> m_blocked;
+        unsigned m_generation = 0;
+        std::vector<Uint32> m_changes;
+
+        // Cell layout, see TileCollisionGrid
+        bool m_hexagonal = false;
+        int m_tile_w = 1;
+        int m_tile_h = 1;
+        int m_step_x = 1;
+        int m_step_y = 1;
+        int m_shift_x = 0;
+        int m_shift_y = 0;
+        bool m_stagger_index_odd = true;
+
+        // State of the running search, stamps mark the entries belonging to it
+        std::vector<float> m_cost;
+        std::vector<Uint32> m_parent;
+        std::vector<Uint32> m_opened;
+        std::vector<Uint32> m_closed;
+        std::vector<OpenNode> m_open;
+        Uint32 m_stamp = 0;
+        bool m_searching = false; ///< True if the state belongs to the first queued request
+
+        std::deque<Request> m_requests;
+        std::unordered_map<unsigned, Result> m_results; ///< By request id until fetched
+        unsigned m_next_request = 1;
+
+        std::unordered_map<Uint64, std::vector<Uint32>> m_cache; ///< Found paths by start and goal cell
+        std::deque<Uint64> m_cache_order; ///< Oldest entry first
+        unsigned m_cache_size = 256;
+};
+/**
+ * @brief Calls f with each free cell which is reachable from cell in one step
+ * @param f Callable taking the <tt>Uint32</tt> index of the neighbour and the <tt>float</tt> step cost
+ *
+ * Orthogonal maps have eight neighbours, measured in cells. Diagonal steps require both
+ * adjacent orthogonal cells to be free. Staggered maps have six neighbours, measured in pixels.
+ */
+template<typename Function>
+void NavGrid::for_each_neighbour(Uint32 cell, Function f) const {
+    int x = cell % m_width;
+    int y = cell / m_width;
+    if(!m_hexagonal) {
+        const float diagonal = 1.41421356f;
+        for(int dy = -1; dy <= 1; dy++) {
+            for(int dx = -1; dx <= 1; dx++) {
+                if((dx == 0 && dy == 0) || is_blocked(x + dx, y + dy)) {continue;}
+                if(dx != 0 && dy != 0) {
+                    if(is_blocked(x + dx, y) || is_blocked(x, y + dy)) {continue;}
+                    f((y + dy) * m_width + x + dx, diagonal);
+                }
+                else {
+                    f((y + dy) * m_width + x + dx, 1.0f);
+                }
+            }
+        }
+        return;
+    }
+
+    int offsets[6][2];
+    if(m_shift_x != 0) {
+        // Rows are staggered, shifted rows reach one cell further right
+        int left = is_shifted(y) ? 0 : -1;
+        const int row_offsets[6][2] = {{-1, 0}, {1, 0}, {left, -1}, {left + 1, -1}, {left, 1}, {left + 1, 1}};
+        std::copy(&row_offsets[0][0], &row_offsets[0][0] + 12, &offsets[0][0]);
+    }
+    else {
+        // Columns are staggered, shifted columns reach one cell further down
+        int top = is_shifted(x) ? 0 : -1;
+        const int column_offsets[6][2] = {{0, -1}, {0, 1}, {-1, top}, {-1, top + 1}, {1, top}, {1, top + 1}};
+        std::copy(&column_offsets[0][0], &column_offsets[0][0] + 12, &offsets[0][0]);
+    }
+    Point origin = get_cell_origin(x, y);
+    for(const auto& offset : offsets) {
+        int n_x = x + offset[0];
+        int n_y = y + offset[1];
+        if(is_blocked(n_x, n_y)) {continue;}
+        Point n_origin = get_cell_origin(n_x, n_y);
+        f(n_y * m_width + n_x, std::hypot(n_origin.x - origin.x, n_origin.y - origin.y));
+    }
+}
+}} // namespace salmon::internal
+
+#endif // NAV_GRID_HPP_INCLUDED
@@ -43,6 +43,11 @@ ObjectLayer::ObjectLayer(tinyxml2::XMLElement* source, std::string name, LayerCo
     eresult = init(source);
 }
 
+/// Releases the actors of this layer from the actor slots
+ObjectLayer::~ObjectLayer() {
+    clear_actors();
+}
+
 /**
  * @brief Initialize the layer by parsing info from source
  * @param source The @c XMLElement from which information is parsed
@@ -109,12 +114,8 @@ tinyxml2::XMLError ObjectLayer::init(tinyxml2::XMLElement* source) {
 
         if(eResult == XML_SUCCESS && mapdata.is_actor(gid)) {
 
-            add_actor(mapdata.get_actor(gid));
-
-            // m_obj_grid.push_back(Actor(mapdata.get_actor(gid)));
-
             // Initialize actor from the XMLElement*
-            auto& actor = m_obj_grid.back();
+            Actor& actor = *add_actor(mapdata.get_actor(gid));
             eResult = actor.parse_base(p_object);
             if(eResult != XML_SUCCESS) {
                 Logger(Logger::error) << "Failed at loading dimensions and name of object in layer: " << m_name << " with gid: " << gid;
@@ -134,6 +135,13 @@ tinyxml2::XMLError ObjectLayer::init(tinyxml2::XMLElement* source) {
             transform.set_h_flip(flipped_horizontally);
             transform.set_v_flip(flipped_vertically);
         }
+        else if(TriggerRegions::is_trigger(p_object)) {
+            eResult = m_layer_collection->get_triggers().add(p_object, m_transform.get_relative(0,0));
+            if(eResult != XML_SUCCESS) {
+                Logger(Logger::error) << "Failed at loading trigger region in layer: " << m_name;
+                return eResult;
+            }
+        }
         else {
 
             Primitive* p = Primitive::parse(p_object, mapdata);
@@ -166,8 +174,8 @@ bool ObjectLayer::render(const Camera& camera) const {
     Point cam_origin = camera.get_transform().get_relative(0,0);
     std::vector<const Actor*> actors = get_clip(camera.get_transform().to_rect());
 
-    // Only sort actor clip and not whole array
-    std::sort(actors.begin(),actors.end(),[](const Actor* a, const Actor* b) { return *a < *b; });
+    // Only sort actor clip and not whole array, equal actors keep the layer order
+    std::stable_sort(actors.begin(),actors.end(),[](const Actor* a, const Actor* b) { return *a < *b; });
 
     for(const Actor* actor : actors) {
         actor->render(cam_origin.x,cam_origin.y);
@@ -182,14 +190,11 @@ bool ObjectLayer::render(const Camera& camera) const {
     return true;
 }
 
-/**
- * @brief return a vector of pointers to each actor
- */
-std::vector<Actor*> ObjectLayer::get_actors() {
+/// Returns all actors of this layer in order of insertion
+std::vector<Actor*> ObjectLayer::get_actors() const {
     std::vector<Actor*> actor_list;
-    for(Actor& actor : m_obj_grid) {
-        actor_list.push_back(&actor);
-    }
+    actor_list.reserve(get_actor_count());
+    for_each_actor([&actor_list](Actor* actor) {actor_list.push_back(actor);});
     return actor_list;
 }
 
@@ -197,27 +202,32 @@ std::vector<Actor*> ObjectLayer::get_actors() {
  * @brief Fetch all actors which have the given name
  * @return Vector of pointers to actor
  */
-std::vector<Actor*> ObjectLayer::get_actors(std::string name) {
+std::vector<Actor*> ObjectLayer::get_actors(const std::string& name) {
     std::vector<Actor*> actor_list;
-    for(Actor& actor : m_obj_grid) {
-        if(actor.get_name() == name) {
-            actor_list.push_back(&actor);
+    for(ActorHandle handle : m_layer_collection->find_actors(name)) {
+        Actor* actor = m_layer_collection->get_actor(handle);
+        if(actor->get_object_layer() == this) {
+            actor_list.push_back(actor);
         }
     }
+    // In order of insertion
+    std::sort(actor_list.begin(), actor_list.end(), [](const Actor* a, const Actor* b) {return a->get_id() < b->get_id();});
     return actor_list;
 }
 
 /**
  * @brief Fetch first actor which has the name
- * @return Pointer to matching actor
+ * @return Pointer to matching actor, the one added first if several share the name
  */
-Actor* ObjectLayer::get_actor(std::string name) {
-    for(Actor& actor : m_obj_grid) {
-        if(actor.get_name() == name) {
-            return &actor;
+Actor* ObjectLayer::get_actor(const std::string& name) {
+    Actor* first = nullptr;
+    for(ActorHandle handle : m_layer_collection->find_actors(name)) {
+        Actor* actor = m_layer_collection->get_actor(handle);
+        if(actor->get_object_layer() == this && (first == nullptr || actor->get_id() < first->get_id())) {
+            first = actor;
         }
     }
-    return nullptr;
+    return first;
 }
 
 /**
@@ -226,10 +236,10 @@ Actor* ObjectLayer::get_actor(std::string name) {
 std::vector<Actor*> ObjectLayer::get_clip(const Rect& rect) {
 
     std::vector<Actor*> actor_list;
-    for(Actor& actor : m_obj_grid) {
-        Rect bounds = actor.get_transform().to_bounding_box();
-        if(bounds.has_intersection(rect)) {actor_list.push_back(&actor);}
-    }
+    for_each_actor([&](Actor* actor) {
+        Rect bounds = actor->get_transform().to_bounding_box();
+        if(bounds.has_intersection(rect)) {actor_list.push_back(actor);}
+    });
     return actor_list;
 }
 
@@ -237,58 +247,84 @@ std::vector<Actor*> ObjectLayer::get_clip(const Rect& rect) {
 std::vector<const Actor*> ObjectLayer::get_clip(const Rect& rect) const {
 
     std::vector<const Actor*> actor_list;
-    for(const Actor& actor : m_obj_grid) {
-        Rect bounds = actor.get_transform().to_bounding_box();
-        if(bounds.has_intersection(rect)) {actor_list.push_back(&actor);}
-    }
+    for_each_actor([&](const Actor* actor) {
+        Rect bounds = actor->get_transform().to_bounding_box();
+        if(bounds.has_intersection(rect)) {actor_list.push_back(actor);}
+    });
     return actor_list;
 }
 
+/**
+ * @brief Stores a copy of the actor in this layer
+ * @return Pointer to the stored actor which stays valid until the actor gets erased
+ */
 Actor* ObjectLayer::add_actor(Actor a) {
-    m_obj_grid.push_back(a);
-    m_obj_grid.back().set_id(next_object_id++);
-    m_obj_grid.back().set_layer(m_name);
-    return &m_obj_grid.back();
+    SlotMap<Actor>& slots = m_layer_collection->get_actor_slots();
+    ActorHandle handle = slots.emplace(std::move(a));
+    Actor* actor = slots.get(handle);
+    actor->set_handle(handle);
+    actor->set_id(next_object_id++);
+    actor->set_layer(m_name);
+    actor->set_layer_position(this, m_actors.size());
+    m_actors.push_back(actor);
+    m_layer_collection->index_actor(*actor);
+    return actor;
 }
 
 /// Remove actor with given name from layer
-bool ObjectLayer::erase_actor(std::string name) {
-    for (auto itr = m_obj_grid.begin(); itr != m_obj_grid.end(); itr++) {
-        if ((*itr).get_name() == name) {
-            itr = m_obj_grid.erase(itr);
-            return true;
-        }
-    }
-    return false;
-/*
-    for(Actor& a : m_obj_grid) {
-        if(a.get_name() == name) {
-            m_obj_grid.remove(a);
-            return true;
-        }
-    }
-    return false;
-    */
+bool ObjectLayer::erase_actor(const std::string& name) {
+    Actor* actor = get_actor(name);
+    if(actor == nullptr) {return false;}
+    return erase_actor(actor);
 }
 
-/// Remove actor with given pointer from layer
+/**
+ * @brief Remove actor with given pointer from layer
+ * @return @c false if the actor isn't stored in this layer
+ *
+ * This is O(1) and leaves an empty entry behind, so no other actor moves while
+ * the layer is iterated. compact_actors() removes the empty entries later on.
+ */
 bool ObjectLayer::erase_actor(Actor* actor) {
-    for (auto itr = m_obj_grid.begin(); itr != m_obj_grid.end(); itr++) {
-        if (&(*itr) == actor) {
-            itr = m_obj_grid.erase(itr);
-            return true;
-        }
-    }
-    return false;
+    if(actor == nullptr || actor->get_object_layer() != this) {return false;}
+    Uint32 position = actor->get_layer_position();
+    if(position >= m_actors.size() || m_actors[position] != actor) {return false;}
+    m_actors[position] = nullptr;
+    m_erased_count++;
+    release_actor(actor);
+    return true;
+}
 
-    /*
-    for(Actor& a : m_obj_grid) {
-        if(&a == actor) {
-            m_obj_grid.remove(a);
-            return true;
-        }
+/// Close the gaps of erased actors while keeping the order of the remaining ones
+void ObjectLayer::compact_actors() {
+    if(m_erased_count == 0) {return;}
+    Uint32 position = 0;
+    for(Actor* actor : m_actors) {
+        if(actor == nullptr) {continue;}
+        actor->set_layer_position(this, position);
+        m_actors[position++] = actor;
     }
-    return false;*/
+    m_actors.resize(position);
+    m_erased_count = 0;
+}
+
+/// Free the slot of an erased actor and hand it back to the pool of its template
+void ObjectLayer::release_actor(Actor* actor) {
+    ActorHandle handle = actor->get_handle();
+    m_layer_collection->unindex_actor(*actor);
+    m_layer_collection->get_base_map().recycle_actor(*actor);
+    m_layer_collection->get_actor_slots().erase(handle);
+}
+
+/// Remove all actors from layer
+void ObjectLayer::clear_actors() {
+    SlotMap<Actor>& slots = m_layer_collection->get_actor_slots();
+    for_each_actor([&](Actor* actor) {
+        m_layer_collection->unindex_actor(*actor);
+        slots.erase(actor->get_handle());
+    });
+    m_actors.clear();
+    m_erased_count = 0;
 }
 
 void ObjectLayer::add_primitive(Primitive* primitive) {
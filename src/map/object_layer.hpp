@@ -43,11 +43,22 @@ class ObjectLayer : public Layer{
         LayerType get_type() override {return LayerType::object;}
 
         Actor* add_actor(Actor a);
-        std::vector<Actor*> get_actors();
-        std::vector<Actor*> get_actors(std::string name);
-        Actor* get_actor(std::string name);
-        bool erase_actor(std::string name);
+        std::vector<Actor*> get_actors() const;
+        size_t get_actor_count() const {return m_actors.size() - m_erased_count;}
+        /// Calls f for each actor in layer order, erasing actors within f is safe
+        template<typename F>
+        void for_each_actor(F f) const {
+            for(size_t i = 0; i < m_actors.size(); i++) {
+                if(m_actors[i] != nullptr) {f(m_actors[i]);}
+            }
+        }
+        std::vector<Actor*> get_actors(const std::string& name);
+        Actor* get_actor(const std::string& name);
+        bool erase_actor(const std::string& name);
         bool erase_actor(Actor* pointer);
+        void reserve_actors(size_t count) {m_actors.reserve(m_actors.size() + count);}
+        void clear_actors();
+        void compact_actors();
 
         /// @note Takes ownership of the supplied pointer
         void add_primitive(Primitive* primitive);
@@ -71,13 +82,17 @@ class ObjectLayer : public Layer{
         ObjectLayer(ObjectLayer&& other) = default;
         ObjectLayer& operator=(ObjectLayer&& other) = default;
 
+        ~ObjectLayer() override;
+
     protected:
         ObjectLayer(tinyxml2::XMLElement* source, std::string name, LayerCollection* layer_collection, tinyxml2::XMLError& eresult);
 
     private:
         tinyxml2::XMLError init(tinyxml2::XMLElement* source);
+        void release_actor(Actor* actor);
 
-        std::list<Actor> m_obj_grid;
+        std::vector<Actor*> m_actors; ///< In order of insertion, stored in the actor slots of the LayerCollection, nullptr for erased actors until compact_actors()
+        size_t m_erased_count = 0;
         std::list<Smart<Primitive>> m_primitives;
         bool m_suspended = false;
 
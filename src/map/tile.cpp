@@ -42,6 +42,31 @@ mp_tileset{ts}, m_clip{clp}
 
 }
 
+const Tile::Extra Tile::s_no_extra{};
+
+/// Copies the tile including its own copy of the extra data
+Tile::Tile(const Tile& other) :
+mp_tileset{other.mp_tileset}, m_clip{other.m_clip}, m_flags{other.m_flags}, m_type_id{other.m_type_id},
+m_animated{other.m_animated}, m_wants_mask{other.m_wants_mask},
+m_extra{other.m_extra ? new Extra(*other.m_extra) : nullptr}
+{
+
+}
+
+Tile& Tile::operator=(const Tile& other) {
+    if(this != &other) {
+        Tile temp(other);
+        *this = std::move(temp);
+    }
+    return *this;
+}
+
+/// Returns the extra data of the tile, it gets allocated on first use
+Tile::Extra& Tile::edit_extra() {
+    if(m_extra == nullptr) {m_extra.reset(new Extra);}
+    return *m_extra;
+}
+
 /**
  * @brief Parse tile information of standard tiles
  * @param source The @c XMLElement from the tileset
@@ -54,20 +79,42 @@ tinyxml2::XMLError Tile::parse_tile(tinyxml2::XMLElement* source, bool skip_prop
 
     XMLError eResult;
 
-    // Parse user specified properties of the tile (only speed right now)
+    // Parse user specified properties of the tile, the TYPE and any boolean flags
     XMLElement* p_tile_properties = source->FirstChildElement("properties");
     if(!skip_properties && p_tile_properties != nullptr) {
+        TilesetCollection& ts_collection = mp_tileset->get_ts_collection();
         XMLElement* p_property = p_tile_properties->FirstChildElement("property");
         while(p_property != nullptr) {
             const char* p_name;
             const char* p_value;
+            const char* p_type = p_property->Attribute("type");
             p_name = p_property->Attribute("name");
-            std::string name(p_name);
             if(p_name == nullptr) return XML_ERROR_PARSING_ATTRIBUTE;
-            else if(name == "TYPE") {
-                p_value = source->Attribute("value");
+            std::string name(p_name);
+            if(name == "TYPE") {
+                p_value = p_property->Attribute("value");
                 if(p_value == nullptr) return XML_ERROR_PARSING_ATTRIBUTE;
-                m_type = std::string(p_value);
+                edit_extra().type = std::string(p_value);
+                m_type_id = ts_collection.intern_tile_type(m_extra->type);
+            }
+
+            else if(name == "PIXEL_MASK") {
+                eResult = p_property->QueryBoolAttribute("value", &m_wants_mask);
+                if(eResult != XML_SUCCESS) {
+                    Logger(Logger::error) << "Failed parsing the tile property PIXEL_MASK";
+                    return eResult;
+                }
+            }
+
+            else if(p_type != nullptr && std::string("bool") == p_type) {
+                bool value;
+                eResult = p_property->QueryBoolAttribute("value", &value);
+                if(eResult != XML_SUCCESS) {
+                    Logger(Logger::error) << "Failed parsing the boolean tile property " << name;
+                    return eResult;
+                }
+                TileFlags flag = ts_collection.intern_tile_flag(name);
+                if(value) {m_flags |= flag;}
             }
 
             else {
@@ -83,7 +130,7 @@ tinyxml2::XMLError Tile::parse_tile(tinyxml2::XMLElement* source, bool skip_prop
     if(p_objgroup != nullptr) {
         XMLElement* p_object = p_objgroup->FirstChildElement("object");
         if(p_object != nullptr) {
-            eResult = parse::hitboxes(p_object, m_hitboxes);
+            eResult = parse::hitboxes(p_object, edit_extra().hitboxes);
             if(eResult != XML_SUCCESS) {
                 Logger(Logger::error) << "Failed at parsing hitbox for tile";
                 return eResult;
@@ -98,6 +145,7 @@ tinyxml2::XMLError Tile::parse_tile(tinyxml2::XMLElement* source, bool skip_prop
 
         m_animated = true;
         mp_tileset->get_ts_collection().set_tile_animated(this);
+        Extra& extra = edit_extra();
 
         // Parse each animation frame
         while(p_frame != nullptr) {
@@ -112,8 +160,8 @@ tinyxml2::XMLError Tile::parse_tile(tinyxml2::XMLElement* source, bool skip_prop
             anim_tile_id += mp_tileset->get_first_gid();
 
             // The actual registration of the frame
-            m_anim_ids.push_back(static_cast<Uint32>(anim_tile_id));
-            m_durations.push_back(duration);
+            extra.anim_ids.push_back(static_cast<Uint32>(anim_tile_id));
+            extra.durations.push_back(duration);
 
             // Go to next frame
             p_frame = p_frame->NextSiblingElement("frame");
@@ -218,7 +266,7 @@ tinyxml2::XMLError Tile::parse_actor_anim(tinyxml2::XMLElement* source) {
                     Logger(Logger::error) << "Trigger frame can't be a negative value!";
                     return XML_ERROR_PARSING_ATTRIBUTE;
                 }
-                m_trigger_frame = frame;
+                edit_extra().trigger_frame = frame;
             }
 
             else {
@@ -254,8 +302,8 @@ tinyxml2::XMLError Tile::parse_actor_anim(tinyxml2::XMLElement* source) {
         return XML_NO_ATTRIBUTE;
     }
 
-    else if(m_animated && m_trigger_frame >= m_anim_ids.size()) {
-        Logger(Logger::error) << "The trigger frame " << m_trigger_frame << " is out of the animation range from 0 to " << m_anim_ids.size() - 1;
+    else if(m_animated && m_extra->trigger_frame >= m_extra->anim_ids.size()) {
+        Logger(Logger::error) << "The trigger frame " << m_extra->trigger_frame << " is out of the animation range from 0 to " << m_extra->anim_ids.size() - 1;
         return XML_ERROR_PARSING_ATTRIBUTE;
     }
 
@@ -300,33 +348,48 @@ tinyxml2::XMLError Tile::parse_actor_templ(tinyxml2::XMLElement* source) {
  *
  * If not animated the normal clip value is returned
  */
-const SDL_Rect& Tile::get_clip() const {
+const SDL_Rect& Tile::get_clip(const AnimState& state) const {
     const TilesetCollection& tsc = mp_tileset->get_ts_collection();
     if(m_animated) {
         // Avoids daisy chaining of animated tiles
-        return tsc.get_tile(m_anim_ids[m_current_id])->get_clip_self();
+        return tsc.get_tile(m_extra->anim_ids[state.frame])->get_clip_self();
     }
     else {
         return m_clip;
     }
 }
 
-/// Initialize the tile to the supplied timestamp and first frame
-void Tile::init_anim(Uint32 time) {
-    m_current_id = 0;
-    m_anim_timestamp = time;
+/// Initialize the animation state to the supplied timestamp and first frame
+void Tile::init_anim(AnimState& state, Uint32 time) const {
+    state.frame = 0;
+    state.timestamp = time;
 }
 
-/// Set tile to specific animation frame
-bool Tile::set_frame(int anim_frame, Uint32 time) {
-    if(anim_frame < 0 || static_cast<size_t>(anim_frame) >= m_anim_ids.size()) {
+/// Set animation state to specific animation frame
+bool Tile::set_frame(AnimState& state, int anim_frame, Uint32 time) const {
+    if(anim_frame < 0 || static_cast<size_t>(anim_frame) >= extra().anim_ids.size()) {
         return false;
     }
-    m_current_id = static_cast<unsigned>(anim_frame);
-    m_anim_timestamp = time;
+    state.frame = static_cast<unsigned>(anim_frame);
+    state.timestamp = time;
     return true;
 }
 
+/**
+ * @brief Returns the timestamp at which the next frame of an animated tile is due
+ *
+ * Only valid for forward animation at normal speed, which is how map tiles get animated.
+ * The result is always at least one millisecond after the last update, so zero
+ * duration frames can't stall a scheduler relying on this value.
+ */
+Uint32 Tile::get_frame_deadline() const {
+    if(!m_animated) {return extra().anim.timestamp;}
+    const AnimState& anim = m_extra->anim;
+    float remaining = m_extra->durations[anim.frame] - anim.time_delta;
+    Uint32 wait = (remaining < 1.0f) ? 1 : static_cast<Uint32>(std::ceil(remaining));
+    return anim.timestamp + wait;
+}
+
 /**
  * @brief Animates a tile
  * @return a @c bool which indicates if the animation reached it's starting point/ frame 0
@@ -334,9 +397,9 @@ bool Tile::set_frame(int anim_frame, Uint32 time) {
  * Checks if next frame of animated tile is due, changes to next frame
  * and wraps around if required.
  */
-bool Tile::push_anim(float speed, Uint32 time) {
+bool Tile::push_anim(AnimState& state, float speed, Uint32 time) const {
     if(!m_animated) {return true;}
-    AnimSignal sig = push_anim_trigger(speed, time);
+    AnimSignal sig = push_anim_trigger(state, speed, time);
     if(sig == AnimSignal::wrap) {
         return true;
     }
@@ -352,36 +415,39 @@ bool Tile::push_anim(float speed, Uint32 time) {
  * and wraps around if required.
  * @note The wrap around signal has precedence over the trigger signal
  */
-AnimSignal Tile::push_anim_trigger(float speed, Uint32 time) {
+AnimSignal Tile::push_anim_trigger(AnimState& state, float speed, Uint32 time) const {
     if(!m_animated) {return AnimSignal::wrap;}
+    const std::vector<Uint32>& anim_ids = m_extra->anim_ids;
+    const std::vector<unsigned>& durations = m_extra->durations;
+    const unsigned trigger_frame = m_extra->trigger_frame;
     // if(speed < 0.0f) {speed = 0.0f;}
-    m_time_delta += speed * (time - m_anim_timestamp);
-    m_anim_timestamp = time;
+    state.time_delta += speed * (time - state.timestamp);
+    state.timestamp = time;
     AnimSignal sig = AnimSignal::none;
 
     // Backwards animation
-    if(m_time_delta < 0) {
+    if(state.time_delta < 0) {
 
-        unsigned id_before = m_current_id - 1;
-        if(m_current_id == 0) {id_before = m_anim_ids.size() - 1;}
+        unsigned id_before = state.frame - 1;
+        if(state.frame == 0) {id_before = anim_ids.size() - 1;}
 
-        while(-m_time_delta >= m_durations[id_before]) {
-            m_time_delta += m_durations[id_before];
+        while(-state.time_delta >= durations[id_before]) {
+            state.time_delta += durations[id_before];
 
-            if(m_current_id == 0) {
-                m_current_id = m_anim_ids.size() - 1;
+            if(state.frame == 0) {
+                state.frame = anim_ids.size() - 1;
                 if(sig < AnimSignal::wrap) {sig = AnimSignal::wrap;}
 
-                id_before = m_current_id - 1;
+                id_before = state.frame - 1;
             }
             else {
-                m_current_id--;
+                state.frame--;
 
-                id_before = m_current_id - 1;
-                if(m_current_id == 0) {id_before = m_anim_ids.size() - 1;}
+                id_before = state.frame - 1;
+                if(state.frame == 0) {id_before = anim_ids.size() - 1;}
             }
 
-            if(m_current_id == m_trigger_frame) {
+            if(state.frame == trigger_frame) {
                 if(sig < AnimSignal::trigger) {sig = AnimSignal::trigger;}
             }
             if(sig < AnimSignal::next) {sig = AnimSignal::next;}
@@ -389,14 +455,14 @@ AnimSignal Tile::push_anim_trigger(float speed, Uint32 time) {
     }
 
     // Forward animation
-    while(m_time_delta >= m_durations[m_current_id]) {
-        m_time_delta -= m_durations[m_current_id];
-        m_current_id++;
-        if(m_current_id >= m_anim_ids.size()) {
-            m_current_id = 0;
+    while(state.time_delta >= durations[state.frame]) {
+        state.time_delta -= durations[state.frame];
+        state.frame++;
+        if(state.frame >= anim_ids.size()) {
+            state.frame = 0;
             if(sig < AnimSignal::wrap) {sig = AnimSignal::wrap;}
         }
-        if(m_current_id == m_trigger_frame) {
+        if(state.frame == trigger_frame) {
             if(sig < AnimSignal::trigger) {sig = AnimSignal::trigger;}
         }
         if(sig < AnimSignal::next) {sig = AnimSignal::next;}
@@ -445,13 +511,18 @@ void Tile::render_extra(float x, float y, double angle, bool x_flip, bool y_flip
  * @note This function can resize the tile image
  */
 void Tile::render(Rect& dest) const {
+    render(dest, extra().anim);
+}
+
+/// Render a tile object to a rect at the frame of an external animation state
+void Tile::render(Rect& dest, const AnimState& state) const {
     dest.x += mp_tileset->get_x_offset();
     dest.y += mp_tileset->get_y_offset();
     const Texture* image = mp_tileset->get_image_pointer();
     PixelRect r = dest;
     SDL_Rect s{r.x,r.y,r.w,r.h};
 
-    image->render_resize(&get_clip(), &s);
+    image->render_resize(&get_clip(state), &s);
     return;
 }
 
@@ -463,6 +534,11 @@ void Tile::render(Rect& dest) const {
  * @note This function can resize the tile image
  */
 void Tile::render_extra(Rect& dest, double angle, bool x_flip, bool y_flip, float x_center, float y_center) const {
+    render_extra(dest, extra().anim, angle, x_flip, y_flip, x_center, y_center);
+}
+
+/// Render a tile object to a rect at the frame of an external animation state
+void Tile::render_extra(Rect& dest, const AnimState& state, double angle, bool x_flip, bool y_flip, float x_center, float y_center) const {
     dest.x += mp_tileset->get_x_offset();
     dest.y += mp_tileset->get_y_offset();
     const Texture* image = mp_tileset->get_image_pointer();
@@ -471,7 +547,7 @@ void Tile::render_extra(Rect& dest, double angle, bool x_flip, bool y_flip, floa
     PixelRect r = dest;
     SDL_Rect s{r.x,r.y,r.w,r.h};
 
-    image->render_extra_resize(&get_clip(), &s, angle, x_flip, y_flip, &center);
+    image->render_extra_resize(&get_clip(state), &s, angle, x_flip, y_flip, &center);
 
     return;
 }
@@ -480,48 +556,57 @@ void Tile::render_extra(Rect& dest, double angle, bool x_flip, bool y_flip, floa
  * @brief Return the active hitbox by name
  * @param name The name/type of the hitbox
  * @param aligned Sets the origin of hitbox relative to tile grid
+ */
+Rect Tile::get_hitbox(const std::string& name, bool aligned) const {
+    int id = HitboxSet::find_id(name);
+    if(id < 0) {return Rect{0,0,0,0};}
+    return get_hitbox(static_cast<HitboxId>(id), aligned);
+}
+
+/**
+ * @brief Return the active hitbox by interned id
+ * @param id The interned name of the hitbox
+ * @param aligned Sets the origin of hitbox relative to tile grid
  *
  * The active hitbox is usually the hitbox stored within the m_hitbox member variable
  * but if the tile is animated it first checks if the currently active frame has the
  * hitbox of the given name and returns it instead
  */
-Rect Tile::get_hitbox(std::string name, bool aligned) const {
+Rect Tile::get_hitbox(HitboxId id, bool aligned) const {
     if(m_animated) {
         const TilesetCollection& tsc = mp_tileset->get_ts_collection();
         // Animation frame which is an animation itself doesn't make sense!
         // Explicitly request own hitbox
-        Rect hitbox = tsc.get_tile(m_anim_ids[m_current_id])->get_hitbox_self(name, aligned);
+        Rect hitbox = tsc.get_tile(m_extra->anim_ids[m_extra->anim.frame])->get_hitbox_self(id, aligned);
         if(!hitbox.empty()) {
             return hitbox;
         }
     }
-    return get_hitbox_self(name, aligned);
+    return get_hitbox_self(id, aligned);
 }
 
 /**
- * @brief Return the hitbox of this tile by name
- * @param name The name/type of the hitbox
+ * @brief Return the hitbox of this tile by interned id
+ * @param id The interned name of the hitbox
  * @param aligned Sets the origin of hitbox relative to tile grid
  */
-Rect Tile::get_hitbox_self(std::string name, bool aligned) const {
-    if(m_hitboxes.find(name) == m_hitboxes.end()) {
-        // std::cerr << "Could not find hitbox " << type << " for actor " << m_name << "\n";
+Rect Tile::get_hitbox_self(HitboxId id, bool aligned) const {
+    const Rect* rect = extra().hitboxes.find(id);
+    if(rect == nullptr) {
         return Rect{0,0,0,0};
     }
-    else{
-        if(aligned) {
-            Rect hitbox = m_hitboxes.at(name);
-            const TilesetCollection& tsc = mp_tileset->get_ts_collection();
-            hitbox.x += mp_tileset->get_x_offset();
-            hitbox.y += mp_tileset->get_y_offset() - (mp_tileset->get_tile_height() - tsc.get_tile_h());
-            return hitbox;
-        }
-        else {
-            Rect hitbox = m_hitboxes.at(name);
-            hitbox.x += mp_tileset->get_x_offset();
-            hitbox.y += mp_tileset->get_y_offset();
-            return hitbox;
-        }
+    Rect hitbox = *rect;
+    align_hitbox(hitbox, aligned);
+    return hitbox;
+}
+
+/// Shift hitbox from tile image coordinates by the tileset offset and optionally align it to the tile grid
+void Tile::align_hitbox(Rect& hitbox, bool aligned) const {
+    hitbox.x += mp_tileset->get_x_offset();
+    hitbox.y += mp_tileset->get_y_offset();
+    if(aligned) {
+        const TilesetCollection& tsc = mp_tileset->get_ts_collection();
+        hitbox.y -= mp_tileset->get_tile_height() - tsc.get_tile_h();
     }
 }
 
@@ -533,31 +618,123 @@ Rect Tile::get_hitbox_self(std::string name, bool aligned) const {
  * but if the tile is animated the hitboxes of the active frame get added and
  * may override the hitboxes of the base tile
  */
-std::map<std::string, Rect> Tile::get_hitboxes(bool aligned) const {
-    if(m_animated) {
-        std::map<std::string, Rect> hitboxes = get_hitboxes_self(aligned);
+HitboxSet Tile::get_hitboxes(bool aligned) const {
+    return get_hitboxes(extra().anim, aligned);
+}
 
+/**
+ * @brief Return the active hitboxes at the frame of an external animation state
+ * @param state The animation state which selects the frame
+ * @param aligned Sets the origin of hitboxes relative to tile grid
+ */
+HitboxSet Tile::get_hitboxes(const AnimState& state, bool aligned) const {
+    HitboxSet hitboxes = get_hitboxes_self(aligned);
+    if(m_animated) {
         const TilesetCollection& tsc = mp_tileset->get_ts_collection();
         // Animation frame which is an animation itself doesn't make sense!
         // Explicitly request own hitbox
-        for(const auto& hitbox_pair: tsc.get_tile(m_anim_ids[m_current_id])->get_hitboxes_self(aligned)) {
-            hitboxes[hitbox_pair.first] = hitbox_pair.second;
+        hitboxes.merge(tsc.get_tile(m_extra->anim_ids[state.frame])->get_hitboxes_self(aligned));
+    }
+    return hitboxes;
+}
+
+/**
+ * @brief Returns the pixel mask of the tile or of the current animation frame
+ * @param tile_id Global tile id, only its flip flags select the mask variant
+ * @return nullptr if the tile has no pixel mask and therefore counts as fully opaque
+ */
+const PixelMask* Tile::get_pixel_mask(Uint32 tile_id, const AnimState& state) const {
+    const Tile* source = this;
+    if(m_animated) {
+        source = mp_tileset->get_ts_collection().get_tile(m_extra->anim_ids[state.frame]);
+    }
+    if(source == nullptr || source->extra().masks == nullptr) {return nullptr;}
+    return &source->m_extra->masks->get(tile_id);
+}
+
+/**
+ * @brief Generate the pixel mask and all of its flipped variants from the tileset image
+ * @param image The tileset image in @c SDL_PIXELFORMAT_RGBA32, see Tileset::build_pixel_masks()
+ */
+void Tile::build_pixel_mask(SDL_Surface* image) {
+    edit_extra().masks = std::make_shared<const PixelMaskSet>(PixelMask::from_surface(image, m_clip));
+}
+
+/// Returns true if the tile or any of its animation frames has a hitbox
+bool Tile::has_hitboxes() const {
+    if(!extra().hitboxes.empty()) {return true;}
+    if(m_animated) {
+        const TilesetCollection& tsc = mp_tileset->get_ts_collection();
+        for(Uint32 id : m_extra->anim_ids) {
+            if(!tsc.get_tile(id)->extra().hitboxes.empty()) {return true;}
         }
-        return hitboxes;
     }
-    return get_hitboxes_self(aligned);
+    return false;
+}
+
+/**
+ * @brief Returns the bytes which the tile occupies including its extra data
+ *
+ * Hitboxes are stored inline in the extra data. Pixel masks are counted in full
+ * even though copies of the tile share them.
+ */
+std::size_t Tile::get_memory_usage() const {
+    std::size_t bytes = sizeof(Tile);
+    if(m_extra != nullptr) {
+        bytes += sizeof(Extra) + m_extra->type.capacity() +
+                 m_extra->anim_ids.capacity() * sizeof(Uint32) + m_extra->durations.capacity() * sizeof(unsigned);
+        if(m_extra->masks != nullptr) {bytes += m_extra->masks->get_memory_usage();}
+    }
+    return bytes;
 }
 
 /**
  * @brief Return the hitboxes of this tile
  * @param aligned Sets the origin of hitboxes relative to tile grid
  */
-const std::map<std::string, Rect> Tile::get_hitboxes_self(bool aligned) const {
-    std::map<std::string, Rect> hitboxes;
-    for(auto& hb : m_hitboxes) {
-        hitboxes[hb.first] = get_hitbox_self(hb.first, aligned);
+HitboxSet Tile::get_hitboxes_self(bool aligned) const {
+    HitboxSet hitboxes = extra().hitboxes;
+    for(auto& entry : hitboxes) {
+        align_hitbox(entry.rect, aligned);
     }
     return hitboxes;
 }
 
+/**
+ * @brief Construct a tile instance from a map layer tile id
+ * @param tile The tile without flip flags
+ * @param tile_id The global tile id including the flip flags
+ * @param x, y The position of the upper left corner of the tile
+ */
+TileInstance::TileInstance(Tile* tile, Uint32 tile_id, float x, float y) : m_tile{tile} {
+    const Uint32 FLIPPED_HORIZONTALLY_FLAG = 0x80000000;
+    const Uint32 FLIPPED_VERTICALLY_FLAG   = 0x40000000;
+    const Uint32 FLIPPED_DIAGONALLY_FLAG   = 0x20000000;
+
+    m_transform = Transform{x, y,
+                            static_cast<float>(tile->get_w()),
+                            static_cast<float>(tile->get_h()),
+                            0,0};
+    m_transform.set_rotation_center(0.5,0.5);
+    if(tile_id >= FLIPPED_DIAGONALLY_FLAG) {
+        // Read out flags
+        bool flipped_horizontally = (tile_id & FLIPPED_HORIZONTALLY_FLAG);
+        bool flipped_vertically = (tile_id & FLIPPED_VERTICALLY_FLAG);
+        bool flipped_diagonally = (tile_id & FLIPPED_DIAGONALLY_FLAG);
+        double angle = 0;
+        // This snippet was determined via trial and error
+        // I have no idea why this even works, but it does
+        if(flipped_diagonally) {
+            angle = 270;
+            if(flipped_horizontally == flipped_vertically) {
+                angle = 90;
+            }
+            flipped_vertically = !flipped_vertically;
+        }
+        m_transform.set_h_flip(flipped_horizontally);
+        m_transform.set_v_flip(flipped_vertically);
+        m_transform.set_rotation(angle);
+    }
+}
+
 }} // namespace salmon::internal
@@ -22,17 +22,36 @@
 #include <SDL.h>
 #include <vector>
 #include <map>
+#include <memory>
 #include <tinyxml2.h>
 
 #include "transform.hpp"
+#include "map/tileset_collection.hpp"
 #include "util/game_types.hpp"
+#include "util/hitbox_set.hpp"
+#include "util/pixel_mask.hpp"
 
 namespace salmon { namespace internal {
 
 class Tileset; // forward declaration
 
+/**
+ * @brief Playback state of an animated tile
+ *
+ * Kept apart from the tile so that many actors can play the same animation tile
+ */
+struct AnimState {
+    unsigned frame = 0;
+    Uint32 timestamp = 0;
+    float time_delta = 0;
+};
+
 /**
  * @brief Parse, store and manage an individual tile
+ *
+ * Most tiles of a tileset are plain images, so the tile itself only holds what every tile
+ * needs. Hitboxes, type name, pixel masks and animation tables live in a separately allocated
+ * Extra block which only tiles that have any of them get.
  */
 
 class Tile{
@@ -40,67 +59,119 @@ public:
     Tile() = default;
     Tile(Tileset* ts, const SDL_Rect& clp); // The initializing constructor
 
+    Tile(const Tile& other);
+    Tile& operator=(const Tile& other);
+    Tile(Tile&& other) = default;
+    Tile& operator=(Tile&& other) = default;
+
     void render(float x, float y) const;
     void render_extra(float x, float y, double angle, bool x_flip = false, bool y_flip = false, float x_center = 0.5, float y_center = 0.5) const;
     void render(Rect& dest) const; // Resizable render
     void render_extra(Rect& dest, double angle, bool x_flip = false, bool y_flip = false, float x_center = 0.5, float y_center = 0.5) const;
+    void render(Rect& dest, const AnimState& state) const;
+    void render_extra(Rect& dest, const AnimState& state, double angle, bool x_flip = false, bool y_flip = false, float x_center = 0.5, float y_center = 0.5) const;
 
-    Rect get_hitbox(std::string name = DEFAULT_HITBOX, bool aligned = false) const;
-    std::map<std::string, Rect> get_hitboxes(bool aligned = false) const;
+    Rect get_hitbox(const std::string& name = DEFAULT_HITBOX, bool aligned = false) const;
+    Rect get_hitbox(HitboxId id, bool aligned = false) const;
+    HitboxSet get_hitboxes(bool aligned = false) const;
+    HitboxSet get_hitboxes(const AnimState& state, bool aligned = false) const;
+    bool has_hitboxes() const;
+
+    const PixelMask* get_pixel_mask(Uint32 tile_id) const {return get_pixel_mask(tile_id, extra().anim);}
+    const PixelMask* get_pixel_mask(Uint32 tile_id, const AnimState& state) const;
+    bool wants_pixel_mask() const {return m_wants_mask;}
+    void request_pixel_mask() {m_wants_mask = true;}
+    void build_pixel_mask(SDL_Surface* image);
 
     tinyxml2::XMLError parse_tile(tinyxml2::XMLElement* source, bool skip_properties = false);
     tinyxml2::XMLError parse_actor_anim(tinyxml2::XMLElement* source);
     tinyxml2::XMLError parse_actor_templ(tinyxml2::XMLElement* source);
 
-    void init_anim(Uint32 time = SDL_GetTicks());
-
-    bool push_anim(float speed = 1.0f, Uint32 time = SDL_GetTicks());
-    AnimSignal push_anim_trigger(float speed = 1.0f, Uint32 time = SDL_GetTicks());
-    bool set_frame(int anim_frame, Uint32 time = SDL_GetTicks());
-    int get_frame_count() const {return m_anim_ids.size();}
-    int get_current_frame() const {return m_current_id;}
+    // Animation with the state of the tile itself, which plain tiles don't have
+    void init_anim(Uint32 time) {if(m_animated) {init_anim(m_extra->anim, time);}}
+    bool push_anim(float speed, Uint32 time) {return m_animated ? push_anim(m_extra->anim, speed, time) : true;}
+    AnimSignal push_anim_trigger(float speed, Uint32 time) {return m_animated ? push_anim_trigger(m_extra->anim, speed, time) : AnimSignal::wrap;}
+    bool set_frame(int anim_frame, Uint32 time) {return m_animated && set_frame(m_extra->anim, anim_frame, time);}
+    Uint32 get_frame_deadline() const;
+    int get_frame_count() const {return extra().anim_ids.size();}
+    int get_current_frame() const {return extra().anim.frame;}
+
+    // Animation with external state, leaves the tile untouched
+    void init_anim(AnimState& state, Uint32 time) const;
+    bool push_anim(AnimState& state, float speed, Uint32 time) const;
+    AnimSignal push_anim_trigger(AnimState& state, float speed, Uint32 time) const;
+    bool set_frame(AnimState& state, int anim_frame, Uint32 time) const;
+
+    const std::vector<Uint32>& get_anim_ids() const {return extra().anim_ids;}
+    bool is_animated() const {return m_animated;}
     bool is_valid() const {return mp_tileset != nullptr;}
 
-    std::string get_type() const {return m_type;}
+    std::string get_type() const {return extra().type;}
+    TileTypeId get_type_id() const {return m_type_id;} ///< Interned type, see TilesetCollection::intern_tile_type()
+    TileFlags get_flags() const {return m_flags;} ///< Boolean properties which are true, see TilesetCollection::intern_tile_flag()
     Tileset& get_tileset() {return *mp_tileset;}
 
     int get_w() const {return get_clip().w;}
     int get_h() const {return get_clip().h;}
+    int get_w(const AnimState& state) const {return get_clip(state).w;}
+    int get_h(const AnimState& state) const {return get_clip(state).h;}
+    const SDL_Rect& get_clip() const {return get_clip(extra().anim);}
+
+    bool has_extra() const {return m_extra != nullptr;}
+    std::size_t get_memory_usage() const;
 
 private:
-    Rect get_hitbox_self(std::string name = DEFAULT_HITBOX, bool aligned = false) const;
-    const std::map<std::string, Rect> get_hitboxes_self(bool aligned = false) const;
+    /// Data which most tiles don't have
+    struct Extra {
+        HitboxSet hitboxes; // Origin at upper left corner of tile
+        std::string type = "";
+        std::shared_ptr<const PixelMaskSet> masks; ///< Shared by copies of the tile, e.g. actor templates
+
+        // Variables required for animated tiles
+        AnimState anim;
+        unsigned trigger_frame = 0;
+        std::vector<Uint32> anim_ids; // could use Tile* for better performance but greater memory allocation
+        std::vector<unsigned> durations;
+    };
+    static const Extra s_no_extra;
+
+    const Extra& extra() const {return m_extra ? *m_extra : s_no_extra;}
+    Extra& edit_extra();
+
+    Rect get_hitbox_self(HitboxId id, bool aligned = false) const;
+    HitboxSet get_hitboxes_self(bool aligned = false) const;
+    void align_hitbox(Rect& hitbox, bool aligned) const;
 
     const SDL_Rect& get_clip_self() const {return m_clip;}
-    const SDL_Rect& get_clip() const;
+    const SDL_Rect& get_clip(const AnimState& state) const;
 
     Tileset* mp_tileset = nullptr;
     SDL_Rect m_clip;
-    std::map<std::string, Rect> m_hitboxes; // Origin at upper left corner of tile
-    std::string m_type = "";
+    TileFlags m_flags = 0;
+    TileTypeId m_type_id = 0;
     bool m_animated = false;
-
-    // Variables required for animated tiles
-    unsigned m_current_id = 0;
-    unsigned m_trigger_frame = 0;
-    std::vector<Uint32> m_anim_ids; // could use Tile* for better performance but greater memory allocation
-    std::vector<unsigned> m_durations;
-    Uint32 m_anim_timestamp = 0;
-    float m_time_delta = 0;
+    bool m_wants_mask = false;
+    std::unique_ptr<Extra> m_extra; ///< nullptr for plain tiles
 };
 
 class TileInstance {
     public:
         TileInstance(Tile* tile, Transform t) : m_tile{tile}, m_transform{t} {}
+        TileInstance(Tile* tile, Uint32 tile_id, float x, float y);
 
-        Rect get_hitbox(std::string name = DEFAULT_HITBOX, bool aligned = false) const {
+        Rect get_hitbox(const std::string& name = DEFAULT_HITBOX, bool aligned = false) const {
             Rect temp = m_tile->get_hitbox(name,aligned);
             m_transform.transform_hitbox(temp);
             return temp;
         }
-        std::map<std::string, Rect> get_hitboxes(bool aligned = false) const {
-            std::map<std::string, Rect> hitboxes = m_tile->get_hitboxes(aligned);
-            for(auto& hb : hitboxes) {m_transform.transform_hitbox(hb.second);;}
+        Rect get_hitbox(HitboxId id, bool aligned = false) const {
+            Rect temp = m_tile->get_hitbox(id,aligned);
+            m_transform.transform_hitbox(temp);
+            return temp;
+        }
+        HitboxSet get_hitboxes(bool aligned = false) const {
+            HitboxSet hitboxes = m_tile->get_hitboxes(aligned);
+            for(auto& hb : hitboxes) {m_transform.transform_hitbox(hb.rect);}
             return hitboxes;
         }
         Tile* get_tile() const {return m_tile;}
@@ -0,0 +1,138 @@
+/*
+ * Copyright 2017-2020 Agouti Games Team (see the AUTHORS file)
+ *
+ * This file is part of the RawSalmonEngine.
+ *
+ * The RawSalmonEngine is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * The RawSalmonEngine is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with the RawSalmonEngine.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#include "map/tile_collision_grid.hpp"
+
+#include <algorithm>
+#include <map>
+
+#include "map/mapdata.hpp"
+#include "map/tileset_collection.hpp"
+#include "util/logger.hpp"
+
+namespace salmon { namespace internal {
+
+/**
+ * @brief Returns the pixel mask of the tile in its current frame
+ * @param pos Receives the world position of the mask, which is centered on the tile
+ * @return nullptr if the tile has no mask
+ */
+const PixelMask* TileCollisionGrid::Cell::get_pixel_mask(Point& pos) const {
+    if(tile == nullptr) {return nullptr;}
+    const PixelMask* mask = tile->get_pixel_mask(tile_id);
+    if(mask == nullptr) {return nullptr;}
+    // Diagonally flipped variants of non square tiles swap their dimensions
+    pos.x = origin.x + (tile->get_w() - mask->get_w()) / 2;
+    pos.y = origin.y + (tile->get_h() - mask->get_h()) / 2;
+    return mask;
+}
+
+/**
+ * @brief Build the grid from the tile ids of a map layer
+ * @param map_grid The tile ids of the layer, indexed by row and column
+ * @param ts_collection The tilesets which resolve the tile ids
+ * @param base_map The map which determines the tile layout
+ */
+void TileCollisionGrid::init(const std::vector<std::vector<Uint32> >& map_grid, const TilesetCollection& ts_collection, MapData& base_map) {
+    m_height = map_grid.size();
+    m_width = map_grid.empty() ? 0 : map_grid.front().size();
+    m_cells.assign(m_width * m_height, 0);
+    m_variants.clear();
+    m_min_x = m_min_y = m_max_x = m_max_y = 0;
+
+    // Mirror the cell positions used by MapLayer::clip
+    const MapData::TileLayout layout = base_map.get_tile_layout();
+    int tile_w = static_cast<int>(ts_collection.get_tile_w());
+    int tile_h = static_cast<int>(ts_collection.get_tile_h());
+    m_step_x = tile_w;
+    m_step_y = tile_h;
+    m_shift_x = 0;
+    m_shift_y = 0;
+    m_stagger_index_odd = layout.stagger_index_odd;
+    if(layout.orientation != "orthogonal") {
+        if(layout.stagger_axis_y) {
+            m_step_y = tile_h / 2 + layout.hexsidelength / 2;
+            m_shift_x = tile_w / 2;
+        }
+        else {
+            m_step_x = tile_w / 2 + layout.hexsidelength / 2;
+            m_shift_y = tile_h / 2;
+        }
+    }
+    if(m_step_x <= 0) {m_step_x = 1;}
+    if(m_step_y <= 0) {m_step_y = 1;}
+
+    // Tile id including flip flags -> index into m_variants plus one
+    std::map<Uint32, Uint16> variant_index;
+    bool overflow = false;
+
+    for(unsigned i_y = 0; i_y < m_height; i_y++) {
+        for(unsigned i_x = 0; i_x < m_width && i_x < map_grid[i_y].size(); i_x++) {
+            Uint32 tile_id = map_grid[i_y][i_x];
+            if(tile_id == 0) {continue;}
+
+            auto it = variant_index.find(tile_id);
+            if(it == variant_index.end()) {
+                Uint16 index = 0;
+                Tile* tile = ts_collection.get_tile(tile_id);
+                if(tile != nullptr && tile->has_hitboxes()) {
+                    if(m_variants.size() >= 0xFFFF) {
+                        overflow = true;
+                    }
+                    else {
+                        Variant variant{tile, tile_id, tile->is_animated(), HitboxSet()};
+                        if(variant.animated) {
+                            // Cover the hitboxes of every frame
+                            add_extent(TileInstance(tile, tile_id, 0, 0).get_hitboxes());
+                            for(Uint32 frame_id : tile->get_anim_ids()) {
+                                Tile* frame = ts_collection.get_tile(frame_id);
+                                add_extent(TileInstance(frame, tile_id, 0, 0).get_hitboxes());
+                            }
+                        }
+                        else {
+                            variant.hitboxes = TileInstance(tile, tile_id, 0, 0).get_hitboxes();
+                            add_extent(variant.hitboxes);
+                        }
+                        m_variants.push_back(variant);
+                        index = static_cast<Uint16>(m_variants.size());
+                    }
+                }
+                it = variant_index.emplace(tile_id, index).first;
+            }
+            m_cells[i_y * m_width + i_x] = it->second;
+        }
+    }
+
+    if(overflow) {
+        Logger(Logger::error) << "Too many distinct tiles with hitboxes in one layer, some collisions are ignored";
+    }
+}
+
+/// Widen the bounding box of all hitboxes relative to the cell origin
+void TileCollisionGrid::add_extent(const HitboxSet& hitboxes) {
+    for(const auto& hitbox : hitboxes) {
+        const Rect& r = hitbox.rect;
+        if(r.empty()) {continue;}
+        m_min_x = std::min(m_min_x, r.x);
+        m_min_y = std::min(m_min_y, r.y);
+        m_max_x = std::max(m_max_x, r.x + r.w);
+        m_max_y = std::max(m_max_y, r.y + r.h);
+    }
+}
+
+}} // namespace salmon::internal
@@ -0,0 +1,269 @@
+/*
+ * Copyright 2017-2020 Agouti Games Team (see the AUTHORS file)
+ *
+ * This file is part of the RawSalmonEngine.
+ *
+ * The RawSalmonEngine is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * The RawSalmonEngine is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with the RawSalmonEngine.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#ifndef TILE_COLLISION_GRID_HPP_INCLUDED
+#define TILE_COLLISION_GRID_HPP_INCLUDED
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+#include <vector>
+#include <SDL.h>
+
+#include "map/tile.hpp"
+#include "util/game_types.hpp"
+#include "util/hitbox_set.hpp"
+
+namespace salmon { namespace internal {
+
+class MapData;
+class TilesetCollection;
+
+/**
+ * @brief Precomputed hitboxes of all tiles of a map layer
+ *
+ * Built once when the layer is loaded. Each distinct tile id (including its flip flags)
+ * which carries hitboxes gets its flipped and rotated hitboxes calculated relative to the
+ * cell origin, so a collision query only has to offset them by the cell position instead
+ * of constructing a TileInstance for every overlapping tile.
+ * Animated tiles can change their hitboxes each frame and are evaluated on demand.
+ */
+class TileCollisionGrid {
+    public:
+        /// A tile with hitboxes which was found by for_each()
+        struct Cell {
+            Tile* tile = nullptr;
+            Uint32 tile_id = 0; ///< Global tile id including flip flags
+            Point origin; ///< World position of the upper left corner of the tile
+            HitboxSet hitboxes; ///< Hitboxes in world coordinates
+            bool animated = false; ///< The hitboxes may differ in the next frame
+
+            TileInstance get_instance() const {return TileInstance(tile, tile_id, origin.x, origin.y);}
+            const PixelMask* get_pixel_mask(Point& pos) const;
+        };
+
+        void init(const std::vector<std::vector<Uint32> >& map_grid, const TilesetCollection& ts_collection, MapData& base_map);
+
+        template<typename Function>
+        void for_each(const Rect& rect, Point layer_pos, Function f) const;
+        template<typename Function>
+        void for_each_along(const Rect& rect, Point motion, Point layer_pos, Function f) const;
+        template<typename Function>
+        void for_each_on_ray(Point origin, Point delta, Point layer_pos, Function f) const;
+
+        bool empty() const {return m_variants.empty();}
+
+    private:
+        struct Variant {
+            Tile* tile;
+            Uint32 tile_id;
+            bool animated; ///< Hitboxes get evaluated on demand
+            HitboxSet hitboxes; ///< Relative to the cell origin
+        };
+
+        Point get_cell_origin(int x, int y) const;
+        void add_extent(const HitboxSet& hitboxes);
+
+        unsigned m_width = 0;
+        unsigned m_height = 0;
+        std::vector<Uint16> m_cells; ///< Index into m_variants plus one, zero means no hitboxes
+        std::vector<Variant> m_variants;
+
+        // Cell layout
+        int m_step_x = 1;
+        int m_step_y = 1;
+        int m_shift_x = 0; ///< Horizontal offset of staggered rows
+        int m_shift_y = 0; ///< Vertical offset of staggered columns
+        bool m_stagger_index_odd = true;
+
+        // Bounding box of all hitboxes relative to the cell origin
+        float m_min_x = 0;
+        float m_min_y = 0;
+        float m_max_x = 0;
+        float m_max_y = 0;
+};
+
+/**
+ * @brief Calls f with each tile cell whose hitboxes may intersect rect
+ * @param rect The world space area to query, usually a bounding box
+ * @param layer_pos The world position of the layer origin
+ * @param f Callable taking a <tt>const Cell&</tt>
+ */
+template<typename Function>
+void TileCollisionGrid::for_each(const Rect& rect, Point layer_pos, Function f) const {
+    if(m_variants.empty()) {return;}
+    float x = rect.x - layer_pos.x;
+    float y = rect.y - layer_pos.y;
+
+    int x_from = static_cast<int>(std::floor((x - m_max_x - m_shift_x) / m_step_x));
+    int x_to = static_cast<int>(std::floor((x + rect.w - m_min_x) / m_step_x));
+    int y_from = static_cast<int>(std::floor((y - m_max_y - m_shift_y) / m_step_y));
+    int y_to = static_cast<int>(std::floor((y + rect.h - m_min_y) / m_step_y));
+
+    if(x_from < 0) {x_from = 0;}
+    if(y_from < 0) {y_from = 0;}
+    if(x_to >= static_cast<int>(m_width)) {x_to = static_cast<int>(m_width) - 1;}
+    if(y_to >= static_cast<int>(m_height)) {y_to = static_cast<int>(m_height) - 1;}
+
+    Cell cell;
+    for(int i_y = y_from; i_y <= y_to; i_y++) {
+        const Uint16* row = m_cells.data() + i_y * m_width;
+        for(int i_x = x_from; i_x <= x_to; i_x++) {
+            if(row[i_x] == 0) {continue;}
+            const Variant& variant = m_variants[row[i_x] - 1];
+            Point origin = get_cell_origin(i_x, i_y);
+            cell.tile = variant.tile;
+            cell.tile_id = variant.tile_id;
+            cell.origin = {origin.x + layer_pos.x, origin.y + layer_pos.y};
+            cell.animated = variant.animated;
+            if(variant.animated) {
+                cell.hitboxes = cell.get_instance().get_hitboxes();
+            }
+            else {
+                cell.hitboxes = variant.hitboxes;
+                for(auto& hitbox : cell.hitboxes) {
+                    hitbox.rect.x += cell.origin.x;
+                    hitbox.rect.y += cell.origin.y;
+                }
+            }
+            f(static_cast<const Cell&>(cell));
+        }
+    }
+}
+
+/**
+ * @brief Calls f with each tile cell which may be hit by rect moving along motion
+ * @param rect The world space area at the start of the movement
+ * @param motion The movement vector
+ * @param layer_pos The world position of the layer origin
+ * @param f Callable taking a <tt>const Cell&</tt> and returning the fraction of the first impact found so far
+ *
+ * The movement gets walked in steps of at most one cell, so only the cells crossed
+ * by the moving rect are visited. The walk ends early once f reports an impact which
+ * lies before the end of the current step. Cells may be visited more than once.
+ */
+template<typename Function>
+void TileCollisionGrid::for_each_along(const Rect& rect, Point motion, Point layer_pos, Function f) const {
+    if(m_variants.empty()) {return;}
+    float cells = std::max(std::fabs(motion.x) / m_step_x, std::fabs(motion.y) / m_step_y);
+    int steps = std::max(1, static_cast<int>(std::ceil(cells)));
+    float first_impact = 1.0f;
+    for(int i = 0; i < steps; i++) {
+        float t_from = static_cast<float>(i) / steps;
+        float t_to = static_cast<float>(i + 1) / steps;
+        // Area covered by rect during this step
+        float x_from = rect.x + motion.x * t_from;
+        float x_to = rect.x + motion.x * t_to;
+        float y_from = rect.y + motion.y * t_from;
+        float y_to = rect.y + motion.y * t_to;
+        Rect area{std::min(x_from, x_to), std::min(y_from, y_to),
+                  std::fabs(x_to - x_from) + rect.w, std::fabs(y_to - y_from) + rect.h};
+        for_each(area, layer_pos, [&](const Cell& cell) {
+            first_impact = f(cell);
+        });
+        if(first_impact <= t_to) {return;}
+    }
+}
+
+/**
+ * @brief Calls f with each tile cell which may be hit by the ray from origin to origin + delta
+ * @param origin The world space start of the ray
+ * @param delta The ray vector
+ * @param layer_pos The world position of the layer origin
+ * @param f Callable taking a <tt>const Cell&</tt> and returning the fraction of the first hit found so far
+ *
+ * The ray gets clipped to the grid and walked cell by cell with a grid DDA. Each visited
+ * cell is queried via for_each(), which also covers staggered rows or columns and hitboxes
+ * reaching into neighbouring cells. The walk ends early once f reports a hit which lies
+ * within the cells walked so far. Cells may be visited more than once.
+ */
+template<typename Function>
+void TileCollisionGrid::for_each_on_ray(Point origin, Point delta, Point layer_pos, Function f) const {
+    if(m_variants.empty()) {return;}
+    const float inf = std::numeric_limits<float>::infinity();
+    float x = origin.x - layer_pos.x;
+    float y = origin.y - layer_pos.y;
+
+    // Clip the ray to the area which may contain hitboxes
+    float t_from = 0.0f;
+    float t_to = 1.0f;
+    float min_x = std::min(0.0f, m_min_x + std::min(0, m_shift_x));
+    float min_y = std::min(0.0f, m_min_y + std::min(0, m_shift_y));
+    float max_x = static_cast<float>(m_width * m_step_x) + m_max_x + std::max(0, m_shift_x);
+    float max_y = static_cast<float>(m_height * m_step_y) + m_max_y + std::max(0, m_shift_y);
+    const float starts[2] = {x, y};
+    const float deltas[2] = {delta.x, delta.y};
+    const float mins[2] = {min_x, min_y};
+    const float maxs[2] = {max_x, max_y};
+    for(int axis = 0; axis < 2; axis++) {
+        if(deltas[axis] == 0) {
+            if(starts[axis] < mins[axis] || starts[axis] > maxs[axis]) {return;}
+            continue;
+        }
+        float t_a = (mins[axis] - starts[axis]) / deltas[axis];
+        float t_b = (maxs[axis] - starts[axis]) / deltas[axis];
+        t_from = std::max(t_from, std::min(t_a, t_b));
+        t_to = std::min(t_to, std::max(t_a, t_b));
+    }
+    if(t_from > t_to) {return;}
+
+    x += delta.x * t_from;
+    y += delta.y * t_from;
+    int i_x = static_cast<int>(std::floor(x / m_step_x));
+    int i_y = static_cast<int>(std::floor(y / m_step_y));
+    int step_x = (delta.x > 0) ? 1 : -1;
+    int step_y = (delta.y > 0) ? 1 : -1;
+    float t_max_x = (delta.x == 0) ? inf : t_from + ((i_x + (step_x > 0)) * m_step_x - x) / delta.x;
+    float t_max_y = (delta.y == 0) ? inf : t_from + ((i_y + (step_y > 0)) * m_step_y - y) / delta.y;
+    float t_delta_x = (delta.x == 0) ? inf : m_step_x / std::fabs(delta.x);
+    float t_delta_y = (delta.y == 0) ? inf : m_step_y / std::fabs(delta.y);
+
+    float first_hit = 1.0f;
+    while(true) {
+        Rect area{static_cast<float>(i_x * m_step_x) + layer_pos.x, static_cast<float>(i_y * m_step_y) + layer_pos.y,
+                  static_cast<float>(m_step_x), static_cast<float>(m_step_y)};
+        for_each(area, layer_pos, [&](const Cell& cell) {
+            first_hit = f(cell);
+        });
+        float t_exit = std::min(t_max_x, t_max_y);
+        if(first_hit <= t_exit || t_exit >= t_to) {return;}
+        if(t_max_x < t_max_y) {
+            i_x += step_x;
+            t_max_x += t_delta_x;
+        }
+        else {
+            i_y += step_y;
+            t_max_y += t_delta_y;
+        }
+    }
+}
+
+/// Returns the position of the upper left corner of a cell relative to the layer origin
+inline Point TileCollisionGrid::get_cell_origin(int x, int y) const {
+    Point origin{static_cast<float>(x * m_step_x), static_cast<float>(y * m_step_y)};
+    if(m_shift_x != 0 && (y % 2 != 0) == m_stagger_index_odd) {
+        origin.x += m_shift_x;
+    }
+    if(m_shift_y != 0 && (x % 2 != 0) == m_stagger_index_odd) {
+        origin.y += m_shift_y;
+    }
+    return origin;
+}
+}} // namespace salmon::internal
+
+#endif // TILE_COLLISION_GRID_HPP_INCLUDED
@@ -0,0 +1,154 @@
+/*
+ * Copyright 2017-2020 Agouti Games Team (see the AUTHORS file)
+ *
+ * This file is part of the RawSalmonEngine.
+ *
+ * The RawSalmonEngine is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * The RawSalmonEngine is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with the RawSalmonEngine.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#include "map/tile_query_grid.hpp"
+
+#include <algorithm>
+#include <cmath>
+
+#include "map/mapdata.hpp"
+#include "map/tile.hpp"
+
+namespace salmon { namespace internal {
+
+/**
+ * @brief Build the grid from the tile ids of a map layer
+ * @param map_grid The tile ids of the layer, indexed by row and column
+ * @param ts_collection The tilesets which resolve the tile ids
+ * @param base_map The map which determines the tile layout
+ */
+void TileQueryGrid::init(const std::vector<std::vector<Uint32> >& map_grid, const TilesetCollection& ts_collection, MapData& base_map) {
+    m_height = map_grid.size();
+    m_width = map_grid.empty() ? 0 : map_grid.front().size();
+    m_types.assign(m_width * m_height, 0);
+    m_flags.assign(m_width * m_height, 0);
+
+    const MapData::TileLayout layout = base_map.get_tile_layout();
+    int tile_w = static_cast<int>(ts_collection.get_tile_w());
+    int tile_h = static_cast<int>(ts_collection.get_tile_h());
+    m_step_x = tile_w;
+    m_step_y = tile_h;
+    m_shift_x = 0;
+    m_shift_y = 0;
+    m_stagger_index_odd = layout.stagger_index_odd;
+    if(layout.orientation != "orthogonal") {
+        if(layout.stagger_axis_y) {
+            m_step_y = tile_h / 2 + layout.hexsidelength / 2;
+            m_shift_x = tile_w / 2;
+        }
+        else {
+            m_step_x = tile_w / 2 + layout.hexsidelength / 2;
+            m_shift_y = tile_h / 2;
+        }
+    }
+    if(m_step_x <= 0) {m_step_x = 1;}
+    if(m_step_y <= 0) {m_step_y = 1;}
+
+    for(unsigned i_y = 0; i_y < m_height; i_y++) {
+        for(unsigned i_x = 0; i_x < m_width && i_x < map_grid[i_y].size(); i_x++) {
+            set_cell(i_x, i_y, map_grid[i_y][i_x], ts_collection);
+        }
+    }
+}
+
+/// Store the type and flags of the tile which now occupies the cell
+void TileQueryGrid::set_cell(unsigned x, unsigned y, Uint32 tile_id, const TilesetCollection& ts_collection) {
+    if(x >= m_width || y >= m_height) {return;}
+    Tile* tile = (tile_id == 0) ? nullptr : ts_collection.get_tile(tile_id);
+    unsigned index = y * m_width + x;
+    m_types[index] = (tile == nullptr) ? 0 : tile->get_type_id();
+    m_flags[index] = (tile == nullptr) ? 0 : tile->get_flags();
+}
+
+/**
+ * @brief Find the cell containing a position relative to the layer
+ * @return False if the position lies outside of the grid
+ * @note On staggered layouts the overlapping corners of neighbouring cells aren't told apart
+ */
+bool TileQueryGrid::to_cell(Point pos, unsigned& x, unsigned& y) const {
+    int i_x, i_y;
+    if(m_shift_x != 0) {
+        i_y = static_cast<int>(std::floor(pos.y / m_step_y));
+        if(is_shifted(i_y)) {pos.x -= m_shift_x;}
+        i_x = static_cast<int>(std::floor(pos.x / m_step_x));
+    }
+    else {
+        i_x = static_cast<int>(std::floor(pos.x / m_step_x));
+        if(m_shift_y != 0 && is_shifted(i_x)) {pos.y -= m_shift_y;}
+        i_y = static_cast<int>(std::floor(pos.y / m_step_y));
+    }
+    if(i_x < 0 || i_y < 0 || i_x >= static_cast<int>(m_width) || i_y >= static_cast<int>(m_height)) {return false;}
+    x = i_x;
+    y = i_y;
+    return true;
+}
+
+/**
+ * @brief Calls f with the index of each cell which overlaps area
+ * @param f Callable taking the cell index, returning true stops the iteration
+ * @return True if f stopped the iteration
+ */
+template<typename Function>
+bool TileQueryGrid::for_each_cell(const Rect& area, Function f) const {
+    if(m_width == 0 || m_height == 0) {return false;}
+    int x_from = std::max(0, static_cast<int>(std::floor((area.x - m_shift_x) / m_step_x)));
+    int y_from = std::max(0, static_cast<int>(std::floor((area.y - m_shift_y) / m_step_y)));
+    int x_to = std::min(static_cast<int>(m_width) - 1, static_cast<int>(std::floor((area.x + area.w) / m_step_x)));
+    int y_to = std::min(static_cast<int>(m_height) - 1, static_cast<int>(std::floor((area.y + area.h) / m_step_y)));
+    for(int i_y = y_from; i_y <= y_to; i_y++) {
+        for(int i_x = x_from; i_x <= x_to; i_x++) {
+            // Staggered cells may be offset, so the widened range needs an exact check
+            float cell_x = static_cast<float>(i_x * m_step_x);
+            float cell_y = static_cast<float>(i_y * m_step_y);
+            if(m_shift_x != 0 && is_shifted(i_y)) {cell_x += m_shift_x;}
+            if(m_shift_y != 0 && is_shifted(i_x)) {cell_y += m_shift_y;}
+            if(cell_x > area.x + area.w || cell_x + m_step_x <= area.x || cell_y > area.y + area.h || cell_y + m_step_y <= area.y) {continue;}
+            if(f(static_cast<unsigned>(i_y) * m_width + i_x)) {return true;}
+        }
+    }
+    return false;
+}
+
+/// Returns the type of the tile at the position, zero if there is none
+TileTypeId TileQueryGrid::get_type(Point pos) const {
+    unsigned x, y;
+    return to_cell(pos, x, y) ? m_types[y * m_width + x] : 0;
+}
+
+/// Returns the boolean properties of the tile at the position
+TileFlags TileQueryGrid::get_flags(Point pos) const {
+    unsigned x, y;
+    return to_cell(pos, x, y) ? m_flags[y * m_width + x] : 0;
+}
+
+/// Returns the union of the boolean properties of all tiles whose cells overlap area
+TileFlags TileQueryGrid::get_flags(const Rect& area) const {
+    TileFlags flags = 0;
+    for_each_cell(area, [this, &flags](unsigned index) {
+        flags |= m_flags[index];
+        return false;
+    });
+    return flags;
+}
+
+/// Returns true if any tile whose cell overlaps area has the type
+bool TileQueryGrid::has_type(const Rect& area, TileTypeId type) const {
+    return for_each_cell(area, [this, type](unsigned index) {return m_types[index] == type;});
+}
+
+}} // namespace salmon::internal
@@ -0,0 +1,70 @@
+/*
+ * Copyright 2017-2020 Agouti Games Team (see the AUTHORS file)
+ *
+ * This file is part of the RawSalmonEngine.
+ *
+ * The RawSalmonEngine is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * The RawSalmonEngine is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with the RawSalmonEngine.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#ifndef TILE_QUERY_GRID_HPP_INCLUDED
+#define TILE_QUERY_GRID_HPP_INCLUDED
+
+#include <vector>
+#include <SDL.h>
+
+#include "map/tileset_collection.hpp"
+#include "util/game_types.hpp"
+
+namespace salmon { namespace internal {
+
+class MapData;
+
+/**
+ * @brief Interned tile types and boolean tile properties of each cell of a map layer
+ *
+ * Built when the layer is loaded, so asking for the type or the flags of the tile
+ * at a position is a single array lookup, and area queries only combine the flags
+ * of the covered cells. Positions are relative to the layer origin.
+ * @note Animated tiles keep the type and flags of their first frame
+ */
+class TileQueryGrid {
+    public:
+        void init(const std::vector<std::vector<Uint32> >& map_grid, const TilesetCollection& ts_collection, MapData& base_map);
+        void set_cell(unsigned x, unsigned y, Uint32 tile_id, const TilesetCollection& ts_collection);
+
+        bool to_cell(Point pos, unsigned& x, unsigned& y) const;
+        TileTypeId get_type(Point pos) const;
+        TileFlags get_flags(Point pos) const;
+        TileFlags get_flags(const Rect& area) const;
+        bool has_type(const Rect& area, TileTypeId type) const;
+
+    private:
+        template<typename Function>
+        bool for_each_cell(const Rect& area, Function f) const;
+        bool is_shifted(int i) const {return ((i % 2) != 0) == m_stagger_index_odd;}
+
+        unsigned m_width = 0;
+        unsigned m_height = 0;
+        std::vector<TileTypeId> m_types; ///< By cell index, row major
+        std::vector<TileFlags> m_flags; ///< By cell index, row major
+
+        // Cell layout, same as in TileCollisionGrid
+        int m_step_x = 1;
+        int m_step_y = 1;
+        int m_shift_x = 0; ///< Horizontal offset of staggered rows
+        int m_shift_y = 0; ///< Vertical offset of staggered columns
+        bool m_stagger_index_odd = true;
+};
+}} // namespace salmon::internal
+
+#endif // TILE_QUERY_GRID_HPP_INCLUDED
@@ -21,6 +21,7 @@
 #include <iostream>
 #include <fstream>
 #include <sstream>
+#include <SDL_image.h>
 
 #include "core/gameinfo.hpp"
 #include "map/mapdata.hpp"
@@ -102,12 +103,13 @@ tinyxml2::XMLError Tileset::init(tinyxml2::XMLElement* ts_file, TilesetCollectio
 
     const char* p_color_key;
     p_color_key = p_image->Attribute("trans");
+    SDL_Color color_key;
     if (p_color_key == nullptr) {
         m_image = mp_ts_collection->get_mapdata().get_game().get_texture_cache().get(full_path + std::string(p_ts_source));
     }
     else {
         std::string color_string = p_color_key;
-        SDL_Color color_key = str_to_color(color_string);
+        color_key = str_to_color(color_string);
         m_image = mp_ts_collection->get_mapdata().get_game().get_texture_cache().get(full_path + std::string(p_ts_source),color_key);
     }
 
@@ -150,7 +152,8 @@ tinyxml2::XMLError Tileset::init(tinyxml2::XMLElement* ts_file, TilesetCollectio
         return XML_ERROR_PARSING;
     }
 
-    // Parse user specified properties of the tileset (only blend mode right now)
+    // Parse user specified properties of the tileset (blend mode and pixel masks)
+    bool all_masks = false;
     XMLElement* p_properties = ts_file->FirstChildElement("properties");
     if(p_properties != nullptr) {
         XMLElement* p_property = p_properties->FirstChildElement("property");
@@ -166,6 +169,13 @@ tinyxml2::XMLError Tileset::init(tinyxml2::XMLElement* ts_file, TilesetCollectio
                     return eResult;
                 }
             }
+            else if(name == "PIXEL_MASKS") {
+                eResult = p_property->QueryBoolAttribute("value", &all_masks);
+                if(eResult != XML_SUCCESS) {
+                    Logger(Logger::error) << "Failed at parsing PIXEL_MASKS for tileset: " << m_name;
+                    return eResult;
+                }
+            }
             else{
                 Logger(Logger::error) << "Unknown tileset property " << p_name << " occured in tileset: " << m_name;
                 return XML_ERROR_PARSING;
@@ -195,9 +205,63 @@ tinyxml2::XMLError Tileset::init(tinyxml2::XMLElement* ts_file, TilesetCollectio
             return eResult;
         }
     }
+
+    if(all_masks) {
+        for(Tile& tile : m_tiles) {tile.request_pixel_mask();}
+    }
+    if(!build_pixel_masks(full_path + std::string(p_ts_source), (p_color_key == nullptr) ? nullptr : &color_key)) {
+        Logger(Logger::error) << "Failed at generating the pixel masks of tileset: " << m_name;
+        return XML_ERROR_FILE_COULD_NOT_BE_OPENED;
+    }
     return XML_SUCCESS;
 }
 
+/**
+ * @brief Generate the pixel masks of all tiles which requested one
+ * @param image_path Path of the tileset image
+ * @param color_key Transparent color of the image, nullptr if it has none
+ * @return @c false if the image couldn't be loaded or converted
+ *
+ * Frames of animated tiles with a mask get one too. The image is loaded a second time
+ * because textures can't be read back, it is freed again once the masks are built.
+ */
+bool Tileset::build_pixel_masks(const std::string& image_path, const SDL_Color* color_key) {
+    bool wanted = false;
+    for(Tile& tile : m_tiles) {
+        if(!tile.wants_pixel_mask()) {continue;}
+        wanted = true;
+        for(Uint32 frame_id : tile.get_anim_ids()) {
+            Tile* frame = mp_ts_collection->get_tile(frame_id);
+            if(frame != nullptr) {frame->request_pixel_mask();}
+        }
+    }
+    if(!wanted) {return true;}
+
+    SDL_Surface* loaded = IMG_Load(image_path.c_str());
+    if(loaded == nullptr) {
+        Logger(Logger::error) << "Unable to load image " << image_path << "! SDL_image Error: " << IMG_GetError();
+        return false;
+    }
+    if(color_key != nullptr) {
+        SDL_SetColorKey(loaded, SDL_TRUE, SDL_MapRGB(loaded->format, color_key->r, color_key->g, color_key->b));
+    }
+    // The conversion turns the color key into alpha
+    SDL_Surface* image = SDL_ConvertSurfaceFormat(loaded, SDL_PIXELFORMAT_RGBA32, 0);
+    SDL_FreeSurface(loaded);
+    if(image == nullptr) {
+        Logger(Logger::error) << "Unable to convert image " << image_path << "! SDL Error: " << SDL_GetError();
+        return false;
+    }
+
+    SDL_LockSurface(image);
+    for(Tile& tile : m_tiles) {
+        if(tile.wants_pixel_mask()) {tile.build_pixel_mask(image);}
+    }
+    SDL_UnlockSurface(image);
+    SDL_FreeSurface(image);
+    return true;
+}
+
 /**
  * @brief Renders a tile of the tileset at a coordinate
  * @param x, y The specified coordinate
@@ -46,6 +46,7 @@ class Tileset{
         tinyxml2::XMLError init(tinyxml2::XMLElement* ts_file, TilesetCollection& ts_collection); // Initialize single object
 
         tinyxml2::XMLError parse_tile_info(tinyxml2::XMLElement* source);
+        bool build_pixel_masks(const std::string& image_path, const SDL_Color* color_key);
 
         const Texture* get_image_pointer() const {return &m_image;}
         TilesetCollection& get_ts_collection() const {return *mp_ts_collection;}
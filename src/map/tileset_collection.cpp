@@ -89,10 +89,16 @@ tinyxml2::XMLError TilesetCollection::init(tinyxml2::XMLElement* source, MapData
     // It calculates the minimum rendering overhang due to big tiles and tileset offsets
     write_overhang();
 
+    // This must be called after the parsing of all tilesets!
+    // It copies what map tile rendering needs into one dense array
+    build_render_infos();
+
     // This must be called after the parsing of all tilesets!
     // It sets all animated tiles to their starting positions
-    // and passes the current timestamp
-    init_anim_tiles();
+    // and passes the current timestamp of the map clock
+    init_anim_tiles(mp_base_map->get_ticks());
+
+    log_memory_usage();
 
     return XML_SUCCESS;
 }
@@ -170,29 +176,78 @@ void TilesetCollection::set_tile_animated(Tile* tile) {
     Logger(Logger::error) << "Could not find Tile to set it to animated, not in global tile list! (has no gid)";
 }
 
-/// Initializes all registered animated tiles to the current timestamp and first frame
-void TilesetCollection::init_anim_tiles() {
-    Uint32 time = SDL_GetTicks();
+/// Initializes all registered animated tiles to the supplied timestamp and first frame
+void TilesetCollection::init_anim_tiles(Uint32 time) {
+    m_anim_queue = decltype(m_anim_queue)();
+    m_changed_anim_tiles.clear();
     for(unsigned tile : m_anim_tiles) {
         mp_tiles[tile]->init_anim(time);
+        m_render_infos[tile].clip = mp_tiles[tile]->get_clip();
+        m_anim_queue.emplace(mp_tiles[tile]->get_frame_deadline(), tile);
     }
 }
 
 /**
- * @brief Animates all tiles
+ * @brief Animates all tiles whose next frame is due
+ * @param time The timestamp of the current frame
  *
- * Checks if next frame of animated tile is due, changes to next frame
- * and wraps around if required.
+ * Animated tiles are kept in a min-heap ordered by the timestamp of their next frame,
+ * so only tiles which actually change get touched. Tiles which skipped several frames
+ * (e.g. after resuming the map) catch up in a single step.
  * Passing of time is to ensure synchronity of tile animation
  */
-void TilesetCollection::push_all_anim() {
-    Uint32 time = SDL_GetTicks();
-    for(unsigned tile : m_anim_tiles) {
-        mp_tiles[tile]->push_anim(1.0f, time);
+void TilesetCollection::push_all_anim(Uint32 time) {
+    m_changed_anim_tiles.clear();
+    while(!m_anim_queue.empty() && m_anim_queue.top().first <= time) {
+        Uint32 gid = m_anim_queue.top().second;
+        m_anim_queue.pop();
+
+        Tile* tile = mp_tiles[gid];
+        int frame = tile->get_current_frame();
+        tile->push_anim(1.0f, time);
+        if(tile->get_current_frame() != frame) {
+            m_render_infos[gid].clip = tile->get_clip();
+            m_changed_anim_tiles.push_back(gid);
+        }
+        m_anim_queue.emplace(tile->get_frame_deadline(), gid);
     }
 }
 
 
+/**
+ * @brief Copies texture, clip and offsets of every tile into the dense render array
+ *
+ * Rendering a map tile then only reads one small entry instead of the whole tile and its tileset.
+ * Clips of animated tiles get updated whenever their frame changes.
+ */
+void TilesetCollection::build_render_infos() {
+    m_render_infos.assign(mp_tiles.size(), TileRenderInfo());
+    for(unsigned gid = 0; gid < mp_tiles.size(); gid++) {
+        Tile* tile = mp_tiles[gid];
+        if(tile == nullptr) {continue;}
+        const Tileset& tileset = tile->get_tileset();
+        TileRenderInfo& info = m_render_infos[gid];
+        info.image = tileset.get_image_pointer();
+        info.clip = tile->get_clip();
+        info.x_offset = tileset.get_x_offset();
+        info.y_offset = tileset.get_y_offset() - (static_cast<int>(tileset.get_tile_height()) - static_cast<int>(m_tile_h));
+    }
+}
+
+/// Logs how much memory the tiles, their extra data and the render infos take
+void TilesetCollection::log_memory_usage() const {
+    unsigned tiles = 0;
+    unsigned extra_tiles = 0;
+    std::size_t bytes = mp_tiles.capacity() * sizeof(Tile*) + m_render_infos.capacity() * sizeof(TileRenderInfo);
+    for(const Tile* tile : mp_tiles) {
+        if(tile == nullptr) {continue;}
+        tiles++;
+        if(tile->has_extra()) {extra_tiles++;}
+        bytes += tile->get_memory_usage();
+    }
+    Logger() << "Loaded " << tiles << " tiles, " << extra_tiles << " with extra data, taking " << bytes / 1024 << " KiB";
+}
+
 /// Checks for minimum of overhang values for each tileset and saves the corresponding maximum
 void TilesetCollection::write_overhang() {
     std::map<Direction, unsigned> oh;
@@ -252,7 +307,9 @@ bool TilesetCollection::render(Uint32 tile_id, int x, int y) const{
             success = false;
         }
         else {
-            mp_tiles[tile_id]->render_extra(x,y,angle, flipped_horizontally, flipped_vertically);
+            const TileRenderInfo& info = m_render_infos[tile_id];
+            SDL_Point center{(info.clip.w + 1) / 2, (info.clip.h + 1) / 2}; // Rounded half of the clip
+            info.image->render_extra(x + info.x_offset, y + info.y_offset, &info.clip, angle, flipped_horizontally, flipped_vertically, &center);
         }
         return success;
     }
@@ -263,7 +320,8 @@ bool TilesetCollection::render(Uint32 tile_id, int x, int y) const{
             success = false;
         }
         else {
-            mp_tiles[tile_id]->render(x,y);
+            const TileRenderInfo& info = m_render_infos[tile_id];
+            info.image->render(x + info.x_offset, y + info.y_offset, &info.clip);
         }
         return success;
     }
@@ -291,4 +349,50 @@ bool TilesetCollection::render(Uint32 tile_id, Rect& dest) const{
     return success;
 }
 
+
+/**
+ * @brief Returns the id of a tile type, a new one gets assigned if it wasn't known yet
+ *
+ * The empty type always has id zero.
+ */
+TileTypeId TilesetCollection::intern_tile_type(const std::string& type) {
+    if(type.empty()) {return 0;}
+    if(m_tile_types.size() == 0) {m_tile_types.intern("");}
+    unsigned id = m_tile_types.intern(type);
+    if(id > 0xFFFF) {
+        Logger(Logger::error) << "Too many distinct tile types, " << type << " is treated as untyped";
+        return 0;
+    }
+    return static_cast<TileTypeId>(id);
+}
+
+/// Returns the id of a tile type or -1 if no tile has this type
+int TilesetCollection::find_tile_type(const std::string& type) const {
+    if(type.empty()) {return 0;}
+    return m_tile_types.find(type);
+}
+
+/// Returns the name of a tile type id
+const std::string& TilesetCollection::get_tile_type_name(TileTypeId id) const {
+    static const std::string empty;
+    return (id == 0 || id >= m_tile_types.size()) ? empty : m_tile_types.get_name(id);
+}
+
+/// Returns the bit of a boolean tile property, a new one gets assigned if it wasn't known yet
+TileFlags TilesetCollection::intern_tile_flag(const std::string& name) {
+    const unsigned bits = sizeof(TileFlags) * 8;
+    unsigned id = m_tile_flags.intern(name);
+    if(id >= bits) {
+        Logger(Logger::error) << "Only " << bits << " distinct boolean tile properties are supported, " << name << " is ignored";
+        return 0;
+    }
+    return static_cast<TileFlags>(1) << id;
+}
+
+/// Returns the bit of a boolean tile property or zero if no tile has this property
+TileFlags TilesetCollection::find_tile_flag(const std::string& name) const {
+    int id = m_tile_flags.find(name);
+    if(id < 0 || id >= static_cast<int>(sizeof(TileFlags) * 8)) {return 0;}
+    return static_cast<TileFlags>(1) << id;
+}
 }} // namespace salmon::internal
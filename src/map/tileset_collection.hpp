@@ -19,16 +19,26 @@
 #ifndef TILESET_COLLECTION_HPP_INCLUDED
 #define TILESET_COLLECTION_HPP_INCLUDED
 
+#include <functional>
+#include <queue>
+#include <utility>
 #include <vector>
 #include <tinyxml2.h>
 
 #include "util/game_types.hpp"
+#include "util/symbol_table.hpp"
 
 namespace salmon { namespace internal {
 
 class Tileset; // forward declaration
 class Tile;
 class MapData;
+class Texture;
+
+/// Interned TYPE of a tile, zero is the empty type
+typedef Uint16 TileTypeId;
+/// One bit per boolean tile property, see TilesetCollection::intern_tile_flag()
+typedef Uint32 TileFlags;
 
 /**
  * @brief Manage multiple tilesets and forward to tiles by their global id (gid)
@@ -66,8 +76,16 @@ class TilesetCollection{
         void set_tile_animated(unsigned gid);
         void set_tile_animated(Tile* tile);
 
-        void init_anim_tiles();
-        void push_all_anim();
+        void init_anim_tiles(Uint32 time);
+        void push_all_anim(Uint32 time);
+        /// Return gids of all animated tiles which changed their frame during the last @c push_all_anim()
+        const std::vector<Uint32>& get_changed_anim_tiles() const {return m_changed_anim_tiles;}
+
+        TileTypeId intern_tile_type(const std::string& type);
+        int find_tile_type(const std::string& type) const;
+        const std::string& get_tile_type_name(TileTypeId id) const;
+        TileFlags intern_tile_flag(const std::string& name);
+        TileFlags find_tile_flag(const std::string& name) const;
 
         bool render(Uint32 tile_id, int x, int y) const;
         bool render(Uint32 tile_id, Rect& dest) const;
@@ -77,6 +95,17 @@ class TilesetCollection{
     private:
         MapData* mp_base_map = nullptr;
 
+        /// Everything needed to render a map tile, stored densely by gid apart from the tiles
+        struct TileRenderInfo {
+            const Texture* image = nullptr;
+            SDL_Rect clip{0,0,0,0}; ///< Clip of the current frame for animated tiles
+            int x_offset = 0; ///< Tileset offset
+            int y_offset = 0; ///< Tileset offset minus the height difference to the base tile
+        };
+
+        void build_render_infos();
+        void log_memory_usage() const;
+
         unsigned m_tile_w; // The tile dimensions in pixels
         unsigned m_tile_h;
 
@@ -89,7 +118,15 @@ class TilesetCollection{
         std::vector<Tileset> m_tilesets; ///< Contains all used Tilesets
 
         std::vector<Tile*> mp_tiles;      ///< List of pointers to all tiles in order
+        std::vector<TileRenderInfo> m_render_infos; ///< Render data of all tiles in the order of mp_tiles
         std::vector<Uint32> m_anim_tiles; ///< List of ids of all animated tiles
+
+        using AnimDeadline = std::pair<Uint32, Uint32>; ///< Timestamp of next frame and gid of an animated tile
+        std::priority_queue<AnimDeadline, std::vector<AnimDeadline>, std::greater<AnimDeadline>> m_anim_queue;
+        std::vector<Uint32> m_changed_anim_tiles; ///< Gids of animated tiles which changed frame on last push
+
+        SymbolTable m_tile_types; ///< TYPE values of all tiles
+        SymbolTable m_tile_flags; ///< Names of all boolean tile properties, the id is the bit index
 };
 }} // namespace salmon::internal
 
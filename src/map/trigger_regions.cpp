@@ -0,0 +1,272 @@
+/*
+ * Copyright 2017-2020 Agouti Games Team (see the AUTHORS file)
+ *
+ * This file is part of the RawSalmonEngine.
+ *
+ * The RawSalmonEngine is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * The RawSalmonEngine is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with the RawSalmonEngine.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#include "map/trigger_regions.hpp"
+
+#include <algorithm>
+#include <cstdlib>
+
+#include "actor/actor.hpp"
+#include "map/object_layer.hpp"
+#include "util/logger.hpp"
+
+namespace salmon { namespace internal {
+
+namespace {
+/// Returns true if the segment from a to b crosses rect, Liang-Barsky clipping
+bool segment_hits_rect(Point a, Point b, const Rect& rect) {
+    float t_from = 0.0f;
+    float t_to = 1.0f;
+    float dx = b.x - a.x;
+    float dy = b.y - a.y;
+    const float p[4] = {-dx, dx, -dy, dy};
+    const float q[4] = {a.x - rect.x, rect.x + rect.w - a.x, a.y - rect.y, rect.y + rect.h - a.y};
+    for(int i = 0; i < 4; i++) {
+        if(p[i] == 0.0f) {
+            if(q[i] < 0.0f) {return false;}
+            continue;
+        }
+        float t = q[i] / p[i];
+        if(p[i] < 0.0f) {t_from = std::max(t_from, t);}
+        else {t_to = std::min(t_to, t);}
+        if(t_from > t_to) {return false;}
+    }
+    return true;
+}
+} // namespace
+
+/// Returns true if rect overlaps the region
+bool TriggerRegion::overlaps(const Rect& rect) const {
+    if(!bounds.has_intersection(rect)) {return false;}
+    if(polygon.empty()) {return true;}
+    // Rect contains the polygon or the polygon contains rect
+    if(rect.has_intersection(polygon.front()) || contains(Point{rect.x, rect.y})) {return true;}
+    for(unsigned i = 0; i < polygon.size(); i++) {
+        if(segment_hits_rect(polygon[i], polygon[(i + 1) % polygon.size()], rect)) {return true;}
+    }
+    return false;
+}
+
+/// Returns true if the point lies within the region, polygons use the even odd rule
+bool TriggerRegion::contains(Point point) const {
+    if(!bounds.has_intersection(point)) {return false;}
+    bool inside = false;
+    for(unsigned i = 0, j = polygon.size() - 1; i < polygon.size(); j = i++) {
+        const Point& a = polygon[i];
+        const Point& b = polygon[j];
+        if((a.y > point.y) != (b.y > point.y) && point.x < (b.x - a.x) * (point.y - a.y) / (b.y - a.y) + a.x) {
+            inside = !inside;
+        }
+    }
+    return polygon.empty() || inside;
+}
+
+/// Returns true if the object has the bool property TRIGGER set to true
+bool TriggerRegions::is_trigger(tinyxml2::XMLElement* source) {
+    tinyxml2::XMLElement* p_properties = source->FirstChildElement("properties");
+    if(p_properties == nullptr) {return false;}
+    for(tinyxml2::XMLElement* p_property = p_properties->FirstChildElement("property"); p_property != nullptr;
+        p_property = p_property->NextSiblingElement("property")) {
+        const char* p_name = p_property->Attribute("name");
+        if(p_name != nullptr && std::string(p_name) == "TRIGGER") {
+            bool trigger = false;
+            p_property->QueryBoolAttribute("value", &trigger);
+            return trigger;
+        }
+    }
+    return false;
+}
+
+/**
+ * @brief Parse a rectangle or polygon object into a trigger region
+ * @param source The object element
+ * @param offset The position of the object layer
+ * @return @c XMLError which indicates failure or sucess of parsing
+ * @note Rotated objects aren't supported, the rotation gets ignored
+ */
+tinyxml2::XMLError TriggerRegions::add(tinyxml2::XMLElement* source, Point offset) {
+    using namespace tinyxml2;
+    TriggerRegion region;
+    const char* p_name = source->Attribute("name");
+    region.name = (p_name != nullptr) ? p_name : "";
+
+    float x = 0, y = 0, w = 0, h = 0;
+    if(source->QueryFloatAttribute("x", &x) != XML_SUCCESS || source->QueryFloatAttribute("y", &y) != XML_SUCCESS) {
+        Logger(Logger::error) << "Trigger " << region.name << " has no position";
+        return XML_ERROR_PARSING_ATTRIBUTE;
+    }
+    x += offset.x;
+    y += offset.y;
+
+    XMLElement* p_polygon = source->FirstChildElement("polygon");
+    if(p_polygon != nullptr) {
+        const char* p_points = p_polygon->Attribute("points");
+        if(p_points == nullptr) {
+            Logger(Logger::error) << "Trigger polygon " << region.name << " has no points";
+            return XML_ERROR_PARSING_ATTRIBUTE;
+        }
+        // Points are pairs "x,y" separated by spaces
+        char* end = nullptr;
+        const char* pos = p_points;
+        while(true) {
+            float p_x = std::strtof(pos, &end);
+            if(end == pos || *end != ',') {break;}
+            pos = end + 1;
+            float p_y = std::strtof(pos, &end);
+            if(end == pos) {break;}
+            pos = end;
+            region.polygon.push_back({x + p_x, y + p_y});
+        }
+        if(region.polygon.size() < 3) {
+            Logger(Logger::error) << "Trigger polygon " << region.name << " has less than three points";
+            return XML_ERROR_PARSING_ATTRIBUTE;
+        }
+        float x_min = region.polygon.front().x, x_max = x_min;
+        float y_min = region.polygon.front().y, y_max = y_min;
+        for(const Point& p : region.polygon) {
+            x_min = std::min(x_min, p.x);
+            x_max = std::max(x_max, p.x);
+            y_min = std::min(y_min, p.y);
+            y_max = std::max(y_max, p.y);
+        }
+        region.bounds = {x_min, y_min, x_max - x_min, y_max - y_min};
+    }
+    else if(source->FirstChildElement("ellipse") != nullptr || source->FirstChildElement("point") != nullptr ||
+            source->FirstChildElement("polyline") != nullptr || source->FirstChildElement("text") != nullptr) {
+        Logger(Logger::error) << "Trigger " << region.name << " has to be a rectangle or polygon";
+        return XML_ERROR_PARSING_ELEMENT;
+    }
+    else {
+        source->QueryFloatAttribute("width", &w);
+        source->QueryFloatAttribute("height", &h);
+        region.bounds = {x, y, w, h};
+    }
+
+    // Optional hitbox of the actors to check
+    XMLElement* p_properties = source->FirstChildElement("properties");
+    XMLElement* p_property = (p_properties != nullptr) ? p_properties->FirstChildElement("property") : nullptr;
+    while(p_property != nullptr) {
+        const char* p_property_name = p_property->Attribute("name");
+        const char* p_value = p_property->Attribute("value");
+        if(p_property_name != nullptr && std::string(p_property_name) == "TRIGGER_HITBOX" && p_value != nullptr) {
+            region.hitbox = HitboxSet::get_id(p_value);
+        }
+        p_property = p_property->NextSiblingElement("property");
+    }
+
+    if(region.bounds.empty()) {
+        Logger(Logger::error) << "Trigger " << region.name << " has no area";
+        return XML_ERROR_PARSING_ATTRIBUTE;
+    }
+    m_index.insert(m_regions.size(), region.bounds);
+    m_regions.push_back(std::move(region));
+    return XML_SUCCESS;
+}
+
+void TriggerRegions::clear() {
+    m_regions.clear();
+    m_index.clear();
+    m_states.clear();
+}
+
+/**
+ * @brief Send enter, stay and exit events to the actors of the layers
+ *
+ * Actors whose hitboxes didn't change since the last update stay in the same regions.
+ * Removed actors are forgotten without an exit event.
+ */
+void TriggerRegions::update(const std::vector<ObjectLayer*>& layers) {
+    if(m_regions.empty()) {return;}
+    m_pass++;
+    for(ObjectLayer* layer : layers) {
+        layer->for_each_actor([this](Actor* actor) {
+            ActorHandle handle = actor->get_handle();
+            if(handle.index >= m_states.size()) {m_states.resize(handle.index + 1);}
+            ActorState& state = m_states[handle.index];
+            state.seen = m_pass;
+            unsigned generation = actor->get_hitbox_generation();
+            if(state.handle == handle && state.hitbox_generation == generation) {
+                for(Uint32 region : state.inside) {
+                    actor->add_collision(CollisionRecord::make_trigger(&m_regions[region], TriggerEvent::stay, m_regions[region].hitbox, get_contact(*actor, region)));
+                }
+                return;
+            }
+            if(state.handle != handle) {state.inside.clear();}
+            state.handle = handle;
+            state.hitbox_generation = generation;
+
+            // Merge the sorted lists of regions of the last and of this update
+            find_regions(*actor, m_found);
+            auto old_it = state.inside.begin();
+            auto new_it = m_found.begin();
+            while(old_it != state.inside.end() || new_it != m_found.end()) {
+                if(new_it == m_found.end() || (old_it != state.inside.end() && *old_it < *new_it)) {
+                    const TriggerRegion& region = m_regions[*old_it++];
+                    actor->add_collision(CollisionRecord::make_trigger(&region, TriggerEvent::exit, region.hitbox, Rect()));
+                }
+                else {
+                    bool stay = old_it != state.inside.end() && *old_it == *new_it;
+                    if(stay) {old_it++;}
+                    Uint32 index = *new_it++;
+                    actor->add_collision(CollisionRecord::make_trigger(&m_regions[index], stay ? TriggerEvent::stay : TriggerEvent::enter,
+                                                                       m_regions[index].hitbox, get_contact(*actor, index)));
+                }
+            }
+            state.inside.swap(m_found);
+        });
+    }
+
+    for(ActorState& state : m_states) {
+        if(state.seen != m_pass && state.handle.valid()) {state = ActorState();}
+    }
+}
+
+/// Collect the sorted indices of all regions which overlap the matching hitbox of the actor
+void TriggerRegions::find_regions(const Actor& actor, std::vector<Uint32>& regions) const {
+    regions.clear();
+    const HitboxSet& hitboxes = actor.get_hitboxes();
+    // Hitboxes may reach past the transform, so the regions get looked up by the hitboxes themselves
+    Rect bounds;
+    for(const auto& hitbox : hitboxes) {
+        if(hitbox.rect.empty()) {continue;}
+        if(bounds.empty()) {
+            bounds = hitbox.rect;
+            continue;
+        }
+        float right = std::max(bounds.x + bounds.w, hitbox.rect.x + hitbox.rect.w);
+        float bottom = std::max(bounds.y + bounds.h, hitbox.rect.y + hitbox.rect.h);
+        bounds.x = std::min(bounds.x, hitbox.rect.x);
+        bounds.y = std::min(bounds.y, hitbox.rect.y);
+        bounds.w = right - bounds.x;
+        bounds.h = bottom - bounds.y;
+    }
+    if(bounds.empty()) {return;}
+    m_index.query(bounds, [&](Uint32 index) {
+        const Rect* hitbox = hitboxes.find(m_regions[index].hitbox);
+        if(hitbox != nullptr && m_regions[index].overlaps(*hitbox)) {regions.push_back(index);}
+    });
+    std::sort(regions.begin(), regions.end());
+}
+
+/// Returns the intersection of the checked hitbox of the actor and the bounds of the region
+Rect TriggerRegions::get_contact(const Actor& actor, Uint32 region) const {
+    const Rect* hitbox = actor.get_hitboxes().find(m_regions[region].hitbox);
+    return (hitbox == nullptr) ? Rect() : hitbox->get_intersection(m_regions[region].bounds);
+}
+
+}} // namespace salmon::internal
@@ -0,0 +1,85 @@
+/*
+ * Copyright 2017-2020 Agouti Games Team (see the AUTHORS file)
+ *
+ * This file is part of the RawSalmonEngine.
+ *
+ * The RawSalmonEngine is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * The RawSalmonEngine is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with the RawSalmonEngine.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#ifndef TRIGGER_REGIONS_HPP_INCLUDED
+#define TRIGGER_REGIONS_HPP_INCLUDED
+
+#include <string>
+#include <vector>
+#include <tinyxml2.h>
+
+#include "util/game_types.hpp"
+#include "util/hitbox_set.hpp"
+#include "util/slot_map.hpp"
+#include "util/spatial_hash.hpp"
+
+namespace salmon { namespace internal {
+
+class Actor;
+class ObjectLayer;
+
+/// An area of an object layer which reports actors entering and leaving it
+struct TriggerRegion {
+    std::string name;
+    Rect bounds; ///< In world coordinates
+    std::vector<Point> polygon; ///< Corners in world coordinates, empty for rectangles
+    HitboxId hitbox = HitboxSet::default_id; ///< The actor hitbox which gets checked, set by TRIGGER_HITBOX
+
+    bool overlaps(const Rect& rect) const;
+    bool contains(Point point) const;
+};
+
+/**
+ * @brief All trigger regions of a map, which emit enter, stay and exit events to actors
+ *
+ * Rectangle and polygon objects with the bool property TRIGGER become regions.
+ * The regions are kept in a SpatialHash. Each update only actors whose transform
+ * changed get checked against it, all others keep their regions from the last update.
+ * The events get delivered as collisions of the actors.
+ */
+class TriggerRegions {
+    public:
+        static bool is_trigger(tinyxml2::XMLElement* source);
+        tinyxml2::XMLError add(tinyxml2::XMLElement* source, Point offset);
+        void clear();
+        void set_cell_size(float size) {m_index.set_cell_size(size);}
+
+        bool empty() const {return m_regions.empty();}
+        void update(const std::vector<ObjectLayer*>& layers);
+
+    private:
+        /// Regions overlapped by an actor at the last update
+        struct ActorState {
+            SlotHandle handle;
+            unsigned hitbox_generation = 0; ///< See Actor::get_hitbox_generation()
+            unsigned seen = 0; ///< Update which found the actor last
+            std::vector<Uint32> inside; ///< Indices of the regions, sorted
+        };
+
+        void find_regions(const Actor& actor, std::vector<Uint32>& regions) const;
+        Rect get_contact(const Actor& actor, Uint32 region) const;
+
+        std::vector<TriggerRegion> m_regions;
+        SpatialHash m_index; ///< Bounds of m_regions by index
+        std::vector<ActorState> m_states; ///< By actor slot index
+        unsigned m_pass = 0;
+        std::vector<Uint32> m_found; ///< Scratch buffer of update()
+};
+}} // namespace salmon::internal
+
+#endif // TRIGGER_REGIONS_HPP_INCLUDED
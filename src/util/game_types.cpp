@@ -18,7 +18,9 @@
  */
 #include "util/game_types.hpp"
 #include <iostream>
+#include <algorithm>
 #include <cmath>
+#include <limits>
 
 #include <experimental/filesystem>
 
@@ -50,6 +52,18 @@ std::vector<float> dir_to_mov(const Direction dir) {
     else return std::vector<float>{0,0};
 }
 
+/**
+ * @brief Converts a @c Direction to a dense index for table lookups
+ * @return Index from 0 to 7 for the cardinal directions, 8 for @c Direction::none
+ *         and @c DIRECTION_COUNT for directions which can't be stored
+ */
+unsigned dir_to_index(const Direction dir) {
+    int value = static_cast<int>(dir);
+    if(dir == Direction::none) return DIRECTION_COUNT - 1;
+    if(value < 0 || value % 45 != 0 || value >= 360) return DIRECTION_COUNT;
+    return value / 45;
+}
+
 /// Converts a @c string to an @c SDL_Color
 /// @note Format is #RRGGBB or #AARRGGBB, or RRGGBB or AARRGGBB, no error checking!
 SDL_Color str_to_color(const std::string& name) {
@@ -89,6 +103,64 @@ Point rect_center_difference(const Rect& first, const Rect& second) {
     return {second_center.x - first_center.x, second_center.y - first_center.y};
 }
 
+/**
+ * @brief Calculate when a moving rect first touches a resting one
+ * @param moving The moving rect at the start of its movement
+ * @param motion The full movement vector
+ * @param other The resting rect
+ * @param fraction The earliest impact found so far, gets lowered on an earlier impact
+ * @param normal Gets set to the surface normal of other on an earlier impact
+ * @return True if the impact lies before fraction
+ *
+ * Rects which already overlap at the start of the movement are ignored, so an
+ * actor is always able to leave an obstacle it got stuck in.
+ */
+bool sweep_rect(const Rect& moving, const Point& motion, const Rect& other, float& fraction, Point& normal) {
+    const float inf = std::numeric_limits<float>::infinity();
+    float x_entry, x_exit, y_entry, y_exit;
+
+    if(motion.x > 0) {
+        x_entry = (other.x - (moving.x + moving.w)) / motion.x;
+        x_exit = (other.x + other.w - moving.x) / motion.x;
+    }
+    else if(motion.x < 0) {
+        x_entry = (other.x + other.w - moving.x) / motion.x;
+        x_exit = (other.x - (moving.x + moving.w)) / motion.x;
+    }
+    else if(moving.x < other.x + other.w && moving.x + moving.w > other.x) {
+        x_entry = -inf;
+        x_exit = inf;
+    }
+    else {return false;}
+
+    if(motion.y > 0) {
+        y_entry = (other.y - (moving.y + moving.h)) / motion.y;
+        y_exit = (other.y + other.h - moving.y) / motion.y;
+    }
+    else if(motion.y < 0) {
+        y_entry = (other.y + other.h - moving.y) / motion.y;
+        y_exit = (other.y - (moving.y + moving.h)) / motion.y;
+    }
+    else if(moving.y < other.y + other.h && moving.y + moving.h > other.y) {
+        y_entry = -inf;
+        y_exit = inf;
+    }
+    else {return false;}
+
+    float entry = std::max(x_entry, y_entry);
+    float exit = std::min(x_exit, y_exit);
+    if(entry >= exit || entry < 0.0f || entry >= fraction) {return false;}
+
+    fraction = entry;
+    if(x_entry > y_entry) {
+        normal = {(motion.x > 0) ? -1.0f : 1.0f, 0.0f};
+    }
+    else {
+        normal = {0.0f, (motion.y > 0) ? -1.0f : 1.0f};
+    }
+    return true;
+}
+
 PixelRect make_rect(const SDL_Rect& rect) {
     return PixelRect{rect.x,rect.y,rect.w,rect.h};
 }
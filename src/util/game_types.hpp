@@ -36,10 +36,15 @@ SDL_Color str_to_color(const std::string& name);
 void make_path_absolute(std::string& path);
 
 Point rect_center_difference(const Rect& first, const Rect& second);
+bool sweep_rect(const Rect& moving, const Point& motion, const Rect& other, float& fraction, Point& normal);
 PixelRect make_rect(const SDL_Rect& rect);
 SDL_Rect make_rect(const PixelRect& rect);
 
 std::vector<float> dir_to_mov(const Direction dir);
+
+/// Number of directions which may carry an animation, including @c Direction::none
+const unsigned DIRECTION_COUNT = 9;
+unsigned dir_to_index(const Direction dir);
 void normalize(float& x, float& y);
 
 // Return true if line1 and line2 overlap
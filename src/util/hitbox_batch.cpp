@@ -0,0 +1,203 @@
+/*
+ * Copyright 2017-2020 Agouti Games Team (see the AUTHORS file)
+ *
+ * This file is part of the RawSalmonEngine.
+ *
+ * The RawSalmonEngine is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * The RawSalmonEngine is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with the RawSalmonEngine.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#include "util/hitbox_batch.hpp"
+
+#include <limits>
+
+// The AVX kernel is built with a target attribute on x86 and picked at runtime
+// if the CPU supports AVX, unless the whole build already targets AVX
+#if defined(__AVX__)
+    #define HITBOX_BATCH_AVX
+#elif (defined(__GNUC__) || defined(__clang__)) && (defined(__x86_64__) || defined(__i386__))
+    #define HITBOX_BATCH_AVX
+    #define HITBOX_BATCH_AVX_DISPATCH
+#endif
+#if defined(__SSE2__)
+    #define HITBOX_BATCH_SSE2
+#endif
+
+#if defined(HITBOX_BATCH_AVX)
+    #include <immintrin.h>
+#elif defined(HITBOX_BATCH_SSE2)
+    #include <emmintrin.h>
+#endif
+
+#if defined(HITBOX_BATCH_AVX_DISPATCH)
+    #define HITBOX_BATCH_TARGET_AVX __attribute__((target("avx")))
+#else
+    #define HITBOX_BATCH_TARGET_AVX
+#endif
+
+namespace salmon { namespace internal {
+
+namespace {
+/// A query box and the padded edge arrays it gets tested against
+struct Query {
+    float left;
+    float top;
+    float right;
+    float bottom;
+    const float* lefts;
+    const float* tops;
+    const float* rights;
+    const float* bottoms;
+    unsigned from;
+    unsigned count;
+};
+
+/// Append the indices of the set lanes of mask, starting at index i
+inline void push_matches(int mask, unsigned i, const Query& q, std::vector<unsigned>& matches) {
+    while(mask != 0) {
+        unsigned lane = 0;
+        while(!(mask & (1 << lane))) {lane++;}
+        mask &= ~(1 << lane);
+        unsigned index = i + lane;
+        if(index >= q.from && index < q.count) {
+            matches.push_back(index);
+        }
+    }
+}
+
+void query_scalar(const Query& q, std::vector<unsigned>& matches) {
+    for(unsigned i = q.from; i < q.count; i++) {
+        if(q.left < q.rights[i] && q.lefts[i] < q.right && q.top < q.bottoms[i] && q.tops[i] < q.bottom) {
+            matches.push_back(i);
+        }
+    }
+}
+
+#if defined(HITBOX_BATCH_SSE2)
+void query_sse2(const Query& q, std::vector<unsigned>& matches) {
+    const unsigned width = 4;
+    const __m128 q_left = _mm_set1_ps(q.left);
+    const __m128 q_top = _mm_set1_ps(q.top);
+    const __m128 q_right = _mm_set1_ps(q.right);
+    const __m128 q_bottom = _mm_set1_ps(q.bottom);
+    for(unsigned i = q.from - q.from % width; i < q.count; i += width) {
+        __m128 x = _mm_and_ps(_mm_cmplt_ps(q_left, _mm_loadu_ps(&q.rights[i])),
+                              _mm_cmplt_ps(_mm_loadu_ps(&q.lefts[i]), q_right));
+        __m128 y = _mm_and_ps(_mm_cmplt_ps(q_top, _mm_loadu_ps(&q.bottoms[i])),
+                              _mm_cmplt_ps(_mm_loadu_ps(&q.tops[i]), q_bottom));
+        push_matches(_mm_movemask_ps(_mm_and_ps(x, y)), i, q, matches);
+    }
+}
+#endif
+
+#if defined(HITBOX_BATCH_AVX)
+HITBOX_BATCH_TARGET_AVX void query_avx(const Query& q, std::vector<unsigned>& matches) {
+    const unsigned width = 8;
+    const __m256 q_left = _mm256_set1_ps(q.left);
+    const __m256 q_top = _mm256_set1_ps(q.top);
+    const __m256 q_right = _mm256_set1_ps(q.right);
+    const __m256 q_bottom = _mm256_set1_ps(q.bottom);
+    for(unsigned i = q.from - q.from % width; i < q.count; i += width) {
+        __m256 x = _mm256_and_ps(_mm256_cmp_ps(q_left, _mm256_loadu_ps(&q.rights[i]), _CMP_LT_OQ),
+                                 _mm256_cmp_ps(_mm256_loadu_ps(&q.lefts[i]), q_right, _CMP_LT_OQ));
+        __m256 y = _mm256_and_ps(_mm256_cmp_ps(q_top, _mm256_loadu_ps(&q.bottoms[i]), _CMP_LT_OQ),
+                                 _mm256_cmp_ps(_mm256_loadu_ps(&q.tops[i]), q_bottom, _CMP_LT_OQ));
+        push_matches(_mm256_movemask_ps(_mm256_and_ps(x, y)), i, q, matches);
+    }
+}
+#endif
+
+typedef void (*QueryKernel)(const Query& q, std::vector<unsigned>& matches);
+
+/// The widest kernel which the build and the CPU support
+QueryKernel select_kernel() {
+#if defined(HITBOX_BATCH_AVX_DISPATCH)
+    __builtin_cpu_init();
+    if(__builtin_cpu_supports("avx")) {return query_avx;}
+#elif defined(HITBOX_BATCH_AVX)
+    return query_avx;
+#endif
+#if defined(HITBOX_BATCH_SSE2)
+    return query_sse2;
+#else
+    return query_scalar;
+#endif
+}
+
+QueryKernel get_kernel() {
+    static const QueryKernel kernel = select_kernel();
+    return kernel;
+}
+} // namespace
+
+/// Remove all hitboxes
+void HitboxBatch::clear() {
+    m_left.clear();
+    m_top.clear();
+    m_right.clear();
+    m_bottom.clear();
+    m_rects.clear();
+    m_owner.clear();
+    m_id.clear();
+}
+
+/**
+ * @brief Append a hitbox, empty ones are skipped
+ * @param rect The hitbox in world coordinates
+ * @param owner Caller defined index of the object owning the hitbox
+ * @param id The interned name of the hitbox
+ */
+void HitboxBatch::push(const Rect& rect, unsigned owner, HitboxId id) {
+    if(rect.empty()) {return;}
+    unsigned index = m_owner.size();
+    m_rects.push_back(rect);
+    m_owner.push_back(owner);
+    m_id.push_back(id);
+
+    if(index == m_left.size()) {
+        // Grow by one block of padding boxes
+        const float inf = std::numeric_limits<float>::infinity();
+        m_left.resize(index + lanes, inf);
+        m_top.resize(index + lanes, inf);
+        m_right.resize(index + lanes, -inf);
+        m_bottom.resize(index + lanes, -inf);
+    }
+    m_left[index] = rect.x;
+    m_top[index] = rect.y;
+    m_right[index] = rect.x + rect.w;
+    m_bottom[index] = rect.y + rect.h;
+}
+
+/**
+ * @brief Find all hitboxes intersecting rect
+ * @param rect The hitbox to test against
+ * @param from Index of the first hitbox to test
+ * @param matches Receives the indices of all intersecting hitboxes in ascending order
+ */
+void HitboxBatch::query(const Rect& rect, unsigned from, std::vector<unsigned>& matches) const {
+    if(rect.empty()) {return;}
+    Query q{rect.x, rect.y, rect.x + rect.w, rect.y + rect.h,
+            m_left.data(), m_top.data(), m_right.data(), m_bottom.data(), from, size()};
+    get_kernel()(q, matches);
+}
+
+/// Returns the name of the kernel query() uses on this CPU
+const char* HitboxBatch::get_kernel_name() {
+    QueryKernel kernel = get_kernel();
+    if(kernel == query_scalar) {return "scalar";}
+#if defined(HITBOX_BATCH_SSE2)
+    if(kernel == query_sse2) {return "SSE2";}
+#endif
+    return "AVX";
+}
+
+}} // namespace salmon::internal
@@ -0,0 +1,67 @@
+/*
+ * Copyright 2017-2020 Agouti Games Team (see the AUTHORS file)
+ *
+ * This file is part of the RawSalmonEngine.
+ *
+ * The RawSalmonEngine is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * The RawSalmonEngine is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with the RawSalmonEngine.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#ifndef HITBOX_BATCH_HPP_INCLUDED
+#define HITBOX_BATCH_HPP_INCLUDED
+
+#include <vector>
+
+#include "util/game_types.hpp"
+#include "util/hitbox_set.hpp"
+
+namespace salmon { namespace internal {
+
+/**
+ * @brief World space hitboxes of many owners stored as structure of arrays
+ *
+ * Edges are kept in separate float arrays so one query rect gets tested against
+ * several hitboxes at once. Uses AVX for 8 or SSE2 for 4 hitboxes per instruction,
+ * depending on the target architecture, and plain scalar code otherwise.
+ * On x86 the AVX kernel gets picked at runtime if the CPU supports it.
+ * The intersection test gives the same results as Rect::has_intersection().
+ */
+class HitboxBatch {
+    public:
+        void clear();
+        void push(const Rect& rect, unsigned owner, HitboxId id);
+
+        void query(const Rect& rect, unsigned from, std::vector<unsigned>& matches) const;
+
+        unsigned size() const {return m_owner.size();}
+        unsigned get_owner(unsigned index) const {return m_owner[index];}
+        HitboxId get_id(unsigned index) const {return m_id[index];}
+        const Rect& get_rect(unsigned index) const {return m_rects[index];}
+
+        static const char* get_kernel_name();
+
+        static const unsigned lanes = 8; ///< Arrays get padded to a multiple of this
+
+    private:
+        // Padded with boxes which never intersect
+        std::vector<float> m_left;
+        std::vector<float> m_top;
+        std::vector<float> m_right;
+        std::vector<float> m_bottom;
+
+        std::vector<Rect> m_rects;
+        std::vector<unsigned> m_owner;
+        std::vector<HitboxId> m_id;
+};
+}} // namespace salmon::internal
+
+#endif // HITBOX_BATCH_HPP_INCLUDED
@@ -0,0 +1,103 @@
+/*
+ * Copyright 2017-2020 Agouti Games Team (see the AUTHORS file)
+ *
+ * This file is part of the RawSalmonEngine.
+ *
+ * The RawSalmonEngine is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * The RawSalmonEngine is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with the RawSalmonEngine.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#include "util/hitbox_set.hpp"
+
+#include "util/symbol_table.hpp"
+
+namespace salmon { namespace internal {
+
+namespace {
+/// Global table of hitbox names, DEFAULT_HITBOX always gets id 0
+SymbolTable& hitbox_names() {
+    static SymbolTable names = [] {
+        SymbolTable table;
+        table.intern(DEFAULT_HITBOX);
+        return table;
+    }();
+    return names;
+}
+} // anonymous namespace
+
+const unsigned HitboxSet::capacity;
+const HitboxId HitboxSet::default_id;
+
+/// Returns the id of a hitbox name, interning it if it is new
+HitboxId HitboxSet::get_id(const std::string& name) {
+    return static_cast<HitboxId>(hitbox_names().intern(name));
+}
+
+/// Returns the id of a hitbox name or -1 if no hitbox is called like this
+int HitboxSet::find_id(const std::string& name) {
+    return hitbox_names().find(name);
+}
+
+/// Returns the name of an interned hitbox id
+const std::string& HitboxSet::get_name(HitboxId id) {
+    return hitbox_names().get_name(id);
+}
+
+/**
+ * @brief Add or replace a hitbox
+ * @return false if the set is already full
+ */
+bool HitboxSet::set(HitboxId id, const Rect& rect) {
+    for(Entry& entry : *this) {
+        if(entry.id == id) {
+            entry.rect = rect;
+            return true;
+        }
+    }
+    if(m_size >= capacity) {return false;}
+    m_entries[m_size++] = {id, rect};
+    return true;
+}
+
+/// Returns pointer to the hitbox with the given id or nullptr if there is none
+const Rect* HitboxSet::find(HitboxId id) const {
+    for(const Entry& entry : *this) {
+        if(entry.id == id) {return &entry.rect;}
+    }
+    return nullptr;
+}
+
+/// Returns the hitbox with the given id or an empty one if there is none
+Rect HitboxSet::get(HitboxId id) const {
+    const Rect* rect = find(id);
+    return (rect == nullptr) ? Rect{0,0,0,0} : *rect;
+}
+
+/// Adds all hitboxes of other, overriding existing ones of the same name
+void HitboxSet::merge(const HitboxSet& other) {
+    for(const Entry& entry : other) {
+        set(entry.id, entry.rect);
+    }
+}
+
+/// Returns true if both sets hold the same hitboxes in the same order
+bool HitboxSet::operator==(const HitboxSet& other) const {
+    if(m_size != other.m_size) {return false;}
+    for(unsigned i = 0; i < m_size; i++) {
+        const Entry& a = m_entries[i];
+        const Entry& b = other.m_entries[i];
+        if(a.id != b.id || a.rect.x != b.rect.x || a.rect.y != b.rect.y || a.rect.w != b.rect.w || a.rect.h != b.rect.h) {return false;}
+    }
+    return true;
+}
+
+}} // namespace salmon::internal
@@ -0,0 +1,76 @@
+/*
+ * Copyright 2017-2020 Agouti Games Team (see the AUTHORS file)
+ *
+ * This file is part of the RawSalmonEngine.
+ *
+ * The RawSalmonEngine is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * The RawSalmonEngine is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with the RawSalmonEngine.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#ifndef HITBOX_SET_HPP_INCLUDED
+#define HITBOX_SET_HPP_INCLUDED
+
+#include <array>
+#include <string>
+#include <SDL.h>
+
+#include "util/game_types.hpp"
+
+namespace salmon { namespace internal {
+
+/// Interned name of a hitbox, see HitboxSet::get_id()
+typedef Uint16 HitboxId;
+
+/**
+ * @brief Fixed size collection of named hitboxes
+ *
+ * Hitbox names are interned once into ids shared by all tiles and actors,
+ * so lookups, merging and copying never allocate.
+ */
+class HitboxSet {
+    public:
+        struct Entry {
+            HitboxId id;
+            Rect rect;
+        };
+
+        static const unsigned capacity = 8; ///< Maximum number of hitboxes per tile
+        static const HitboxId default_id = 0; ///< Id of DEFAULT_HITBOX
+
+        static HitboxId get_id(const std::string& name);
+        static int find_id(const std::string& name);
+        static const std::string& get_name(HitboxId id);
+
+        bool set(HitboxId id, const Rect& rect);
+        const Rect* find(HitboxId id) const;
+        Rect get(HitboxId id) const;
+        void merge(const HitboxSet& other);
+
+        bool operator==(const HitboxSet& other) const;
+        bool operator!=(const HitboxSet& other) const {return !(*this == other);}
+
+        void clear() {m_size = 0;}
+        bool empty() const {return m_size == 0;}
+        unsigned size() const {return m_size;}
+
+        Entry* begin() {return m_entries.data();}
+        Entry* end() {return m_entries.data() + m_size;}
+        const Entry* begin() const {return m_entries.data();}
+        const Entry* end() const {return m_entries.data() + m_size;}
+
+    private:
+        std::array<Entry, capacity> m_entries;
+        unsigned m_size = 0;
+};
+}} // namespace salmon::internal
+
+#endif // HITBOX_SET_HPP_INCLUDED
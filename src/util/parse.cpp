@@ -82,7 +82,7 @@ tinyxml2::XMLError parse::hitbox(tinyxml2::XMLElement* source, Rect& rect) {
  * @param rects The rects which get produced
  * @return @c XMLError Indicating success or failure
  */
-tinyxml2::XMLError parse::hitboxes(tinyxml2::XMLElement* source, std::map<std::string, Rect>& rects) {
+tinyxml2::XMLError parse::hitboxes(tinyxml2::XMLElement* source, HitboxSet& rects) {
     using namespace tinyxml2;
     XMLError eResult;
 
@@ -123,12 +123,16 @@ tinyxml2::XMLError parse::hitboxes(tinyxml2::XMLElement* source, std::map<std::s
         if(eResult != XML_SUCCESS) return eResult;
         temp_rec.h = temp;
 
-        if(rects.find(name) != rects.end()) {
+        HitboxId id = HitboxSet::get_id(name);
+        if(rects.find(id) != nullptr) {
             Logger(Logger::error) << "Possible multiple definition of hitbox: " << name << " !";
             return XML_ERROR_PARSING_ATTRIBUTE;
         }
 
-        rects[name] = temp_rec;
+        if(!rects.set(id, temp_rec)) {
+            Logger(Logger::error) << "Too many hitboxes, at most " << HitboxSet::capacity << " are supported per tile!";
+            return XML_ERROR_PARSING_ATTRIBUTE;
+        }
 
         source = source->NextSiblingElement("object");
     }
@@ -26,6 +26,7 @@
 #include <tinyxml2.h>
 
 #include "util/game_types.hpp"
+#include "util/hitbox_set.hpp"
 
 namespace salmon { namespace internal {
 
@@ -33,7 +34,7 @@ class Texture;
 
 namespace parse{
     tinyxml2::XMLError hitbox(tinyxml2::XMLElement* source, Rect& rect);
-    tinyxml2::XMLError hitboxes(tinyxml2::XMLElement* source, std::map<std::string, Rect>& rects);
+    tinyxml2::XMLError hitboxes(tinyxml2::XMLElement* source, HitboxSet& rects);
     tinyxml2::XMLError blendmode(tinyxml2::XMLElement* source, Texture& img);
 
     tinyxml2::XMLError bg_color(tinyxml2::XMLElement* source, SDL_Color& color);
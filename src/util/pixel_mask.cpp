@@ -0,0 +1,145 @@
+/*
+ * Copyright 2017-2020 Agouti Games Team (see the AUTHORS file)
+ *
+ * This file is part of the RawSalmonEngine.
+ *
+ * The RawSalmonEngine is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * The RawSalmonEngine is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with the RawSalmonEngine.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#include "util/pixel_mask.hpp"
+
+#include <algorithm>
+#include <cmath>
+
+namespace salmon { namespace internal {
+
+/// Create a fully transparent mask
+PixelMask::PixelMask(int w, int h) :
+m_w{std::max(0, w)}, m_h{std::max(0, h)}, m_words{(m_w + 63) / 64}, m_bits(m_words * m_h, 0)
+{
+
+}
+
+/**
+ * @brief Create the mask of a part of a surface
+ * @param surface A surface in SDL_PIXELFORMAT_RGBA32 which doesn't need locking
+ * @param clip The part of the surface
+ *
+ * Pixels count as opaque from half alpha on. Color keys have to be converted to alpha beforehand.
+ */
+PixelMask PixelMask::from_surface(SDL_Surface* surface, const SDL_Rect& clip) {
+    PixelMask mask(clip.w, clip.h);
+    for(int y = 0; y < clip.h; y++) {
+        int src_y = clip.y + y;
+        if(src_y < 0 || src_y >= surface->h) {continue;}
+        const Uint8* row = static_cast<const Uint8*>(surface->pixels) + src_y * surface->pitch;
+        for(int x = 0; x < clip.w; x++) {
+            int src_x = clip.x + x;
+            if(src_x < 0 || src_x >= surface->w) {continue;}
+            // RGBA32 stores its bytes in R G B A order on every platform
+            if(row[src_x * 4 + 3] >= 128) {mask.set(x, y, true);}
+        }
+    }
+    return mask;
+}
+
+/**
+ * @brief Returns the mask of the image after applying Tiled's flip flags
+ *
+ * The diagonal flip swaps x and y and happens before the other flips.
+ */
+PixelMask PixelMask::transformed(bool h_flip, bool v_flip, bool diagonal) const {
+    int w = diagonal ? m_h : m_w;
+    int h = diagonal ? m_w : m_h;
+    PixelMask result(w, h);
+    for(int y = 0; y < h; y++) {
+        for(int x = 0; x < w; x++) {
+            int src_x = h_flip ? w - 1 - x : x;
+            int src_y = v_flip ? h - 1 - y : y;
+            if(diagonal) {std::swap(src_x, src_y);}
+            if(get(src_x, src_y)) {result.set(x, y, true);}
+        }
+    }
+    return result;
+}
+
+/// Returns true if the pixel is opaque, pixels outside of the mask are transparent
+bool PixelMask::get(int x, int y) const {
+    if(x < 0 || y < 0 || x >= m_w || y >= m_h) {return false;}
+    return (m_bits[y * m_words + x / 64] >> (x % 64)) & 1;
+}
+
+void PixelMask::set(int x, int y, bool opaque) {
+    if(x < 0 || y < 0 || x >= m_w || y >= m_h) {return;}
+    Uint64 bit = static_cast<Uint64>(1) << (x % 64);
+    if(opaque) {m_bits[y * m_words + x / 64] |= bit;}
+    else {m_bits[y * m_words + x / 64] &= ~bit;}
+}
+
+/// Returns the 64 pixels of row y starting at column x, pixels outside of the mask are transparent
+Uint64 PixelMask::extract(int y, int x) const {
+    if(y < 0 || y >= m_h || x >= m_w || x <= -64) {return 0;}
+    const Uint64* row = m_bits.data() + y * m_words;
+    // Floor division, so negative columns land in the word before the row
+    int word = (x >= 0) ? x / 64 : -((63 - x) / 64);
+    int shift = x - word * 64;
+    Uint64 low = (word >= 0) ? row[word] : 0;
+    Uint64 high = (word + 1 < m_words) ? row[word + 1] : 0;
+    if(shift == 0) {return low;}
+    return (low >> shift) | (high << (64 - shift));
+}
+
+/**
+ * @brief Returns true if both masks have an opaque pixel in common within area
+ * @param area The world area to test, usually the intersection of two hitboxes
+ * @param a, b The masks to test, nullptr counts as fully opaque
+ * @param a_pos, b_pos The world positions of the upper left corners of the masks
+ */
+bool PixelMask::overlap(const Rect& area, const PixelMask* a, Point a_pos, const PixelMask* b, Point b_pos) {
+    if(a == nullptr && b == nullptr) {return true;}
+    int x_from = static_cast<int>(std::floor(area.x));
+    int y_from = static_cast<int>(std::floor(area.y));
+    int x_to = static_cast<int>(std::ceil(area.x + area.w));
+    int y_to = static_cast<int>(std::ceil(area.y + area.h));
+    if(x_to <= x_from) {x_to = x_from + 1;}
+    if(y_to <= y_from) {y_to = y_from + 1;}
+
+    int a_x = static_cast<int>(std::lround(a_pos.x));
+    int a_y = static_cast<int>(std::lround(a_pos.y));
+    int b_x = static_cast<int>(std::lround(b_pos.x));
+    int b_y = static_cast<int>(std::lround(b_pos.y));
+    const Uint64 all = ~static_cast<Uint64>(0);
+    for(int y = y_from; y < y_to; y++) {
+        for(int x = x_from; x < x_to; x += 64) {
+            Uint64 bits = (x_to - x >= 64) ? all : (all >> (64 - (x_to - x)));
+            if(a != nullptr) {bits &= a->extract(y - a_y, x - a_x);}
+            if(b != nullptr) {bits &= b->extract(y - b_y, x - b_x);}
+            if(bits != 0) {return true;}
+        }
+    }
+    return false;
+}
+
+PixelMaskSet::PixelMaskSet(const PixelMask& mask) {
+    for(unsigned i = 0; i < variants.size(); i++) {
+        variants[i] = mask.transformed(i & 4, i & 2, i & 1);
+    }
+}
+
+/// Returns the bytes of all variants including their bits
+std::size_t PixelMaskSet::get_memory_usage() const {
+    std::size_t bytes = 0;
+    for(const PixelMask& mask : variants) {bytes += mask.get_memory_usage();}
+    return bytes;
+}
+}} // namespace salmon::internal
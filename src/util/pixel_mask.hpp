@@ -0,0 +1,74 @@
+/*
+ * Copyright 2017-2020 Agouti Games Team (see the AUTHORS file)
+ *
+ * This file is part of the RawSalmonEngine.
+ *
+ * The RawSalmonEngine is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * The RawSalmonEngine is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with the RawSalmonEngine.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#ifndef PIXEL_MASK_HPP_INCLUDED
+#define PIXEL_MASK_HPP_INCLUDED
+
+#include <array>
+#include <vector>
+#include <SDL.h>
+
+#include "util/game_types.hpp"
+
+namespace salmon { namespace internal {
+
+/**
+ * @brief One bit per pixel of an image which tells if the pixel is opaque
+ *
+ * Rows are packed into 64 bit words, the lowest bit of a word is the leftmost pixel.
+ * Overlap tests shift whole words into place and AND them, so they test 64 pixels at once.
+ */
+class PixelMask {
+    public:
+        PixelMask() = default;
+        PixelMask(int w, int h);
+
+        static PixelMask from_surface(SDL_Surface* surface, const SDL_Rect& clip);
+        PixelMask transformed(bool h_flip, bool v_flip, bool diagonal) const;
+
+        int get_w() const {return m_w;}
+        int get_h() const {return m_h;}
+        bool empty() const {return m_w == 0 || m_h == 0;}
+        bool get(int x, int y) const;
+        void set(int x, int y, bool opaque);
+
+        static bool overlap(const Rect& area, const PixelMask* a, Point a_pos, const PixelMask* b, Point b_pos);
+
+        /// Returns the bytes of the mask including its bits
+        std::size_t get_memory_usage() const {return sizeof(PixelMask) + m_bits.capacity() * sizeof(Uint64);}
+
+    private:
+        Uint64 extract(int y, int x) const;
+
+        int m_w = 0;
+        int m_h = 0;
+        int m_words = 0; ///< Words per row
+        std::vector<Uint64> m_bits;
+};
+
+/// A mask and its variants for all combinations of Tiled's flip flags, see PixelMask::transformed()
+struct PixelMaskSet {
+    std::array<PixelMask, 8> variants; ///< Indexed by horizontal flip * 4 + vertical flip * 2 + diagonal flip
+
+    explicit PixelMaskSet(const PixelMask& mask);
+    const PixelMask& get(Uint32 tile_id) const {return variants[tile_id >> 29];}
+    std::size_t get_memory_usage() const;
+};
+}} // namespace salmon::internal
+
+#endif // PIXEL_MASK_HPP_INCLUDED
@@ -0,0 +1,159 @@
+/*
+ * Copyright 2017-2020 Agouti Games Team (see the AUTHORS file)
+ *
+ * This file is part of the RawSalmonEngine.
+ *
+ * The RawSalmonEngine is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * The RawSalmonEngine is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with the RawSalmonEngine.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#ifndef SLOT_MAP_HPP_INCLUDED
+#define SLOT_MAP_HPP_INCLUDED
+
+#include <memory>
+#include <new>
+#include <type_traits>
+#include <utility>
+#include <vector>
+#include <SDL.h>
+
+namespace salmon { namespace internal {
+
+/// Generational reference to an element of a SlotMap
+struct SlotHandle {
+    Uint32 index = 0;
+    Uint32 generation = 0; ///< Zero never refers to a live element
+
+    bool valid() const {return generation != 0;}
+    bool operator==(const SlotHandle& other) const {return index == other.index && generation == other.generation;}
+    bool operator!=(const SlotHandle& other) const {return !(*this == other);}
+};
+
+/**
+ * @brief Container which hands out generational handles to its elements
+ *
+ * Elements live in fixed size blocks, so their addresses stay stable until they get erased.
+ * Erased slots are reused via a free list and their generation gets bumped,
+ * which makes stale handles detectable in O(1).
+ */
+template<class T>
+class SlotMap {
+    public:
+        SlotMap() = default;
+        ~SlotMap() {clear();}
+
+        SlotMap(const SlotMap& other) = delete;
+        SlotMap& operator=(const SlotMap& other) = delete;
+
+        SlotMap(SlotMap&& other) : m_blocks{std::move(other.m_blocks)}, m_free{std::move(other.m_free)},
+                                   m_slot_count{other.m_slot_count}, m_size{other.m_size} {
+            other.m_free.clear();
+            other.m_slot_count = 0;
+            other.m_size = 0;
+        }
+        SlotMap& operator=(SlotMap&& other) {
+            clear();
+            m_blocks = std::move(other.m_blocks);
+            m_free = std::move(other.m_free);
+            m_slot_count = other.m_slot_count;
+            m_size = other.m_size;
+            other.m_free.clear();
+            other.m_slot_count = 0;
+            other.m_size = 0;
+            return *this;
+        }
+
+        template<class... Args>
+        SlotHandle emplace(Args&&... args);
+        bool erase(SlotHandle handle);
+        void clear();
+
+        /// Returns the element or nullptr if the handle is stale
+        T* get(SlotHandle handle) {return valid(handle) ? get_slot(handle.index).get() : nullptr;}
+        const T* get(SlotHandle handle) const {return valid(handle) ? get_slot(handle.index).get() : nullptr;}
+
+        /// Returns true if the handle refers to a live element
+        bool valid(SlotHandle handle) const {
+            return handle.index < m_slot_count && get_slot(handle.index).generation == handle.generation && handle.generation != 0;
+        }
+
+        unsigned size() const {return m_size;}
+
+    private:
+        struct Slot {
+            typename std::aligned_storage<sizeof(T), alignof(T)>::type storage;
+            Uint32 generation = 0; ///< Odd while alive, even while free
+            T* get() {return reinterpret_cast<T*>(&storage);}
+            const T* get() const {return reinterpret_cast<const T*>(&storage);}
+        };
+
+        static const unsigned block_size = 64;
+
+        Slot& get_slot(Uint32 index) {return m_blocks[index / block_size][index % block_size];}
+        const Slot& get_slot(Uint32 index) const {return m_blocks[index / block_size][index % block_size];}
+
+        std::vector<std::unique_ptr<Slot[]> > m_blocks;
+        std::vector<Uint32> m_free; ///< Indices of erased slots
+        Uint32 m_slot_count = 0; ///< Number of slots ever used
+        unsigned m_size = 0; ///< Number of live elements
+};
+
+/// Construct a new element and return its handle
+template<class T>
+template<class... Args>
+SlotHandle SlotMap<T>::emplace(Args&&... args) {
+    Uint32 index;
+    if(!m_free.empty()) {
+        index = m_free.back();
+        m_free.pop_back();
+    }
+    else {
+        if(m_slot_count == m_blocks.size() * block_size) {
+            m_blocks.emplace_back(new Slot[block_size]);
+        }
+        index = m_slot_count++;
+    }
+    Slot& slot = get_slot(index);
+    new (&slot.storage) T(std::forward<Args>(args)...);
+    slot.generation++;
+    m_size++;
+    return SlotHandle{index, slot.generation};
+}
+
+/// Destroy the element, returns false if the handle is stale
+template<class T>
+bool SlotMap<T>::erase(SlotHandle handle) {
+    if(!valid(handle)) {return false;}
+    Slot& slot = get_slot(handle.index);
+    slot.get()->~T();
+    slot.generation++;
+    m_free.push_back(handle.index);
+    m_size--;
+    return true;
+}
+
+/// Destroy all elements, handles given out before stay stale
+template<class T>
+void SlotMap<T>::clear() {
+    for(Uint32 i = 0; i < m_slot_count; i++) {
+        Slot& slot = get_slot(i);
+        if(slot.generation % 2 != 0) {
+            slot.get()->~T();
+            slot.generation++;
+            m_free.push_back(i);
+        }
+    }
+    m_size = 0;
+}
+}} // namespace salmon::internal
+
+#endif // SLOT_MAP_HPP_INCLUDED
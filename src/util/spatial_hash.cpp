@@ -0,0 +1,84 @@
+/*
+ * Copyright 2017-2020 Agouti Games Team (see the AUTHORS file)
+ *
+ * This file is part of the RawSalmonEngine.
+ *
+ * The RawSalmonEngine is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * The RawSalmonEngine is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with the RawSalmonEngine.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#include "util/spatial_hash.hpp"
+
+namespace salmon { namespace internal {
+
+void SpatialHash::clear() {
+    m_cells.clear();
+    m_ranges.clear();
+}
+
+/// Store the id in all cells overlapped by bounds, replacing its previous rect
+void SpatialHash::insert(Uint32 id, const Rect& bounds) {
+    if(contains(id)) {erase(id);}
+    if(id >= m_ranges.size()) {m_ranges.resize(id + 1);}
+    Range& range = m_ranges[id];
+    range.x_from = to_cell(bounds.x);
+    range.y_from = to_cell(bounds.y);
+    range.x_to = to_cell(bounds.x + bounds.w);
+    range.y_to = to_cell(bounds.y + bounds.h);
+    range.active = true;
+    for(int y = range.y_from; y <= range.y_to; y++) {
+        for(int x = range.x_from; x <= range.x_to; x++) {
+            m_cells[cell_key(x, y)].push_back(id);
+        }
+    }
+}
+
+/// Remove the id from all of its cells
+void SpatialHash::erase(Uint32 id) {
+    if(!contains(id)) {return;}
+    Range& range = m_ranges[id];
+    for(int y = range.y_from; y <= range.y_to; y++) {
+        for(int x = range.x_from; x <= range.x_to; x++) {
+            auto it = m_cells.find(cell_key(x, y));
+            if(it == m_cells.end()) {continue;}
+            std::vector<Uint32>& bucket = it->second;
+            auto pos = std::find(bucket.begin(), bucket.end(), id);
+            if(pos != bucket.end()) {
+                *pos = bucket.back();
+                bucket.pop_back();
+            }
+            if(bucket.empty()) {m_cells.erase(it);}
+        }
+    }
+    range.active = false;
+}
+
+/// Returns true the first time the id gets visited during the current query
+bool SpatialHash::visit(Uint32 id) const {
+    if(m_visited[id] == m_stamp) {return false;}
+    m_visited[id] = m_stamp;
+    return true;
+}
+
+/// Starts a new query
+Uint32 SpatialHash::next_stamp() const {
+    if(m_visited.size() < m_ranges.size()) {m_visited.resize(m_ranges.size(), 0);}
+    m_stamp++;
+    // On wrap around old stamps could match again
+    if(m_stamp == 0) {
+        std::fill(m_visited.begin(), m_visited.end(), 0);
+        m_stamp = 1;
+    }
+    return m_stamp;
+}
+
+}} // namespace salmon::internal
@@ -0,0 +1,147 @@
+/*
+ * Copyright 2017-2020 Agouti Games Team (see the AUTHORS file)
+ *
+ * This file is part of the RawSalmonEngine.
+ *
+ * The RawSalmonEngine is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * The RawSalmonEngine is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with the RawSalmonEngine.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#ifndef SPATIAL_HASH_HPP_INCLUDED
+#define SPATIAL_HASH_HPP_INCLUDED
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+#include <unordered_map>
+#include <vector>
+#include <SDL.h>
+
+#include "util/game_types.hpp"
+
+namespace salmon { namespace internal {
+
+/**
+ * @brief Uniform grid of buckets which indexes rects by integer id
+ *
+ * Each rect gets stored in all cells it overlaps. Only occupied cells take memory,
+ * so the grid is unbounded. Ids are expected to be dense, like slot indices.
+ * @note Queries are not thread safe, they share a visit stamp to report each id once
+ */
+class SpatialHash {
+    public:
+        void set_cell_size(float size) {clear(); m_cell_size = size;}
+        float get_cell_size() const {return m_cell_size;}
+
+        void clear();
+        void insert(Uint32 id, const Rect& bounds);
+        void erase(Uint32 id);
+        bool contains(Uint32 id) const {return id < m_ranges.size() && m_ranges[id].active;}
+        Uint32 get_id_limit() const {return m_ranges.size();}
+
+        template<typename Function>
+        void query(const Rect& area, Function f) const;
+        template<typename Function>
+        void query_ray(Point origin, Point delta, Function f) const;
+
+    private:
+        /// Cells covered by an id, inclusive
+        struct Range {
+            int x_from = 0;
+            int y_from = 0;
+            int x_to = -1;
+            int y_to = -1;
+            bool active = false;
+        };
+
+        static Uint64 cell_key(int x, int y) {return (static_cast<Uint64>(static_cast<Uint32>(x)) << 32) | static_cast<Uint32>(y);}
+        int to_cell(float coord) const {return static_cast<int>(std::floor(coord / m_cell_size));}
+        bool visit(Uint32 id) const;
+        Uint32 next_stamp() const;
+
+        float m_cell_size = 128.0f;
+        std::unordered_map<Uint64, std::vector<Uint32>> m_cells;
+        std::vector<Range> m_ranges; ///< By id
+
+        mutable std::vector<Uint32> m_visited; ///< Stamp of the last query which reported the id
+        mutable Uint32 m_stamp = 0;
+};
+
+/**
+ * @brief Calls f with each id whose rect may overlap area
+ * @param f Callable taking an @c Uint32 id, called once per id
+ */
+template<typename Function>
+void SpatialHash::query(const Rect& area, Function f) const {
+    if(m_cells.empty()) {return;}
+    next_stamp();
+    int x_to = to_cell(area.x + area.w);
+    int y_to = to_cell(area.y + area.h);
+    for(int y = to_cell(area.y); y <= y_to; y++) {
+        for(int x = to_cell(area.x); x <= x_to; x++) {
+            auto it = m_cells.find(cell_key(x, y));
+            if(it == m_cells.end()) {continue;}
+            for(Uint32 id : it->second) {
+                if(visit(id)) {f(id);}
+            }
+        }
+    }
+}
+
+/**
+ * @brief Calls f with each id whose rect may be hit by the ray from origin to origin + delta
+ * @param f Callable taking an @c Uint32 id and returning the fraction of the first hit found so far
+ *
+ * The cells get walked in ray order with a grid DDA. The walk ends early once
+ * f reports a hit which lies within the cells walked so far.
+ */
+template<typename Function>
+void SpatialHash::query_ray(Point origin, Point delta, Function f) const {
+    if(m_cells.empty()) {return;}
+    next_stamp();
+    const float inf = std::numeric_limits<float>::infinity();
+    int x = to_cell(origin.x);
+    int y = to_cell(origin.y);
+    int x_last = to_cell(origin.x + delta.x);
+    int y_last = to_cell(origin.y + delta.y);
+    int step_x = (delta.x > 0) ? 1 : -1;
+    int step_y = (delta.y > 0) ? 1 : -1;
+    float t_max_x = (delta.x == 0) ? inf : ((x + (step_x > 0)) * m_cell_size - origin.x) / delta.x;
+    float t_max_y = (delta.y == 0) ? inf : ((y + (step_y > 0)) * m_cell_size - origin.y) / delta.y;
+    float t_delta_x = (delta.x == 0) ? inf : m_cell_size / std::fabs(delta.x);
+    float t_delta_y = (delta.y == 0) ? inf : m_cell_size / std::fabs(delta.y);
+
+    float first_hit = 1.0f;
+    while(true) {
+        auto it = m_cells.find(cell_key(x, y));
+        if(it != m_cells.end()) {
+            for(Uint32 id : it->second) {
+                if(visit(id)) {first_hit = f(id);}
+            }
+        }
+        float t_exit = std::min(t_max_x, t_max_y);
+        if(first_hit <= t_exit || (x == x_last && y == y_last)) {return;}
+        if(t_max_x < t_max_y) {
+            x += step_x;
+            t_max_x += t_delta_x;
+        }
+        else {
+            y += step_y;
+            t_max_y += t_delta_y;
+        }
+        // Guards against rounding errors stepping past the last cell
+        if(t_exit > 1.0f) {return;}
+    }
+}
+}} // namespace salmon::internal
+
+#endif // SPATIAL_HASH_HPP_INCLUDED
@@ -0,0 +1,40 @@
+/*
+ * Copyright 2017-2020 Agouti Games Team (see the AUTHORS file)
+ *
+ * This file is part of the RawSalmonEngine.
+ *
+ * The RawSalmonEngine is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * The RawSalmonEngine is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with the RawSalmonEngine.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#include "util/symbol_table.hpp"
+
+namespace salmon { namespace internal {
+
+/// Returns the id of the supplied name, a new one gets assigned if it wasn't known yet
+unsigned SymbolTable::intern(const std::string& name) {
+    auto it = m_ids.find(name);
+    if(it != m_ids.end()) {return it->second;}
+    unsigned id = m_names.size();
+    m_ids.emplace(name, id);
+    m_names.push_back(name);
+    return id;
+}
+
+/// Returns the id of the supplied name or -1 if it wasn't interned
+int SymbolTable::find(const std::string& name) const {
+    auto it = m_ids.find(name);
+    if(it == m_ids.end()) {return -1;}
+    return static_cast<int>(it->second);
+}
+
+}} // namespace salmon::internal
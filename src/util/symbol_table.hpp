@@ -0,0 +1,48 @@
+/*
+ * Copyright 2017-2020 Agouti Games Team (see the AUTHORS file)
+ *
+ * This file is part of the RawSalmonEngine.
+ *
+ * The RawSalmonEngine is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * The RawSalmonEngine is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with the RawSalmonEngine.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#ifndef SYMBOL_TABLE_HPP_INCLUDED
+#define SYMBOL_TABLE_HPP_INCLUDED
+
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+namespace salmon { namespace internal {
+
+/**
+ * @brief Maps strings to dense integer ids and back
+ *
+ * Used to intern names which are fixed at load time, so hot code paths
+ * can compare and index by integer instead of by string.
+ */
+class SymbolTable {
+    public:
+        unsigned intern(const std::string& name);
+        int find(const std::string& name) const;
+
+        const std::string& get_name(unsigned id) const {return m_names[id];}
+        unsigned size() const {return m_names.size();}
+
+    private:
+        std::unordered_map<std::string, unsigned> m_ids;
+        std::vector<std::string> m_names;
+};
+}} // namespace salmon::internal
+
+#endif // SYMBOL_TABLE_HPP_INCLUDED
@@ -0,0 +1,118 @@
+/*
+ * Copyright 2017-2020 Agouti Games Team (see the AUTHORS file)
+ *
+ * This file is part of the RawSalmonEngine.
+ *
+ * The RawSalmonEngine is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * The RawSalmonEngine is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with the RawSalmonEngine.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#include "util/thread_pool.hpp"
+
+namespace salmon { namespace internal {
+
+/**
+ * @brief Start the worker threads
+ * @param threads The total number of threads including the caller, 0 uses one per hardware thread
+ */
+ThreadPool::ThreadPool(unsigned threads) {
+#ifndef __EMSCRIPTEN__
+    if(threads == 0) {
+        threads = std::thread::hardware_concurrency();
+    }
+    for(unsigned i = 1; i < threads; i++) {
+        m_workers.emplace_back(&ThreadPool::work, this);
+    }
+#else
+    (void) threads;
+#endif
+}
+
+ThreadPool::~ThreadPool() {
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_quit = true;
+    }
+    m_wake.notify_all();
+    for(std::thread& worker : m_workers) {
+        worker.join();
+    }
+}
+
+/**
+ * @brief Call task once for each index from 0 to count and wait for all of them to finish
+ *
+ * The order in which the tasks run is unspecified, so tasks should only write to
+ * storage of their own index.
+ */
+void ThreadPool::run(unsigned count, const std::function<void(unsigned)>& task) {
+    if(count == 0) {return;}
+    if(m_workers.empty() || count == 1) {
+        for(unsigned i = 0; i < count; i++) {task(i);}
+        return;
+    }
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_task = &task;
+        m_count = count;
+        m_next = 0;
+        m_pending = count;
+    }
+    m_wake.notify_all();
+
+    unsigned index;
+    while(take_task(index)) {
+        task(index);
+        finish_task();
+    }
+
+    std::unique_lock<std::mutex> lock(m_mutex);
+    m_done.wait(lock, [this]{return m_pending == 0;});
+    m_task = nullptr;
+}
+
+/// Main loop of each worker thread
+void ThreadPool::work() {
+    while(true) {
+        unsigned index;
+        const std::function<void(unsigned)>* task;
+        {
+            std::unique_lock<std::mutex> lock(m_mutex);
+            m_wake.wait(lock, [this]{return m_quit || (m_task != nullptr && m_next < m_count);});
+            if(m_quit) {return;}
+            index = m_next++;
+            task = m_task;
+        }
+        (*task)(index);
+        finish_task();
+    }
+}
+
+/// Reserve the next task of the current run, returns false if there is none left
+bool ThreadPool::take_task(unsigned& index) {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    if(m_task == nullptr || m_next >= m_count) {return false;}
+    index = m_next++;
+    return true;
+}
+
+/// Mark one task of the current run as finished
+void ThreadPool::finish_task() {
+    bool done;
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        done = (--m_pending == 0);
+    }
+    if(done) {m_done.notify_all();}
+}
+
+}} // namespace salmon::internal
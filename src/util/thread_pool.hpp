@@ -0,0 +1,67 @@
+/*
+ * Copyright 2017-2020 Agouti Games Team (see the AUTHORS file)
+ *
+ * This file is part of the RawSalmonEngine.
+ *
+ * The RawSalmonEngine is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * The RawSalmonEngine is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with the RawSalmonEngine.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#ifndef THREAD_POOL_HPP_INCLUDED
+#define THREAD_POOL_HPP_INCLUDED
+
+#include <condition_variable>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace salmon { namespace internal {
+
+/**
+ * @brief A fixed set of worker threads which process indexed tasks
+ *
+ * The calling thread takes part in processing, so a pool of one thread runs
+ * everything inline. Web builds always run inline since they lack threads.
+ */
+class ThreadPool {
+    public:
+        explicit ThreadPool(unsigned threads = 0);
+        ~ThreadPool();
+
+        ThreadPool(const ThreadPool& other) = delete;
+        ThreadPool& operator=(const ThreadPool& other) = delete;
+
+        void run(unsigned count, const std::function<void(unsigned)>& task);
+
+        /// Returns the number of threads processing tasks, including the caller
+        unsigned get_thread_count() const {return m_workers.size() + 1;}
+
+    private:
+        void work();
+        bool take_task(unsigned& index);
+        void finish_task();
+
+        std::vector<std::thread> m_workers;
+        std::mutex m_mutex;
+        std::condition_variable m_wake;
+        std::condition_variable m_done;
+
+        const std::function<void(unsigned)>* m_task = nullptr;
+        unsigned m_count = 0;   ///< Number of tasks of the current run
+        unsigned m_next = 0;    ///< Index of the next task to take
+        unsigned m_pending = 0; ///< Tasks which didn't finish yet
+        bool m_quit = false;
+};
+}} // namespace salmon::internal
+
+#endif // THREAD_POOL_HPP_INCLUDED